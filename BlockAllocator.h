@@ -1,13 +1,58 @@
 #pragma once
 
+#include "BlockCache.h"
+#include "BlockFitPolicy.h"
+#include "BlockSource.h"
+#include "Emplace.h"
 #include "LazyObject.h"
 #include "ManagedMemoryBlock.h"
 #include "PsyncLib.h"
-#include "PolyWrap.h"
 #include "RefCount.h"
 #include "ProxyRefCounter.h"
 
-template<typename POLYTYPE>
+// Counts kept by tBlockAllocatorT to compare fit policies and block sizes
+struct tBlockAllocatorCounters
+{
+	int64_t NumAllocations;																	// Objects allocated
+	int64_t NumBlocksScanned;																// Block table entries looked at to choose
+																									//  a block, by the fit policy and the
+																									//  alignment fallback. None for a large
+																									//  object, which still counts as an
+																									//  allocation
+	int64_t NumBlocksCreated;																// Blocks created, or reused, because none
+																									//  had space
+	int64_t NumBytesWasted;																	// Space left in blocks when they were
+																									//  removed from the in use list
+	int64_t NumBlocksRetired;																// Blocks removed from the in use list and
+																									//  held on to
+	int64_t NumBlocksAllocated;															// Blocks whose memory came from the block
+																									//  cache or source rather than the spares
+	int64_t NumBytesPadded;																	// Bytes skipped to align objects
+	int64_t NumLargeObjects;																// Objects given a block of their own
+};
+
+// A snapshot of what a tBlockAllocatorT holds, kept as it changes so that taking one never walks the blocks
+struct tBlockAllocatorStats
+{
+	int64_t NumBytesReserved;																// The memory of every block, including
+																									//  those held on to and the spares
+	int64_t NumBytesUsed;																	// Including alignment padding and managed
+																									//  records
+	int64_t NumBytesStranded;																// Space left in the blocks held on to and
+																									//  the large object blocks, which is not
+																									//  used again until a reset
+	int64_t NumManagedObjects;																// Objects whose destruction is managed
+	int32_t NumBlocks;																		// Every block, as NumBytesReserved
+	int32_t NumBlocksRetired;																// Blocks held on to
+	int32_t NumSpareBlocks;																	// Empty blocks kept for reuse
+	int32_t NumLargeBlocks;																	// Blocks holding a single large object
+	tBlockAllocatorCounters Counters;													// Since the last ResetCounters
+};
+
+// MAXNUMBLOCKS - The number of blocks allocated from at once. More blocks means less space is wasted when objects of
+//  mixed sizes are allocated, as a block is only removed once it's nearly full or the table is full.
+// FITPOLICY - Which block to allocate from when more than one has space. See BlockFitPolicy.h.
+template<typename POLYTYPE,typename BLOCKSOURCE=tMallocBlockSource,int MAXNUMBLOCKS=4,typename FITPOLICY=tFirstFit>
 class tBlockAllocatorT
 {
 //=====================================================================================================================
@@ -15,26 +60,64 @@ class tBlockAllocatorT
 //=====================================================================================================================
 	enum
 	{
-		eMaxNumBlocks=4,																		// Maximum number of memory blocks.
+		eMaxNumBlocks=MAXNUMBLOCKS,														// Maximum number of memory blocks.
 		eBlockCutOffPointBytes=64,															// When a block becomes equal or less to
 																									//  this value it's removed.
 	};
 	typedef tManagedMemoryBlockT<POLYTYPE> _tMemoryBlock;
-	template<typename TYPE>
-	class _tPolyWrap : public tPolyWrapT<POLYTYPE,TYPE> {};
 	//
 	unsigned char m_NumBlocks;																// The number of memory blocks in use.
-	int32_t m_BlockSizes[eMaxNumBlocks];												// The size remaining of each block. Holding
+	int32_t m_BlockSizes[SearchArraySize(eMaxNumBlocks)];							// The size remaining of each block. Holding
 																									//  these in this class as well as the
 																									//  memory block class is for performance
 																									//  reasons due to the array being contiguous
 																									//  and therefore fast to access in a loop
 																									//  and it being slow to access each memory
-																									//  block
+																									//  block. Padded for FirstIndexAtLeast
+	unsigned short m_BlockPtrLowBits[eMaxNumBlocks];								// The low 16 bits of each block's next
+																									//  byte pointer, from which the alignment
+																									//  padding needed is known without touching
+																									//  the block. Parallel with m_BlockSizes
 	_tMemoryBlock* m_Blocks[eMaxNumBlocks];											// The memory blocks. These are parallel
 																									//  with m_BlockSizes
 	const int32_t m_InitialSize;															// The size for the first block
 	const int32_t m_SubsequentBlockSize;												// The size of subsequent blocks
+	_tMemoryBlock* m_SpareBlocks;															// Blocks emptied by Rewind, chained
+																									//  through their previous block pointer.
+																									//  Used before more memory is requested
+	_tMemoryBlock* m_RetainedBlocks;														// Blocks kept by the last Reset and not
+																									//  used since, chained the same way. The
+																									//  next Reset frees those still here
+	_tMemoryBlock* m_LargeBlocks;															// Blocks each holding one object bigger
+																									//  than m_LargeObjectThreshold, newest
+																									//  first, chained through their previous
+																									//  block pointer. Never in m_Blocks
+	int32_t m_LargeObjectThreshold;														// Objects bigger than this get a block of
+																									//  their own. 0 turns it off
+	int32_t m_FirstBlockSize;																// The size for the first block after
+																									//  Reset, or 0 to use m_InitialSize
+	int32_t m_PeakBytesUsed;																// The most bytes used since the last Reset
+	unsigned char m_Retention;																// eRetention. What Reset keeps
+	int32_t m_RetentionLimit;																// The number of blocks or bytes kept
+	int32_t m_GrowthPercent;																// How much bigger each subsequent block is
+																									//  than the last, or 0 for them all to be
+																									//  m_SubsequentBlockSize
+	int32_t m_MinBlockSize;																	// The size growth starts from and shrinks
+																									//  back to
+	int32_t m_MaxBlockSize;																	// The size growth stops at
+	int32_t m_GrowthBlockSize;																// The size of the next subsequent block
+																									//  when growing
+	bool m_ShrinkBlockSize;																	// Shrink the growth after a cycle which
+																									//  needed less than the next block
+	int32_t m_NumBlocksUsed;																// Blocks put in to use so far, giving each
+																									//  it's use order so Rewind can empty the
+																									//  newest first
+	tBlockCacheT<BLOCKSOURCE>* m_BlockCache;											// Where blocks come from and are freed to,
+																									//  or NULL to use BLOCKSOURCE
+	FITPOLICY m_FitPolicy;																	// Chooses the block to allocate from
+	tBlockAllocatorStats m_Stats;															// Kept up to date by each allocation and
+																									//  recounted by the operations which walk
+																									//  every block anyway
 	tRefCount m_RefCount;																	// A resource helper. Debug aid. Is used
 																									//  only when POLYTYPE is a resource managing
 																									//  object. i.e.
@@ -44,39 +127,113 @@ class tBlockAllocatorT
 	tBlockAllocatorT(const tBlockAllocatorT&);
 	tBlockAllocatorT& operator=(const tBlockAllocatorT&);
 	int32_t NextBlockSize(void) const;													// Size of next block
+	void GrowBlockSize(void);																// Grow the size of the next subsequent block
+	void ShrinkBlockSize(const int32_t bytesused);									// Shrink the size of the next subsequent
+																									//  block if a cycle used less than it
+	int32_t BlockSizeToFit(
+	 const int32_t size,
+	 const int32_t alignment,
+	 const int32_t recordsize) const;													// The minimum block size to fit an object
+																									//  of this size and alignment and it's
+																									//  managed record
 	int32_t NextBlockSize(
 	 const int32_t size,
 	 const int32_t alignment,
-	 const bool ismanaged) const;															// Size of the next block or the minimum
+	 const int32_t recordsize) const;													// Size of the next block or the minimum
 																									//  size to fit an object of this size and
 																									//  alignment
 	void CreateAnotherBlock(
 	 const int32_t nbytes,
 	 const bool zeroinitialise);															// Create another block of memory (or the
 																									//  first)
+	_tMemoryBlock* MakeSpaceForAnotherBlock(void);									// Remove a block if necessary so another
+																									//  can be added. Returns the removed block
+																									//  which must be held on to, or NULL
+	void AddBlock(_tMemoryBlock& block);												// Add this block to the in use list
+	static void InsertByUseOrder(
+	 _tMemoryBlock*& blocks,
+	 _tMemoryBlock& block);																	// Link this block in to a chain ordered by
+																									//  use, newest first
+	_tMemoryBlock& NewBlock(
+	 const int32_t nbytes,
+	 const bool zeroinitialise);															// A block of new memory from the block
+																									//  cache or source, chained to nothing
+	void* AllocateLarge(
+	 const int32_t recordsize,
+	 const int32_t size,
+	 const unsigned short alignment,
+	 _tMemoryBlock*& block,
+	 char& blockidx);																			// Allocate from a block of it's own, on the
+																									//  large object list. 'blockidx' is set to
+																									//  -1
+	void FreeLargeBlocks(const _tMemoryBlock* const keep);						// Destroy and free the large object blocks
+																									//  newer than 'keep', or all of them if NULL
+	_tMemoryBlock* TakeSpareBlock(const int32_t nbytes);							// Take a spare block of at least 'nbytes'
+																									//  or NULL if there isn't one
+	static _tMemoryBlock* TakeBlockFrom(
+	 _tMemoryBlock*& blocks,
+	 const int32_t nbytes);																	// Unlink and return the first block of at
+																									//  least 'nbytes' in this chain, or NULL
+	void AddSpareBlock(_tMemoryBlock& block);											// Keep this empty block for reuse
+	int32_t NumBytesUsed(void);															// The bytes used by every block including
+																									//  those held on to
+	void RetainBlocks(_tMemoryBlock* blocks);											// Keep the empty blocks in this chain as
+																									//  the retention policy allows, in
+																									//  m_RetainedBlocks, and free the rest
+	void* TryBlock(
+	 const int32_t fitidx,
+	 const int32_t size,
+	 const unsigned short alignment,
+	 const int32_t recordsize,
+	 _tMemoryBlock*& block,
+	 char& blockidx);																			// Use the block at 'fitidx', which must
+																									//  have space for the object once padded
+	int32_t AlignedFitBlockIdx(
+	 const int32_t nbytes,
+	 const unsigned short alignment) const;											// The first block with space for 'nbytes'
+																									//  after the padding it needs for this
+																									//  alignment, or -1
+	unsigned short AlignmentPadRequired(
+	 const unsigned char blockidx,
+	 const unsigned short alignment) const;											// The padding the block at this index needs
+																									//  for this alignment
 	void* _Allocate(
-	 const bool manage, //todo param needed?
+	 const int32_t recordsize,
 	 const int32_t size,
 	 const unsigned short alignment,
-	 unsigned char& blockidx);
+	 _tMemoryBlock*& block,
+	 char& blockidx);
 	template<typename TYPE>
 	TYPE& _Allocate(
-	 const bool ismanaged,
-	 unsigned char& blockidx,
-	 const int32_t size);																	// Allocate an object of this type. Returns
-																									//  the block that was used to allocate this
-																									//  object
-	template<typename TYPE>
-	TYPE& _AllocateAndConstruct(void);													// Allocate and construct an object of this
-																									//  type
-	template<typename TYPE>
-	TYPE& _AllocateAndConstructPoly(const int32_t size);							// Allocate and construct an object that
-																									//  derives from POLYTYPE
+	 const int32_t recordsize,
+	 _tMemoryBlock*& block,
+	 char& blockidx,
+	 const int32_t size);																	// Allocate an object of this type, leaving
+																									//  'recordsize' bytes for it's managed
+																									//  record. Returns the block that was used
+																									//  to allocate this object and it's index,
+																									//  or -1 if it's no longer in use
+	template<typename TYPE,typename ARGS>
+	TYPE& _Emplace(
+	 const ARGS& args,
+	 const int32_t size);																	// Allocate and construct an object from
+																									//  these tEmplaceArgsT, managing it's
+																									//  destruction unless it's destructor is
+																									//  trivial
+	template<typename TYPE,typename ARGS>
+	TYPE* _EmplaceArray(
+	 const int32_t count,
+	 const ARGS& args);																		// Allocate 'count' objects in one go and
+																									//  construct each from these
+																									//  tEmplaceArgsT. They share one
+																									//  destruction record
 	int32_t AlignmentPaddingForBlocksize(int32_t blocksize) const;				// The alignment padding required for a
 																									//  block of this size
 	char SmallestBlockIdx(void) const;													// The index of the smallest block or -1
 																									//  if there are no blocks in use
 	char SmallestBlockIdx(void);
+	char LargestBlockIdx(void) const;													// The index of the block with the most space
+																									//  left or -1 if there are no blocks in use
 	const _tMemoryBlock* SmallestBlock(void) const;									// The smallest block or NULL if there are
 																									//  no blocks in use
 	_tMemoryBlock* SmallestBlock(void);
@@ -85,26 +242,94 @@ class tBlockAllocatorT
 	bool IsLastBlock(const unsigned char idx) const;								// Is the block at idx the last one?
 	unsigned char LastBlockIdx(void) const;											// The index of the last block
 	void* Use(
-	 const unsigned char blockidx,
+	 char& blockidx,
 	 const size_t numbytes,
 	 const unsigned short alignment,
-	 const bool ismanaged);																	// Attempt to use 'num bytes' from this
+	 const int32_t recordsize);															// Attempt to use 'num bytes' from this
 																									//  memory block. May fail due to not enough
-																									//  space
+																									//  space. 'blockidx' is set to -1 if the
+																									//  block is then full and removed
 	_tMemoryBlock& Block(const unsigned char idx);									// Block at this index.
 	const _tMemoryBlock& Block(const unsigned char idx) const;
 	const int32_t& BlockSize(const unsigned char idx) const;						// Block size at this index
 	int32_t& BlockSize(const unsigned char idx);
 	bool IsValidBlockIdx(const unsigned char idx) const;							// Is this a valid block idx?
 	bool SpaceForAnotherBlock(void) const;												// Is there space for another block?
+	template<typename TYPE>
 	void ManageObjectDestruction(
-	 const unsigned char blockidx,
-	 POLYTYPE& managedobject);																// Manage the destruction of this object
-	void UpdateBlockSize(const unsigned char blockidx);							// Update the block size
+	 _tMemoryBlock& block,
+	 const char blockidx,
+	 TYPE& managedobject);																	// Manage the destruction of this object
+																									//  allocated from this block. It's type must
+																									//  be exactly TYPE so that consecutive
+																									//  objects can share a run record
+	template<typename TYPE>
+	void ManageArrayDestruction(
+	 _tMemoryBlock& block,
+	 const char blockidx,
+	 TYPE* const first,
+	 const int32_t count);																	// Manage the destruction of this array
+																									//  allocated from this block
+	void UpdateBlockSize(const unsigned char blockidx);							// Update the block size and pointer low
+																									//  bits
 	void DeleteBlock(_tMemoryBlock& block);											// Delete a block and it's children
+	void* NewBlockMemory(int32_t& nbytes);												// Memory for a block. 'nbytes' may be
+																									//  rounded up by the block cache or source
+	void FreeBlockMemory(
+	 void* const memory,
+	 const int32_t nbytes);																	// Give back the memory of a deleted block
+	void CountManagedObjects(
+	 const char blockidx,
+	 const int32_t recordbytes,
+	 const int32_t count);																	// Count objects just managed by the block
+																									//  at this index, -1 if it's held on to
+	void RetireBlock(
+	 const unsigned char idx,
+	 const unsigned char reason);															// Record why the block at this index is to
+																									//  be held on to, and count it, before it's
+																									//  removed
+	void CountBlocks(tBlockAllocatorStats& stats) const;							// Count what every block holds in to
+																									//  'stats', leaving the counters
+	void RecountBlocks(void);
+	void CheckStats(void) const;															// Debug only. Recount every block and
+																									//  compare with what was kept as it changed
+																									//  rather than on every Invariant
+	static void WriteBlockReportLine(
+	 std::ostream& out,
+	 const int chain,
+	 const char* const state,
+	 const _tMemoryBlock& block,
+	 const int32_t stranded);																// One line of WriteBlockReport
 	//~F
 public:
 	class UnitTest;
+	typedef POLYTYPE tPolyType;															// The base of the managed objects
+	enum eRetention
+	{
+		eRetainAll,																				// Keep every block
+		eRetainLargestBlocks,																// Keep up to 'limit' of the largest blocks
+		eRetainBytes,																			// Keep the largest blocks which add up to
+																									//  no more than 'limit' bytes
+	};
+	enum eRetireReason
+	{
+		eNotRetired,
+		eRetiredFull,																			// Left with eBlockCutOffPointBytes or
+																									//  less
+		eRetiredEvicted,																		// The block with the least space left when
+																									//  another was needed and the table was full
+	};
+	class tCheckpoint
+	{
+		friend class tBlockAllocatorT;
+		unsigned char m_NumBlocks;															// The number of blocks in use
+		_tMemoryBlock* m_Blocks[eMaxNumBlocks];										// The blocks in use
+		_tMemoryBlock* m_ChainEnds[eMaxNumBlocks];									// The last block each was holding on to
+		typename _tMemoryBlock::tMark m_Marks[eMaxNumBlocks];						// Where each block was up to
+		_tMemoryBlock* m_LargeBlocks;														// The newest large object block
+		char BlockIdx(const _tMemoryBlock& block) const;							// The index of this block or -1 if it wasn't
+																									//  in use
+	};
 //=====================================================================================================================
 // FUNCTIONS/MODIFIERS
 //=====================================================================================================================
@@ -113,6 +338,42 @@ public:
 	 const int32_t subsequentblocksize=0 /* 0 means use initial size */);
 	~tBlockAllocatorT(void);
 	void Clear();
+	void Reset(void);																			// Destroy every managed object and empty the
+																									//  blocks, keeping them for reuse as allowed
+																									//  by SetRetention. The next first block is
+																									//  sized to fit everything this cycle used.
+																									//  Blocks kept by the last Reset which this
+																									//  cycle didn't use are freed
+	void SetRetention(
+	 const eRetention retention,
+	 const int32_t limit=0);																// What Reset keeps. Defaults to eRetainAll
+	void SetBlockGrowth(
+	 const int32_t growthpercent,
+	 const int32_t minblocksize,
+	 const int32_t maxblocksize,
+	 const bool shrink=false);																// Rather than the subsequent block size,
+																									//  start subsequent blocks at 'minblocksize'
+																									//  and make each 'growthpercent' bigger than
+																									//  the last, up to 'maxblocksize'. If
+																									//  'shrink', a Reset after a cycle which used
+																									//  less than the next block shrinks it by the
+																									//  same factor. 0 'growthpercent' turns it
+																									//  off
+	void SetLargeObjectThreshold(const int32_t nbytes);							// Give objects bigger than 'nbytes' a block
+																									//  of their own rather than making room for
+																									//  one in the blocks in use. Freed by a
+																									//  rewind past them, Reset or Clear. 0, the
+																									//  default, turns it off
+	const tBlockAllocatorCounters& Counters(void) const;
+	void ResetCounters(void);
+	tBlockAllocatorStats Stats(void) const;											// What the allocator holds now, and the
+																									//  counters. Doesn't walk the blocks other
+																									//  than to check them in debug
+	void SetBlockCache(
+	 tBlockCacheT<BLOCKSOURCE>* const cache);											// Take blocks from and free blocks to this
+																									//  cache, which is typically shared by every
+																									//  allocator. Must be set before the first
+																									//  block is created and outlive this
 	void Invariant(void) const;
 	void CreateFirstBlock(void);															// It's better to allocate outside of
 																									//  critical loops.
@@ -120,6 +381,16 @@ public:
 	TYPE& AllocateUnmanaged(void);														// Allocated but not constructed. Useful for
 																									//  POD types. For example:
 																									// int (&x)[10]=AllocateUnmanaged<int[10]>();
+	void* AllocateUnmanaged(
+	 const int32_t nbytes,
+	 const unsigned short alignment);													// Raw memory, for example for an STL
+																									//  container through tStlAllocatorT
+	void DeallocateUnmanaged(
+	 void* const memory,
+	 const int32_t nbytes);																	// Give back memory from AllocateUnmanaged.
+																									//  It's reused straight away if it was the
+																									//  last allocation made from it's block,
+																									//  otherwise not until a rewind or reset
 	template<typename TYPE>
 	tLazyT<TYPE,POLYTYPE>& Allocate(void);												// Allocation and construction managed by the
 																									//  caller. Destruction will happen
@@ -137,57 +408,216 @@ public:
 	 typename const TYPE::tCtorArgs& args,
 	 const int32_t size);																	// Objects must derive from POLYTYPE
 	template<typename TYPE>
-	TYPE& AllocateAndConstruct(void);													// Where objects do not derive from POLYTYPE
+	TYPE& AllocateAndConstruct(void);													// Where objects do not derive from POLYTYPE.
+																									//  No virtual destructor is needed, the
+																									//  block records the destructor for each
+																									//  run of objects of the type. Objects with
+																									//  a trivial destructor are not managed, so
+																									//  cost no more than AllocateUnmanaged
 	template<typename TYPE>
 	TYPE& AllocateAndConstruct(typename const TYPE::tCtorArgs& args);			// Where objects do not derive from POLYTYPE
+	template<typename TYPE>
+	TYPE& Emplace(void);																		// Construct an object from these arguments,
+																									//  passed straight to it's constructor.
+																									//  Objects may or may not derive from
+																									//  POLYTYPE and are managed as by
+																									//  AllocateAndConstruct
+	template<typename TYPE,typename A1>
+	TYPE& Emplace(const A1& a1);
+	template<typename TYPE,typename A1,typename A2>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2);
+	template<typename TYPE,typename A1,typename A2,typename A3>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3);
+	template<typename TYPE,typename A1,typename A2,typename A3,typename A4>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3,
+	 const A4& a4);
+	template<typename TYPE>
+	TYPE* AllocateArray(const int32_t count);											// Allocate and default construct 'count'
+																									//  consecutive objects. Much quicker than
+																									//  allocating them one at a time: there is
+																									//  one search for a block, and one record
+																									//  for their destruction. Managed as by
+																									//  AllocateAndConstruct
+	template<typename TYPE,typename A1>
+	TYPE* AllocateAndConstructArray(
+	 const int32_t count,
+	 const A1& a1);																			// As AllocateArray, constructing every
+																									//  object from these arguments as Emplace
+	template<typename TYPE,typename A1,typename A2>
+	TYPE* AllocateAndConstructArray(
+	 const int32_t count,
+	 const A1& a1,
+	 const A2& a2);
+	template<typename TYPE,typename A1,typename A2,typename A3>
+	TYPE* AllocateAndConstructArray(
+	 const int32_t count,
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3);
+	template<typename TYPE,typename A1,typename A2,typename A3,typename A4>
+	TYPE* AllocateAndConstructArray(
+	 const int32_t count,
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3,
+	 const A4& a4);
+	void DestroyManagedObjects(void);													// Destroy every managed object but keep the
+																									//  memory. Used where objects in one
+																									//  allocator reference another's resources
+//=====================================================================================================================
+// BLOCK SHARING
+//=====================================================================================================================
+	bool HasSpaceFor(
+	 const int32_t size,
+	 const int32_t recordsize) const;													// Could an object of this size, with a
+																									//  managed record of 'recordsize' bytes, be
+																									//  allocated without creating another
+																									//  block? Ignores alignment
+	tManagedMemoryBlockT<POLYTYPE>* ReleaseSpareBlock(
+	 const int32_t minbytes);																// Give up the block with the most space
+																									//  left if it has at least 'minbytes' and is
+																									//  not the last block in use. The caller
+																									//  takes ownership of it and it's chain
+	void AdoptBlock(
+	 tManagedMemoryBlockT<POLYTYPE>& block);											// Take ownership of a block released by
+																									//  another allocator with the same POLYTYPE
+																									//  and BLOCKSOURCE
+//=====================================================================================================================
+// CHECKPOINTS
+//=====================================================================================================================
+	tCheckpoint Checkpoint(void);															// Record the current position. Invalidated
+																									//  by ReleaseSpareBlock,
+																									//  DestroyManagedObjects or rewinding to an
+																									//  earlier checkpoint
+	void Rewind(const tCheckpoint& checkpoint);										// Destroy the managed objects allocated
+																									//  since the checkpoint and reuse their
+																									//  memory. The blocks in use at the
+																									//  checkpoint are rewound first, then the
+																									//  blocks used since are emptied newest
+																									//  first and kept for reuse rather than
+																									//  freed
+//=====================================================================================================================
+// DIAGNOSTICS
+//=====================================================================================================================
+	void WriteBlockReport(std::ostream& out) const;									// Write every block as CSV, a line each:
+																									//  chain,state,size,used,stranded,
+																									//  managedobjects. 'chain' is the index of
+																									//  the block in use which holds it, or -1
+																									//  for a spare or large object block.
+																									//  'state' is inuse, spare, large, full or
+																									//  evicted. For tuning the block sizes and
+																									//  cut off against real use
 	//
 };
 
+// Rewinds the allocator when it goes out of scope. For example, to reuse the same memory on each iteration of a loop:
+// for(...)
+// {
+//  tBlockAllocatorScopeT<tBlockAllocator> scope(allocator);
+//  ...
+// }
+template<typename ALLOCATOR>
+class tBlockAllocatorScopeT
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	ALLOCATOR& m_Allocator;
+	const typename ALLOCATOR::tCheckpoint m_Checkpoint;
+	//~V
+	tBlockAllocatorScopeT(const tBlockAllocatorScopeT&);
+	tBlockAllocatorScopeT& operator=(const tBlockAllocatorScopeT&);
+	//~F
+public:
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tBlockAllocatorScopeT(ALLOCATOR& allocator);
+	~tBlockAllocatorScopeT(void);															// Rewind to the checkpoint taken on
+																									//  construction
+	//~PF
+};
+
 //todo better name?
 typedef tProxyRefCounter(tRefCount) tBlockAllocatorRefCounter;
 
+// Managed objects of type tBlockAllocatorRefCounter reference the allocator's ref counter, to detect objects
+//  outliving the allocator. By pointer so that classes derived from it choose the second overload over void*.
+void BlockAllocatorSetRefCounter(
+ const void* const managedobject,
+ tRefCount& refcounter);
+
+void BlockAllocatorSetRefCounter(
+ tBlockAllocatorRefCounter* const managedobject,
+ tRefCount& refcounter);
+
 //=====================================================================================================================
 // HELPER FUNCTIONS
 //=====================================================================================================================
 
-template<typename POLYTYPE,typename TYPE>
+template<typename POLYTYPE,typename TYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 TYPE& AllocateAndConstructPoly(
- tBlockAllocatorT<POLYTYPE>& allocator,
+ tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>& allocator,
  const int32_t size,
  typename const TYPE::tCtorArgs& args);
 
-template<typename POLYTYPE,typename TYPE>
+template<typename POLYTYPE,typename TYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 TYPE& AllocateAndConstructPoly(
- tBlockAllocatorT<POLYTYPE>& allocator,
+ tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>& allocator,
  const int32_t size);
 
 //=====================================================================================================================
 // IMPLEMENTATION
 //=====================================================================================================================
 
-template<typename POLYTYPE>
-tBlockAllocatorT<POLYTYPE>::tBlockAllocatorT(const int32_t initialsize,const int32_t subsequentblocksize /*=0*/)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::tBlockAllocatorT(const int32_t initialsize,
+ const int32_t subsequentblocksize /*=0*/)
 :m_InitialSize(initialsize),m_SubsequentBlockSize((subsequentblocksize)?subsequentblocksize:initialsize),
-m_NumBlocks(0)
+m_NumBlocks(0),m_SpareBlocks(NULL),m_RetainedBlocks(NULL),m_LargeBlocks(NULL),m_LargeObjectThreshold(0),m_FirstBlockSize(0),
+m_PeakBytesUsed(0),m_Retention(eRetainAll),m_RetentionLimit(0),m_GrowthPercent(0),m_MinBlockSize(0),m_MaxBlockSize(0),
+m_GrowthBlockSize(0),m_ShrinkBlockSize(false),m_NumBlocksUsed(0),m_BlockCache(NULL)
 {
+	memset(&m_Stats,0,sizeof(m_Stats));
 	Invariant();
 }
 
-template<typename POLYTYPE>
-tBlockAllocatorT<POLYTYPE>::~tBlockAllocatorT(void)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::~tBlockAllocatorT(void)
 {
 	Clear();
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::Clear()
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Clear()
 {
 	Invariant();
+	CheckStats();
 	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
 	{
 		DeleteBlock(Block(blockidx));
 	}
 	m_NumBlocks=0;
+	if(m_SpareBlocks)
+	{
+		DeleteBlock(*m_SpareBlocks);
+		m_SpareBlocks=NULL;
+	}
+	if(m_RetainedBlocks)
+	{
+		DeleteBlock(*m_RetainedBlocks);
+		m_RetainedBlocks=NULL;
+	}
+	FreeLargeBlocks(NULL);
+	RecountBlocks();
 	// If this is non 0, then we have a resource issue!
 	_ASSERTE(m_RefCount.Count()==0);
 	if(m_RefCount.Count()!=0)
@@ -200,217 +630,766 @@ void tBlockAllocatorT<POLYTYPE>::Clear()
 	Invariant();
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::DeleteBlock(_tMemoryBlock& block)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Reset(void)
+{
+	Invariant();
+	CheckStats();
+	// Objects in one block may reference those in another, so destroy them all before any block is emptied
+	DestroyManagedObjects();
+	// Size the next first block to fit everything used in this cycle. Alignment padding will differ once it's all in
+	//  one block so round up to whole subsequent blocks, which also means a cycle using slightly more than the last
+	//  can still reuse the same first block.
+	const int32_t bytesused=NumBytesUsed();
+	if(bytesused>m_PeakBytesUsed)
+	{
+		m_PeakBytesUsed=bytesused;
+	}
+	const int32_t firstblocksize=static_cast<int32_t>(m_PeakBytesUsed+sizeof(_tMemoryBlock));
+	m_FirstBlockSize=((firstblocksize+m_SubsequentBlockSize-1)/m_SubsequentBlockSize)*m_SubsequentBlockSize;
+	ShrinkBlockSize(m_PeakBytesUsed);
+	m_PeakBytesUsed=0;
+	// Each large object block was sized for one object, so is unlikely to fit the next and isn't worth keeping
+	FreeLargeBlocks(NULL);
+	// The blocks kept by the last Reset which this cycle didn't need, such as the small blocks from before the first
+	//  block was right sized, won't be needed by the next either
+	if(m_RetainedBlocks)
+	{
+		DeleteBlock(*m_RetainedBlocks);
+		m_RetainedBlocks=NULL;
+	}
+	// Gather every block, including the spares emptied by Rewind, in to one chain
+	_tMemoryBlock* blocks=m_SpareBlocks;
+	m_SpareBlocks=NULL;
+	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
+	{
+		_tMemoryBlock& block=Block(blockidx);
+		block.LastChainedBlock().SetPreviousBlock(blocks);
+		blocks=&block;
+	}
+	m_NumBlocks=0;
+	for(_tMemoryBlock* pblock=blocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		pblock->Reset();
+	}
+	RetainBlocks(blocks);
+	RecountBlocks();
+	_ASSERTE(m_RefCount.Count()==0);
+	Invariant();
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SetRetention(const eRetention retention,
+ const int32_t limit /*=0*/)
+{
+	_ASSERTE(retention==eRetainAll || limit>=0);
+	m_Retention=static_cast<unsigned char>(retention);
+	m_RetentionLimit=limit;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SetBlockGrowth(const int32_t growthpercent,
+ const int32_t minblocksize,const int32_t maxblocksize,const bool shrink /*=false*/)
+{
+	_ASSERTE(growthpercent>=0);
+	_ASSERTE(!growthpercent || (minblocksize>=1000 && maxblocksize>=minblocksize));
+	m_GrowthPercent=growthpercent;
+	m_MinBlockSize=minblocksize;
+	m_MaxBlockSize=maxblocksize;
+	m_GrowthBlockSize=minblocksize;
+	m_ShrinkBlockSize=shrink;
+	Invariant();
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SetLargeObjectThreshold(const int32_t nbytes)
+{
+	_ASSERTE(nbytes>=0);
+	m_LargeObjectThreshold=nbytes;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::GrowBlockSize(void)
+{
+	if(m_GrowthPercent)
+	{
+		// In 64 bits so a large block can't overflow before it's capped
+		const int64_t grownsize=m_GrowthBlockSize+((static_cast<int64_t>(m_GrowthBlockSize)*m_GrowthPercent)/100);
+		m_GrowthBlockSize=static_cast<int32_t>((grownsize<m_MaxBlockSize)?grownsize:m_MaxBlockSize);
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::ShrinkBlockSize(const int32_t bytesused)
+{
+	// One step each cycle, so a single quiet cycle between busy ones costs little
+	if(m_GrowthPercent && m_ShrinkBlockSize && bytesused<m_GrowthBlockSize)
+	{
+		const int64_t shrunksize=(static_cast<int64_t>(m_GrowthBlockSize)*100)/(100+m_GrowthPercent);
+		m_GrowthBlockSize=static_cast<int32_t>((shrunksize>m_MinBlockSize)?shrunksize:m_MinBlockSize);
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::RetainBlocks(_tMemoryBlock* blocks)
+{
+	int32_t numblocksleft=((m_Retention==eRetainLargestBlocks)?m_RetentionLimit:numeric_limits<int32_t>::max());
+	int32_t numbytesleft=((m_Retention==eRetainBytes)?m_RetentionLimit:numeric_limits<int32_t>::max());
+	// Keep the largest block which is within the limits until none are. Few blocks are expected so a search per block
+	//  is cheap enough.
+	while(blocks && numblocksleft>0)
+	{
+		_tMemoryBlock* largest=NULL;
+		_tMemoryBlock* beforelargest=NULL;
+		_tMemoryBlock* previous=NULL;
+		for(_tMemoryBlock* pblock=blocks;pblock;pblock=pblock->PreviousBlock())
+		{
+			if(pblock->Size()<=numbytesleft && (!largest || pblock->Size()>largest->Size()))
+			{
+				largest=pblock;
+				beforelargest=previous;
+			}
+			previous=pblock;
+		}
+		if(!largest)
+		{
+			break;
+		}
+		// Unlink it from the blocks to be freed
+		if(beforelargest)
+		{
+			beforelargest->SetPreviousBlock(largest->PreviousBlock());
+		}
+		else
+		{
+			blocks=largest->PreviousBlock();
+		}
+		largest->SetPreviousBlock(m_RetainedBlocks);
+		m_RetainedBlocks=largest;
+		--numblocksleft;
+		numbytesleft-=largest->Size();
+	}
+	if(blocks)
+	{
+		DeleteBlock(*blocks);
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int32_t tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::NumBytesUsed(void)
+{
+	int32_t rv=0;
+	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
+	{
+		for(_tMemoryBlock* pblock=&(Block(blockidx));pblock;pblock=pblock->PreviousBlock())
+		{
+			rv+=pblock->NumBytesUsed();
+		}
+	}
+	return rv;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::DeleteBlock(_tMemoryBlock& block)
 {
 	_tMemoryBlock* pblock=&block;
 	do
 	{
 		_tMemoryBlock& iterblock=*pblock;
 		pblock=iterblock.PreviousBlock();
+		const int32_t blocksize=iterblock.Size();
 		// Free the resources associated with this block
 		iterblock.~_tMemoryBlock();
 		// Free the memory associated with this block
-		::free(static_cast<void*>(&iterblock));
+		FreeBlockMemory(static_cast<void*>(&iterblock),blocksize);
 	}while(pblock);
 }
 
-template<typename POLYTYPE>
-void* tBlockAllocatorT<POLYTYPE>::_Allocate(const bool manage,const int32_t size,const unsigned short alignment,
- unsigned char& blockidx)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::NewBlockMemory(int32_t& nbytes)
+{
+	return ((m_BlockCache)?m_BlockCache->Allocate(nbytes):BLOCKSOURCE::Allocate(nbytes));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::FreeBlockMemory(void* const memory,
+ const int32_t nbytes)
+{
+	if(m_BlockCache)
+	{
+		m_BlockCache->Free(memory,nbytes);
+	}
+	else
+	{
+		BLOCKSOURCE::Free(memory,nbytes);
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SetBlockCache(tBlockCacheT<BLOCKSOURCE>* const cache)
+{
+	// Blocks already created would be freed to a different place to where they came from
+	_ASSERTE(!m_NumBlocks && !m_SpareBlocks && !m_RetainedBlocks);
+	m_BlockCache=cache;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+const tBlockAllocatorCounters& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Counters(void) const
+{
+	return m_Stats.Counters;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::ResetCounters(void)
+{
+	memset(&m_Stats.Counters,0,sizeof(m_Stats.Counters));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+tBlockAllocatorStats tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Stats(void) const
+{
+	CheckStats();
+	return m_Stats;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::CountManagedObjects(const char blockidx,
+ const int32_t recordbytes,const int32_t count)
+{
+	// A record may take no space if the objects join the newest run
+	m_Stats.NumBytesUsed+=recordbytes;
+	m_Stats.NumManagedObjects+=count;
+	if(blockidx<0)
+	{
+		// The record is in a block which has been held on to
+		m_Stats.NumBytesStranded-=recordbytes;
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::RetireBlock(const unsigned char idx,
+ const unsigned char reason)
+{
+	Block(idx).SetRetireReason(reason);
+	// Nothing more is allocated from it, but any managed record for the object just allocated is still to be added
+	m_Stats.NumBytesStranded+=BlockSize(idx);
+	++m_Stats.NumBlocksRetired;
+	++m_Stats.Counters.NumBlocksRetired;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::CountBlocks(tBlockAllocatorStats& stats) const
+{
+	stats.NumBytesReserved=0;
+	stats.NumBytesUsed=0;
+	stats.NumBytesStranded=0;
+	stats.NumManagedObjects=0;
+	stats.NumBlocks=0;
+	stats.NumBlocksRetired=0;
+	stats.NumSpareBlocks=0;
+	stats.NumLargeBlocks=0;
+	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
+	{
+		// The blocks after the first in each chain are held on to
+		for(const _tMemoryBlock* pblock=&(Block(blockidx));pblock;pblock=pblock->PreviousBlock())
+		{
+			stats.NumBytesReserved+=pblock->Size();
+			stats.NumBytesUsed+=pblock->NumBytesUsed();
+			stats.NumManagedObjects+=pblock->NumManagedObjects();
+			++stats.NumBlocks;
+			if(pblock!=&(Block(blockidx)))
+			{
+				stats.NumBytesStranded+=pblock->NumBytesLeft();
+				++stats.NumBlocksRetired;
+			}
+		}
+	}
+	for(const _tMemoryBlock* pblock=m_SpareBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		stats.NumBytesReserved+=pblock->Size();
+		++stats.NumBlocks;
+		++stats.NumSpareBlocks;
+	}
+	for(const _tMemoryBlock* pblock=m_RetainedBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		stats.NumBytesReserved+=pblock->Size();
+		++stats.NumBlocks;
+		++stats.NumSpareBlocks;
+	}
+	for(const _tMemoryBlock* pblock=m_LargeBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		stats.NumBytesReserved+=pblock->Size();
+		stats.NumBytesUsed+=pblock->NumBytesUsed();
+		stats.NumBytesStranded+=pblock->NumBytesLeft();
+		stats.NumManagedObjects+=pblock->NumManagedObjects();
+		++stats.NumBlocks;
+		++stats.NumLargeBlocks;
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::RecountBlocks(void)
+{
+	CountBlocks(m_Stats);
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::WriteBlockReport(std::ostream& out) const
 {
 	Invariant();
+	CheckStats();
+	out<<"chain,state,size,used,stranded,managedobjects\n";
+	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
+	{
+		const _tMemoryBlock& block=Block(blockidx);
+		WriteBlockReportLine(out,blockidx,"inuse",block,0);
+		// The space left in the blocks it's holding on to isn't used again until a reset
+		for(const _tMemoryBlock* pblock=block.PreviousBlock();pblock;pblock=pblock->PreviousBlock())
+		{
+			const char* state;
+			switch(pblock->RetireReason())
+			{
+			case eRetiredFull:
+				state="full";
+				break;
+			case eRetiredEvicted:
+				state="evicted";
+				break;
+			default:
+				// Not recorded, such as by an allocator it was adopted from
+				state="retired";
+				break;
+			}
+			WriteBlockReportLine(out,blockidx,state,*pblock,pblock->NumBytesLeft());
+		}
+	}
+	for(const _tMemoryBlock* pblock=m_SpareBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		WriteBlockReportLine(out,-1,"spare",*pblock,0);
+	}
+	for(const _tMemoryBlock* pblock=m_RetainedBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		WriteBlockReportLine(out,-1,"spare",*pblock,0);
+	}
+	for(const _tMemoryBlock* pblock=m_LargeBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		WriteBlockReportLine(out,-1,"large",*pblock,pblock->NumBytesLeft());
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::WriteBlockReportLine(std::ostream& out,
+ const int chain,const char* const state,const _tMemoryBlock& block,const int32_t stranded)
+{
+	out<<chain<<','<<state<<','<<block.Size()<<','<<block.NumBytesUsed()<<','<<stranded<<','<<
+	 block.NumManagedObjects()<<'\n';
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_Allocate(const int32_t recordsize,
+ const int32_t size,const unsigned short alignment,_tMemoryBlock*& block,char& blockidx)
+{
+	Invariant();
+	if(m_LargeObjectThreshold && size>m_LargeObjectThreshold)
+	{
+		// Making room for it in the blocks in use could evict a block with plenty of space left for small objects
+		return AllocateLarge(recordsize,size,alignment,block,blockidx);
+	}
 	if(!m_NumBlocks)
 	{
 		// Initialise for first time
 		// Don't zero initialise as that would incur a penalty that we may not want to incur now.
 		const bool zeroinitialise=false;
-		CreateAnotherBlock(NextBlockSize(size,alignment,manage),zeroinitialise);
+		CreateAnotherBlock(NextBlockSize(size,alignment,recordsize),zeroinitialise);
 	}
 	_ASSERTE(m_NumBlocks>0);
 	// Try use one of the memory blocks
 	// The newly allocated object
 	void* allocatedobject=NULL;
-	const int32_t minimumbytesrequired=
-	 static_cast<int32_t>(size+((manage)?_tMemoryBlock::eOverheadForManagedObject:0));
-	for(blockidx=0;blockidx<m_NumBlocks;++blockidx)
-	{
-		// This does not take in to account alignment, which we can't know unless we ask the memory block which would
-		//  slow this down. Which means the call to allocate memory within a block could fail due to alignment padding
-		//  being required to fit the new object.
-		if(BlockSize(blockidx)>=minimumbytesrequired)
-		{
-			allocatedobject=Use(blockidx,size,alignment,manage);
-			if(allocatedobject)
-			{
-				break;
-			}
-		}
+	const int32_t minimumbytesrequired=size+recordsize;
+	// Any block with space for the most padding this alignment could need will fit the object, so the fit policy
+	//  can search the sizes alone. Failing that, a block with less space may still fit it with the padding it
+	//  actually needs.
+	int32_t fitidx=m_FitPolicy.ChooseBlock(m_BlockSizes,m_NumBlocks,minimumbytesrequired+alignment-1);
+	m_Stats.Counters.NumBlocksScanned+=m_FitPolicy.NumScanned(m_NumBlocks,fitidx);
+	if(fitidx<0 && alignment>1)
+	{
+		fitidx=AlignedFitBlockIdx(minimumbytesrequired,alignment);
+		// Searched in order, up to the block found
+		m_Stats.Counters.NumBlocksScanned+=((fitidx<0)?m_NumBlocks:fitidx+1);
 	}
-	if(!allocatedobject)
+	if(fitidx>=0)
+	{
+		allocatedobject=TryBlock(fitidx,size,alignment,recordsize,block,blockidx);
+	}
+	else
 	{
 		// Allocate another block
 		const bool zeroinitialise=false;
-		CreateAnotherBlock(NextBlockSize(size,alignment,manage),zeroinitialise);
-		blockidx=LastBlockIdx();
-		allocatedobject=Use(blockidx,size,alignment,manage);
+		CreateAnotherBlock(NextBlockSize(size,alignment,recordsize),zeroinitialise);
+		allocatedobject=TryBlock(LastBlockIdx(),size,alignment,recordsize,block,blockidx);
 	}
+	++m_Stats.Counters.NumAllocations;
+	Invariant();
+	return allocatedobject;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateLarge(const int32_t recordsize,
+ const int32_t size,const unsigned short alignment,_tMemoryBlock*& block,char& blockidx)
+{
+	// Zero initialising is pointless for a block about to be filled by one object
+	const bool zeroinitialise=false;
+	block=&(NewBlock(BlockSizeToFit(size,alignment,recordsize),zeroinitialise));
+	block->SetPreviousBlock(m_LargeBlocks);
+	m_LargeBlocks=block;
+	const char* const nextbyteptr=block->NextBytePtr();
+	void* const allocatedobject=block->Use(size,alignment,recordsize);
 	_ASSERTE(allocatedobject);
+	const int32_t pad=static_cast<int32_t>(static_cast<const char*>(allocatedobject)-nextbyteptr);
+	m_Stats.NumBytesUsed+=pad+size;
+	m_Stats.Counters.NumBytesPadded+=pad;
+	// Nothing else is allocated from it. Any managed record is taken from this as for a block that's been held on to.
+	m_Stats.NumBytesStranded+=block->NumBytesLeft();
+	++m_Stats.NumLargeBlocks;
+	++m_Stats.Counters.NumLargeObjects;
+	// Counted as any other allocation, having scanned no blocks
+	++m_Stats.Counters.NumAllocations;
+	blockidx=-1;
 	Invariant();
 	return allocatedobject;
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::FreeLargeBlocks(const _tMemoryBlock* const keep)
+{
+	// Newest first, so objects are destroyed in the reverse order they were allocated
+	while(m_LargeBlocks!=keep)
+	{
+		// Otherwise 'keep' was freed by an earlier rewind or reset
+		_ASSERTE(m_LargeBlocks);
+		_tMemoryBlock& block=*m_LargeBlocks;
+		m_LargeBlocks=block.PreviousBlock();
+		block.SetPreviousBlock(NULL);
+		DeleteBlock(block);
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::TryBlock(const int32_t fitidx,const int32_t size,
+ const unsigned short alignment,const int32_t recordsize,_tMemoryBlock*& block,char& blockidx)
+{
+	blockidx=static_cast<char>(fitidx);
+	block=&(Block(blockidx));
+	void* const allocatedobject=Use(blockidx,size,alignment,recordsize);
+	_ASSERTE(allocatedobject);
+	// The index it had before Use removed it, if it's now full
+	m_FitPolicy.BlockUsed(fitidx);
+	return allocatedobject;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int32_t tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AlignedFitBlockIdx(const int32_t nbytes,
+ const unsigned short alignment) const
+{
+	for(int32_t fitidx=FirstIndexAtLeast(m_BlockSizes,m_NumBlocks,0,nbytes);fitidx>=0;
+	 fitidx=FirstIndexAtLeast(m_BlockSizes,m_NumBlocks,fitidx+1,nbytes))
+	{
+		const unsigned char blockidx=static_cast<unsigned char>(fitidx);
+		if(BlockSize(blockidx)>=nbytes+AlignmentPadRequired(blockidx,alignment))
+		{
+			return fitidx;
+		}
+	}
+	return -1;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+unsigned short tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AlignmentPadRequired(
+ const unsigned char blockidx,const unsigned short alignment) const
+{
+	_ASSERTE(IsValidBlockIdx(blockidx));
+	// Alignments are powers of 2, so are also a factor of 2^16 and the low bits are enough
+	_ASSERTE(alignment>0 && !(alignment&(alignment-1)));
+	const unsigned short misalignment=m_BlockPtrLowBits[blockidx]&(alignment-1);
+	return ((misalignment)?alignment-misalignment:0);
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::_Allocate(const bool manage,unsigned char& blockidx,const int32_t size)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_Allocate(const int32_t recordsize,
+ _tMemoryBlock*& block,char& blockidx,const int32_t size)
 {
 	// If the size is specified, it must be at least be the size of the object being created
 	_ASSERTE(size>=sizeof(TYPE));
 	static const unsigned short alignment=static_cast<unsigned short>(alignment_of<TYPE>::value);
-	return *reinterpret_cast<TYPE*>(_Allocate(manage,size,alignment,blockidx));
+	return *reinterpret_cast<TYPE*>(_Allocate(recordsize,size,alignment,block,blockidx));
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::AllocateUnmanaged(void)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateUnmanaged(void)
 {
-	unsigned char unused;
-	const bool manage=false;
+	_tMemoryBlock* unusedblock;
+	char unusedblockidx;
+	const int32_t recordsize=0;
 	const int32_t size=sizeof(TYPE);
-	return _Allocate<TYPE>(manage,unused,size);
+	return _Allocate<TYPE>(recordsize,unusedblock,unusedblockidx,size);
 }
 
-template<typename POLYTYPE>
-template<typename TYPE>
-tLazyT<TYPE,POLYTYPE>& tBlockAllocatorT<POLYTYPE>::Allocate(void)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateUnmanaged(const int32_t nbytes,
+ const unsigned short alignment)
 {
-	return _AllocateAndConstructPoly<tLazyT<TYPE,POLYTYPE> >();
+	_tMemoryBlock* unusedblock;
+	char unusedblockidx;
+	const int32_t recordsize=0;
+	return _Allocate(recordsize,nbytes,alignment,unusedblock,unusedblockidx);
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::DeallocateUnmanaged(void* const memory,
+ const int32_t nbytes)
+{
+	Invariant();
+	// The newest block is the most likely. A block no longer in use is full, so there is little to gain from it.
+	for(char blockidx=static_cast<char>(m_NumBlocks)-1;blockidx>=0;--blockidx)
+	{
+		if(Block(blockidx).Unuse(memory,nbytes))
+		{
+			m_Stats.NumBytesUsed-=nbytes;
+			UpdateBlockSize(blockidx);
+			break;
+		}
+	}
+	Invariant();
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::AllocateAndConstructPoly(void)
+tLazyT<TYPE,POLYTYPE>& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Allocate(void)
 {
-	return AllocateAndConstructPoly(size);
+	typedef tLazyT<TYPE,POLYTYPE> _tLazy;
+	return _Emplace<_tLazy>(tEmplaceArgsT<_tLazy>(),sizeof(_tLazy));
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::AllocateAndConstructPoly(const int32_t size)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructPoly(void)
 {
 	const int32_t size=sizeof(TYPE);
-	return _AllocateAndConstructPoly<TYPE>(size);
+	return AllocateAndConstructPoly<TYPE>(size);
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::_AllocateAndConstructPoly(const int32_t size)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructPoly(const int32_t size)
+{
+	return _Emplace<TYPE>(tEmplaceArgsT<TYPE>(),size);
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename ARGS>
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_Emplace(const ARGS& args,const int32_t size)
 {
 	Invariant();
-	unsigned char blockidx;
-	static const bool manage=true;
-	TYPE& allocatedobject=_Allocate<TYPE>(manage,blockidx,size);
-	// Construct the smart pointer (not the wrapped object)
-	::new(static_cast<void*>(&allocatedobject)) TYPE();
-	// Manage the destruction of the object.
-	ManageObjectDestruction(blockidx,allocatedobject);
+	_tMemoryBlock* block;
+	char blockidx;
+	// Nothing to destroy if the destructor does nothing
+	static const bool manage=!has_trivial_destructor<TYPE>::value;
+	void* const memory=&(_Allocate<TYPE>(_tMemoryBlock::RecordSize<TYPE>(1),block,blockidx,size));
+	TYPE& allocatedobject=args.Construct(memory);
+	// Manage the destruction of the object
+	if(manage)
+	{
+		ManageObjectDestruction(*block,blockidx,allocatedobject);
+	}
 	Invariant();
 	return allocatedobject;
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::AllocateAndConstructPoly(typename const TYPE::tCtorArgs& args)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructPoly(
+ typename const TYPE::tCtorArgs& args)
 {
 	const int32_t size=sizeof(TYPE);
-	return AllocateAndConstructPoly(args,size);
+	return AllocateAndConstructPoly<TYPE>(args,size);
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::AllocateAndConstructPoly(typename const TYPE::tCtorArgs& args,const int32_t size)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructPoly(
+ typename const TYPE::tCtorArgs& args,const int32_t size)
 {
-	Invariant();
-	unsigned char blockidx;
-	static const bool manage=true;
-	TYPE& allocatedobject=_Allocate<TYPE>(manage,blockidx,size);
-	// Construct the object
-	::new(static_cast<void*>(&allocatedobject)) TYPE(args);
-	// Manage the destruction of the object
-	ManageObjectDestruction(blockidx,allocatedobject);
-	Invariant();
-	return allocatedobject;
+	return _Emplace<TYPE>(tEmplaceArgsT<TYPE,typename TYPE::tCtorArgs>(args),size);
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::_AllocateAndConstruct(void)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstruct(
+ typename const TYPE::tCtorArgs& args)
 {
-	Invariant();
-	// Wrap the TYPE up as a POLYTYPE
-	unsigned char blockidx;
-	_tPolyWrap<TYPE>& allocatedobject=_Allocate<_tPolyWrap<TYPE> >(true,blockidx);
-	// Construct the smart pointer (not the wrapped object)
-	::new(static_cast<void*>(&allocatedobject)) _tPolyWrap<TYPE>();
-	// Manage the destruction of the object.
-	ManageObjectDestruction(blockidx,allocatedobject);
-	Invariant();
-	return *allocatedobject;
+	return AllocateAndConstructPoly<TYPE>(args);
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE>
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstruct(void)
+{
+	return Emplace<TYPE>();
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::AllocateAndConstruct(typename const TYPE::tCtorArgs& args)
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Emplace(void)
+{
+	return _Emplace<TYPE>(tEmplaceArgsT<TYPE>(),sizeof(TYPE));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1>
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Emplace(const A1& a1)
+{
+	return _Emplace<TYPE>(tEmplaceArgsT<TYPE,A1>(a1),sizeof(TYPE));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1,typename A2>
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Emplace(const A1& a1,const A2& a2)
+{
+	return _Emplace<TYPE>(tEmplaceArgsT<TYPE,A1,A2>(a1,a2),sizeof(TYPE));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1,typename A2,typename A3>
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Emplace(const A1& a1,const A2& a2,const A3& a3)
+{
+	return _Emplace<TYPE>(tEmplaceArgsT<TYPE,A1,A2,A3>(a1,a2,a3),sizeof(TYPE));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1,typename A2,typename A3,typename A4>
+TYPE& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Emplace(const A1& a1,const A2& a2,const A3& a3,
+ const A4& a4)
+{
+	return _Emplace<TYPE>(tEmplaceArgsT<TYPE,A1,A2,A3,A4>(a1,a2,a3,a4),sizeof(TYPE));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename ARGS>
+TYPE* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_EmplaceArray(const int32_t count,const ARGS& args)
 {
 	Invariant();
-	// Wrap the TYPE up as a POLYTYPE
-	unsigned char blockidx;
-	_tPolyWrap<TYPE>& allocatedobject=_Allocate<_tPolyWrap<TYPE> >(true,blockidx);
-	// Construct the smart pointer (not the wrapped object)
-	::new(static_cast<void*>(&allocatedobject)) TYPE(args);
-	// Manage the destruction of the object (using the poly wrapper)
-	ManageObjectDestruction(blockidx,allocatedobject);
+	_ASSERTE(count>0);
+	static const bool manage=!has_trivial_destructor<TYPE>::value;
+	if(count>(numeric_limits<int32_t>::max()-_tMemoryBlock::eOverheadForManagedObject)/static_cast<int32_t>(sizeof(TYPE)))
+	{
+		throw std::bad_alloc("Array too large.");
+	}
+	const int32_t size=count*sizeof(TYPE);
+	_tMemoryBlock* block;
+	char blockidx;
+	TYPE* const first=&(_Allocate<TYPE>(_tMemoryBlock::RecordSize<TYPE>(count),block,blockidx,size));
+	int32_t numconstructed=0;
+	try
+	{
+		for(;numconstructed<count;++numconstructed)
+		{
+			args.Construct(first+numconstructed);
+		}
+	}
+	catch(...)
+	{
+		// Nothing has been recorded for the objects yet
+		while(numconstructed)
+		{
+			first[--numconstructed].~TYPE();
+		}
+		throw;
+	}
+	if(manage)
+	{
+		ManageArrayDestruction(*block,blockidx,first,count);
+	}
 	Invariant();
-	return *allocatedobject;
+	return first;
 }
 
-template<typename POLYTYPE>
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 template<typename TYPE>
-TYPE& tBlockAllocatorT<POLYTYPE>::AllocateAndConstruct(void)
+TYPE* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateArray(const int32_t count)
+{
+	return _EmplaceArray<TYPE>(count,tEmplaceArgsT<TYPE>());
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1>
+TYPE* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructArray(const int32_t count,
+ const A1& a1)
 {
-	return _AllocateAndConstruct<TYPE>();
+	return _EmplaceArray<TYPE>(count,tEmplaceArgsT<TYPE,A1>(a1));
 }
 
-template<typename POLYTYPE>
-char tBlockAllocatorT<POLYTYPE>::SmallestBlockIdx(void) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1,typename A2>
+TYPE* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructArray(const int32_t count,
+ const A1& a1,const A2& a2)
+{
+	return _EmplaceArray<TYPE>(count,tEmplaceArgsT<TYPE,A1,A2>(a1,a2));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1,typename A2,typename A3>
+TYPE* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructArray(const int32_t count,
+ const A1& a1,const A2& a2,const A3& a3)
+{
+	return _EmplaceArray<TYPE>(count,tEmplaceArgsT<TYPE,A1,A2,A3>(a1,a2,a3));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE,typename A1,typename A2,typename A3,typename A4>
+TYPE* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AllocateAndConstructArray(const int32_t count,
+ const A1& a1,const A2& a2,const A3& a3,const A4& a4)
+{
+	return _EmplaceArray<TYPE>(count,tEmplaceArgsT<TYPE,A1,A2,A3,A4>(a1,a2,a3,a4));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+char tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SmallestBlockIdx(void) const
 {
-	// Start off at the highest possible number so every block is less than this.
-	int32_t smallestsize=numeric_limits<int32_t>::max();
-	char smallestblockidx=-1;
 	// We're casting the max blocks to a char so this static asserts the max number of blocks will not overflow
 	C_ASSERT(eMaxNumBlocks<=CHAR_MAX);
+	// Assuming that a block is never INT32_MAX in size otherwise it will cause this function to fail
+	return static_cast<char>(SmallestIndex(m_BlockSizes,m_NumBlocks));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+char tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SmallestBlockIdx(void)
+{
+	return static_cast<const tBlockAllocatorT&>(*this).SmallestBlockIdx();
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+char tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::LargestBlockIdx(void) const
+{
+	int32_t largestsize=-1;
+	char largestblockidx=-1;
 	for(char blockidx=0;blockidx<static_cast<char>(m_NumBlocks);++blockidx)
 	{
-		// Assuming that a block is never INT32_MAX in size otherwise it will cause this function to fail
-		_ASSERTE(BlockSize(blockidx)<numeric_limits<int32_t>::max());
-		if(BlockSize(blockidx)<smallestsize)
+		if(BlockSize(blockidx)>largestsize)
 		{
-			// New smallest block
-			smallestblockidx=blockidx;
-			smallestsize=BlockSize(blockidx);
+			// New largest block
+			largestblockidx=blockidx;
+			largestsize=BlockSize(blockidx);
 		}
 	}
-	return smallestblockidx;
+	return largestblockidx;
 }
 
-template<typename POLYTYPE>
-char tBlockAllocatorT<POLYTYPE>::SmallestBlockIdx(void)
-{
-	return static_cast<const tBlockAllocatorT&>(*this).SmallestBlockIdx();
-}
-
-template<typename POLYTYPE>
-const typename tBlockAllocatorT<POLYTYPE>::_tMemoryBlock* tBlockAllocatorT<POLYTYPE>::SmallestBlock(void) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+const typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock*
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SmallestBlock(void) const
 {
 	const char idx=SmallestBlockIdx();
 	const _tMemoryBlock* rv;
@@ -425,15 +1404,16 @@ const typename tBlockAllocatorT<POLYTYPE>::_tMemoryBlock* tBlockAllocatorT<POLYT
 	return rv;
 }
 
-template<typename POLYTYPE>
-typename tBlockAllocatorT<POLYTYPE>::_tMemoryBlock* tBlockAllocatorT<POLYTYPE>::SmallestBlock(void)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock*
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SmallestBlock(void)
 {
 	return const_cast<_tMemoryBlock*>(static_cast<const tBlockAllocatorT&>(*this).SmallestBlock());
 }
 
 // Hold on to this block by adding it to the back of one of the in use memory blocks.
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::HoldOntoBlock(const unsigned char idx)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::HoldOntoBlock(const unsigned char idx)
 {
 	// This can't work if there's only one block
 	_ASSERTE(m_NumBlocks>1);
@@ -445,87 +1425,98 @@ void tBlockAllocatorT<POLYTYPE>::HoldOntoBlock(const unsigned char idx)
 	Block(parentidx).ChainAttachBlock(blocktoholdonto);
 }
 
-template<typename POLYTYPE>
-bool tBlockAllocatorT<POLYTYPE>::IsLastBlock(const unsigned char idx) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::IsLastBlock(const unsigned char idx) const
 {
 	return (idx==LastBlockIdx());
 }
 
-template<typename POLYTYPE>
-unsigned char tBlockAllocatorT<POLYTYPE>::LastBlockIdx(void) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+unsigned char tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::LastBlockIdx(void) const
 {
 	_ASSERTE(m_NumBlocks>0);
 	return m_NumBlocks-1;
 }
 
-template<typename POLYTYPE>
-void* tBlockAllocatorT<POLYTYPE>::Use(const unsigned char blockidx,const size_t size,const unsigned short alignment,
- const bool ismanaged)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void* tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Use(char& blockidx,const size_t size,
+ const unsigned short alignment,const int32_t recordsize)
 {
 	Invariant();
-	void* const mem=Block(blockidx).Use(size,alignment,ismanaged);
+	const char* const nextbyteptr=Block(blockidx).NextBytePtr();
+	void* const mem=Block(blockidx).Use(size,alignment,recordsize);
 	if(mem)
 	{
+		const int32_t pad=static_cast<int32_t>(static_cast<const char*>(mem)-nextbyteptr);
+		m_Stats.NumBytesUsed+=pad+size;
+		m_Stats.Counters.NumBytesPadded+=pad;
 		// Update the size remaining for the block we've just allocated from
 		UpdateBlockSize(blockidx);
+		// A managed object's record is added to the block once it's constructed, so count it as used now
+		const int32_t sizeleft=BlockSize(blockidx)-recordsize;
 		// If the number of blocks is 1 then we can't get rid of it yet, as nothing could have a reference on it
 		//  and thus leak memory - this is handled in the special case further down. Alternatively we could
 		//  allocate another block here, but that doesn't seem right. We should only allocate memory when we
 		//  need another object, and we have satisfied this call to allocate a new object, hence no need to
 		//  allocate more
-		if(m_NumBlocks>1 && BlockSize(blockidx)<=eBlockCutOffPointBytes)
+		if(m_NumBlocks>1 && sizeleft<=eBlockCutOffPointBytes)
 		{
+			m_Stats.Counters.NumBytesWasted+=sizeleft;
+			RetireBlock(blockidx,eRetiredFull);
 			// Attach this block to the end of another block to keep a reference on it
 			HoldOntoBlock(blockidx);
-			// Get rid of the block.
+			// Get rid of the block. Another block now has this index.
 			RemoveBlock(blockidx);
+			blockidx=-1;
 		}
 	}
 	Invariant();
 	return mem;
 }
 
-template<typename POLYTYPE>
-typename tBlockAllocatorT<POLYTYPE>::_tMemoryBlock& tBlockAllocatorT<POLYTYPE>::Block(const unsigned char idx)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock&
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Block(const unsigned char idx)
 {
 	return const_cast<_tMemoryBlock&>(static_cast<const tBlockAllocatorT&>(*this).Block(idx));
 }
 
-template<typename POLYTYPE>
-const typename tBlockAllocatorT<POLYTYPE>::_tMemoryBlock& tBlockAllocatorT<POLYTYPE>::Block(const unsigned char idx) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+const typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock&
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Block(const unsigned char idx) const
 {
 	_ASSERTE(IsValidBlockIdx(idx));
 	return *m_Blocks[idx];
 }
 
-template<typename POLYTYPE>
-const int32_t& tBlockAllocatorT<POLYTYPE>::BlockSize(const unsigned char idx) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+const int32_t& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::BlockSize(const unsigned char idx) const
 {
 	_ASSERTE(IsValidBlockIdx(idx));
 	_ASSERTE(m_BlockSizes[idx]>=0);
 	return m_BlockSizes[idx];
 }
 
-template<typename POLYTYPE>
-int32_t& tBlockAllocatorT<POLYTYPE>::BlockSize(const unsigned char idx)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int32_t& tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::BlockSize(const unsigned char idx)
 {
 	return const_cast<int32_t&>(static_cast<const tBlockAllocatorT&>(*this).BlockSize(idx));
 }
 
-template<typename POLYTYPE>
-bool tBlockAllocatorT<POLYTYPE>::IsValidBlockIdx(const unsigned char idx) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::IsValidBlockIdx(const unsigned char idx) const
 {
 	return idx<=LastBlockIdx();
 }
 
-template<typename POLYTYPE>
-bool tBlockAllocatorT<POLYTYPE>::SpaceForAnotherBlock(void) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::SpaceForAnotherBlock(void) const
 {
 	return m_NumBlocks<eMaxNumBlocks;
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::CreateFirstBlock(void)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::CreateFirstBlock(void)
 {
 	Invariant();
 	// It doesn't make sense to call this if a block has already been
@@ -539,8 +1530,17 @@ void tBlockAllocatorT<POLYTYPE>::CreateFirstBlock(void)
 }
 
 // Calculate the next block size. Must be big enough to fit an object with the size/alignment
-template<typename POLYTYPE>
-int32_t tBlockAllocatorT<POLYTYPE>::NextBlockSize(const int32_t size,const int32_t alignment,const bool ismanaged) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int32_t tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::NextBlockSize(const int32_t size,
+ const int32_t alignment,const int32_t recordsize) const
+{
+	const int32_t minsizerequired=BlockSizeToFit(size,alignment,recordsize);
+	return ((minsizerequired>NextBlockSize())?minsizerequired:NextBlockSize());
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int32_t tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::BlockSizeToFit(const int32_t size,
+ const int32_t alignment,const int32_t recordsize) const
 {
 	// Size and alignment must both be greater than 0
 	_ASSERTE(size>0 && alignment>0);
@@ -556,27 +1556,28 @@ int32_t tBlockAllocatorT<POLYTYPE>::NextBlockSize(const int32_t size,const int32
 	{
 		minsizerequired+=alignment;
 	}
-	if(ismanaged)
+	if(recordsize)
 	{
-		// If it's not a POD then need to fit in at least one POLYTYPE*
-		minsizerequired+=sizeof(POLYTYPE*);
+		// If it's not a POD then need to fit in it's record
+		minsizerequired+=recordsize;
 		// Include padding the manage
 		minsizerequired+=AlignmentPaddingForBlocksize(minsizerequired);
 	}
 	Invariant();
-	return ((minsizerequired>NextBlockSize())?minsizerequired:NextBlockSize());
+	return minsizerequired;
 }
 
 // Returns the alignment padding needed for this block size
-template<typename POLYTYPE>
-int32_t tBlockAllocatorT<POLYTYPE>::AlignmentPaddingForBlocksize(int32_t blocksize) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int32_t tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AlignmentPaddingForBlocksize(
+ int32_t blocksize) const
 {
 	// Meaningless to call this function for a block size of 0
 	_ASSERTE(blocksize>0);
 	Invariant();
 	// Take into account alignment for managed object pointers at the end so it's always aligned on a
 	//  sizeof(POLYTYPE*) memory boundary
-	const int32_t polypad=blocksize%sizeof(POLYTYPE*);
+	const int32_t polypad=static_cast<int32_t>((sizeof(POLYTYPE*)-(blocksize%sizeof(POLYTYPE*)))%sizeof(POLYTYPE*));
 	// Sanity check
 	_ASSERTE(polypad<sizeof(POLYTYPE*));
 	// Check the resulting size is aligned properly
@@ -585,17 +1586,44 @@ int32_t tBlockAllocatorT<POLYTYPE>::AlignmentPaddingForBlocksize(int32_t blocksi
 	return polypad;
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::CreateAnotherBlock(const int32_t nbytes,const bool zeroinitialise)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::CreateAnotherBlock(const int32_t nbytes,
+ const bool zeroinitialise)
 {
 	// Sanity check!
 	_ASSERTE(nbytes>sizeof(_tMemoryBlock));
 	Invariant();
-	// Doesn't make sense to have the maximum number of blocks set to 1 and it will cause problems in this function due
-	//  to assumptions it makes
-	C_ASSERT(eMaxNumBlocks>1);
+	// Only subsequent blocks grow, the first is sized by NextBlockSize to fit the last cycle
+	const bool isfirstblock=!m_NumBlocks;
+	_tMemoryBlock* newblock=TakeSpareBlock(nbytes);
+	if(newblock)
+	{
+		// Reuse a block emptied by Rewind. It's memory has already been used so there is no need to zero initialise.
+		newblock->SetPreviousBlock(MakeSpaceForAnotherBlock());
+		--m_Stats.NumSpareBlocks;
+	}
+	else
+	{
+		newblock=&(NewBlock(nbytes,zeroinitialise));
+		newblock->SetPreviousBlock(MakeSpaceForAnotherBlock());
+	}
+	// Add the block to our list
+	AddBlock(*newblock);
+	++m_Stats.Counters.NumBlocksCreated;
+	if(!isfirstblock)
+	{
+		GrowBlockSize();
+	}
+	Invariant();
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock&
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::NewBlock(const int32_t nbytes,const bool zeroinitialise)
+{
 	// Create the memory
-	void* const newmemory=malloc(nbytes);
+	int32_t blocksize=nbytes;
+	void* const newmemory=NewBlockMemory(blocksize);
 	if(!newmemory)
 	{
 		// Failed to allocate memory. Consider reducing the block size
@@ -603,6 +1631,21 @@ void tBlockAllocatorT<POLYTYPE>::CreateAnotherBlock(const int32_t nbytes,const b
 		sprintf_s(errormsg,"Failed to allocate a block of %lu bytes.",nbytes);
 		throw std::bad_alloc(errormsg);
 	}
+	// Construct the new block
+	_tMemoryBlock* const newblock=::new(newmemory) _tMemoryBlock(NULL,blocksize,zeroinitialise);
+	m_Stats.NumBytesReserved+=blocksize;
+	++m_Stats.NumBlocks;
+	++m_Stats.Counters.NumBlocksAllocated;
+	return *newblock;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock*
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::MakeSpaceForAnotherBlock(void)
+{
+	// Doesn't make sense to have the maximum number of blocks set to 1 and it will cause problems in this function due
+	//  to assumptions it makes
+	C_ASSERT(eMaxNumBlocks>1);
 	_tMemoryBlock* previousblock;
 	if(!SpaceForAnotherBlock())
 	{
@@ -611,18 +1654,22 @@ void tBlockAllocatorT<POLYTYPE>::CreateAnotherBlock(const int32_t nbytes,const b
 		// Should be impossible not to have a block at this point 
 		_ASSERTE(smallestblockidx>=0);
 		previousblock=&(Block(smallestblockidx));
+		m_Stats.Counters.NumBytesWasted+=BlockSize(smallestblockidx);
+		RetireBlock(smallestblockidx,eRetiredEvicted);
 		// Remove this block
 		// If this ever threw an exception then it would cause 'previousblock' to leak. But it won't
 		RemoveBlock(smallestblockidx);
 	}
 	else
 	{
-		// Special case: if there is one block and it's size is less than the cut off point, remove it from the in-use
+		// Special case: if there is one block and it's size is at or below the cut off point, remove it from the in-use
 		//  list and hold on to it as the back point pointer of the new memory block we're constructing
-		if(m_NumBlocks==1 && BlockSize(0)<eBlockCutOffPointBytes)
+		if(m_NumBlocks==1 && BlockSize(0)<=eBlockCutOffPointBytes)
 		{
 			// Get rid of the block and connect it to the back of the new one
 			previousblock=&(Block(0));
+			m_Stats.Counters.NumBytesWasted+=BlockSize(0);
+			RetireBlock(0,eRetiredFull);
 			RemoveBlock(0);
 		}
 		else
@@ -630,44 +1677,293 @@ void tBlockAllocatorT<POLYTYPE>::CreateAnotherBlock(const int32_t nbytes,const b
 			previousblock=NULL;
 		}
 	}
-	// Construct the new block
-	::new(newmemory) _tMemoryBlock(previousblock,nbytes,zeroinitialise);
-	// Add the block to our list
+	_ASSERTE(SpaceForAnotherBlock());
+	return previousblock;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AddBlock(_tMemoryBlock& block)
+{
 	_ASSERTE(SpaceForAnotherBlock());
 	const unsigned char newblockidx=m_NumBlocks++;
-	m_Blocks[newblockidx]=static_cast<_tMemoryBlock*>(newmemory);
+	m_Blocks[newblockidx]=&block;
+	block.SetUseOrder(++m_NumBlocksUsed);
 	// Hold the size of the block
 	UpdateBlockSize(newblockidx);
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::InsertByUseOrder(_tMemoryBlock*& blocks,
+ _tMemoryBlock& block)
+{
+	_tMemoryBlock* newer=NULL;
+	_tMemoryBlock* older=blocks;
+	while(older && older->UseOrder()>block.UseOrder())
+	{
+		newer=older;
+		older=older->PreviousBlock();
+	}
+	block.SetPreviousBlock(older);
+	if(newer)
+	{
+		newer->SetPreviousBlock(&block);
+	}
+	else
+	{
+		blocks=&block;
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock*
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::TakeSpareBlock(const int32_t nbytes)
+{
+	// Those kept by Reset first, as any left unused are freed by the next
+	_tMemoryBlock* const pblock=TakeBlockFrom(m_RetainedBlocks,nbytes);
+	return ((pblock)?pblock:TakeBlockFrom(m_SpareBlocks,nbytes));
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::_tMemoryBlock*
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::TakeBlockFrom(_tMemoryBlock*& blocks,
+ const int32_t nbytes)
+{
+	_tMemoryBlock* previous=NULL;
+	for(_tMemoryBlock* pblock=blocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		if(pblock->Size()>=nbytes)
+		{
+			// Unlink it from the chain
+			if(previous)
+			{
+				previous->SetPreviousBlock(pblock->PreviousBlock());
+			}
+			else
+			{
+				blocks=pblock->PreviousBlock();
+			}
+			pblock->SetPreviousBlock(NULL);
+			return pblock;
+		}
+		previous=pblock;
+	}
+	return NULL;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AddSpareBlock(_tMemoryBlock& block)
+{
+	_ASSERTE(!block.NumBytesUsed());
+	block.SetPreviousBlock(m_SpareBlocks);
+	m_SpareBlocks=&block;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+typename tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::tCheckpoint
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Checkpoint(void)
+{
+	Invariant();
+	tCheckpoint checkpoint;
+	checkpoint.m_NumBlocks=m_NumBlocks;
+	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
+	{
+		_tMemoryBlock& block=Block(blockidx);
+		checkpoint.m_Blocks[blockidx]=&block;
+		// Blocks can only be attached to the end of a chain, so everything before this is unchanged until rewound
+		checkpoint.m_ChainEnds[blockidx]=&(block.LastChainedBlock());
+		checkpoint.m_Marks[blockidx]=block.Mark();
+	}
+	checkpoint.m_LargeBlocks=m_LargeBlocks;
+	return checkpoint;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Rewind(const tCheckpoint& checkpoint)
+{
+	Invariant();
+	CheckStats();
+	// Remember how much was used before it's given back so that Reset can size the first block
+	const int32_t bytesused=NumBytesUsed();
+	if(bytesused>m_PeakBytesUsed)
+	{
+		m_PeakBytesUsed=bytesused;
+	}
+	// Blocks created since the checkpoint could be in use or held on to by any block, and the blocks that were in use
+	//  could since have been held on to by another. Walk every chain to find the new blocks.
+	_tMemoryBlock* newblocks=NULL;
+	for(char blockidx=static_cast<char>(m_NumBlocks)-1;blockidx>=0;--blockidx)
+	{
+		_tMemoryBlock* pblock=&(Block(blockidx));
+		while(pblock)
+		{
+			const char checkpointidx=checkpoint.BlockIdx(*pblock);
+			if(checkpointidx>=0)
+			{
+				// In use at the checkpoint. Skip the blocks it was holding on to then.
+				pblock=checkpoint.m_ChainEnds[checkpointidx]->PreviousBlock();
+			}
+			else
+			{
+				_tMemoryBlock& newblock=*pblock;
+				pblock=newblock.PreviousBlock();
+				InsertByUseOrder(newblocks,newblock);
+			}
+		}
+	}
+	// Put back the blocks that were in use, newest first
+	m_NumBlocks=checkpoint.m_NumBlocks;
+	for(char blockidx=static_cast<char>(m_NumBlocks)-1;blockidx>=0;--blockidx)
+	{
+		// Let go of anything the block has held on to since
+		checkpoint.m_ChainEnds[blockidx]->SetPreviousBlock(NULL);
+		_tMemoryBlock& block=*(checkpoint.m_Blocks[blockidx]);
+		block.Rewind(checkpoint.m_Marks[blockidx]);
+		m_Blocks[blockidx]=&block;
+		UpdateBlockSize(blockidx);
+	}
+	// Then empty the new blocks, newest first, as the objects just destroyed may have referred to the objects in them
+	while(newblocks)
+	{
+		_tMemoryBlock& newblock=*newblocks;
+		newblocks=newblock.PreviousBlock();
+		newblock.SetPreviousBlock(NULL);
+		newblock.Reset();
+		AddSpareBlock(newblock);
+	}
+	// Last, as the objects just destroyed may have referred to the large objects allocated since
+	FreeLargeBlocks(checkpoint.m_LargeBlocks);
+	RecountBlocks();
+	Invariant();
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+char tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::tCheckpoint::BlockIdx(
+ const _tMemoryBlock& block) const
+{
+	for(char blockidx=0;blockidx<static_cast<char>(m_NumBlocks);++blockidx)
+	{
+		if(m_Blocks[blockidx]==&block)
+		{
+			return blockidx;
+		}
+	}
+	return -1;
+}
+
+template<typename ALLOCATOR>
+tBlockAllocatorScopeT<ALLOCATOR>::tBlockAllocatorScopeT(ALLOCATOR& allocator):m_Allocator(allocator),
+ m_Checkpoint(allocator.Checkpoint())
+{
+}
+
+template<typename ALLOCATOR>
+tBlockAllocatorScopeT<ALLOCATOR>::~tBlockAllocatorScopeT(void)
+{
+	m_Allocator.Rewind(m_Checkpoint);
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::DestroyManagedObjects(void)
+{
+	Invariant();
+	CheckStats();
+	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
+	{
+		// Including the blocks we are holding on to
+		for(_tMemoryBlock* pblock=&(Block(blockidx));pblock;pblock=pblock->PreviousBlock())
+		{
+			pblock->DestroyManagedObjects();
+		}
+		UpdateBlockSize(blockidx);
+	}
+	for(_tMemoryBlock* pblock=m_LargeBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		pblock->DestroyManagedObjects();
+	}
+	RecountBlocks();
+	Invariant();
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::HasSpaceFor(const int32_t size,
+ const int32_t recordsize) const
+{
+	const int32_t minimumbytesrequired=size+recordsize;
+	return (FirstIndexAtLeast(m_BlockSizes,m_NumBlocks,0,minimumbytesrequired)>=0);
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+tManagedMemoryBlockT<POLYTYPE>*
+tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::ReleaseSpareBlock(const int32_t minbytes)
+{
+	Invariant();
+	_tMemoryBlock* rv=NULL;
+	// Never give away the last block, the owner of this allocator is likely to need it
+	if(m_NumBlocks>1)
+	{
+		const char largestblockidx=LargestBlockIdx();
+		_ASSERTE(largestblockidx>=0);
+		if(BlockSize(largestblockidx)>=minbytes)
+		{
+			rv=&(Block(largestblockidx));
+			// The block and anything it's holding on to now belongs to the caller
+			RemoveBlock(largestblockidx);
+			RecountBlocks();
+		}
+	}
+	Invariant();
+	return rv;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::AdoptBlock(tManagedMemoryBlockT<POLYTYPE>& block)
+{
+	Invariant();
+	_tMemoryBlock* const previousblock=MakeSpaceForAnotherBlock();
+	if(previousblock)
+	{
+		// Hold on to the block that made way for the one being adopted
+		block.ChainAttachBlock(*previousblock);
+	}
+	AddBlock(block);
+	RecountBlocks();
 	Invariant();
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::RemoveBlock(const unsigned char idx) throw()
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::RemoveBlock(const unsigned char idx) throw()
 {
 	_ASSERTE(idx<m_NumBlocks);
 	// Is there at least one block above the one we are removing?
 	if(!IsLastBlock(idx))
 	{
-		// Shift the blocks and block sizes above the one we're removing one to the left - overwrite
-		ShiftLeft(m_Blocks,m_NumBlocks,idx+1);
-		ShiftLeft(m_BlockSizes,m_NumBlocks,idx+1);
+		// The order of the blocks doesn't matter, so move the last block in to it's place rather than shifting every
+		//  block above it
+		const unsigned char lastidx=LastBlockIdx();
+		m_Blocks[idx]=m_Blocks[lastidx];
+		m_BlockSizes[idx]=m_BlockSizes[lastidx];
+		m_BlockPtrLowBits[idx]=m_BlockPtrLowBits[lastidx];
 	}
 	// There is one less block
 	--m_NumBlocks;
 	_ASSERTE(m_NumBlocks>=0);
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::Invariant(void) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::Invariant(void) const
 {
 #ifdef _DEBUG
 	// I think it would be pointless to use this with block sizes of less than 1kB.
 	_ASSERTE(m_InitialSize>=1000 && m_SubsequentBlockSize>=1000);
+	_ASSERTE(!m_GrowthPercent ||
+	 (m_GrowthBlockSize>=m_MinBlockSize && m_GrowthBlockSize<=m_MaxBlockSize && m_MinBlockSize>=1000));
 	// Per block
 	for(unsigned char blockidx=0;blockidx<m_NumBlocks;++blockidx)
 	{
 		Block(blockidx).Invariant();
 		_ASSERTE(BlockSize(blockidx)==Block(blockidx).NumBytesLeft());
+		_ASSERTE(m_BlockPtrLowBits[blockidx]==
+		 static_cast<unsigned short>(reinterpret_cast<uintptr_t>(Block(blockidx).NextBytePtr())));
 		if(m_NumBlocks>1)
 		{
 			// If there's more than one block, then they should all be bigger than the cut off point
@@ -687,52 +1983,111 @@ void tBlockAllocatorT<POLYTYPE>::Invariant(void) const
 	// SpaceForAnotherBlock
 	_ASSERTE((m_NumBlocks<eMaxNumBlocks && SpaceForAnotherBlock()) ||
 	 (m_NumBlocks==eMaxNumBlocks && !SpaceForAnotherBlock()));
+	// m_Stats is checked by CheckStats, as recounting walks every block and this is called on every allocation
+#endif
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::CheckStats(void) const
+{
+#ifdef _DEBUG
+	tBlockAllocatorStats stats;
+	CountBlocks(stats);
+	_ASSERTE(stats.NumBytesReserved==m_Stats.NumBytesReserved && stats.NumBytesUsed==m_Stats.NumBytesUsed);
+	_ASSERTE(stats.NumBytesStranded==m_Stats.NumBytesStranded && stats.NumManagedObjects==m_Stats.NumManagedObjects);
+	_ASSERTE(stats.NumBlocks==m_Stats.NumBlocks && stats.NumBlocksRetired==m_Stats.NumBlocksRetired);
+	_ASSERTE(stats.NumSpareBlocks==m_Stats.NumSpareBlocks && stats.NumLargeBlocks==m_Stats.NumLargeBlocks);
+	for(const _tMemoryBlock* pblock=m_LargeBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		pblock->Invariant();
+	}
 #endif
 }
 
-template<typename POLYTYPE>
-int32_t tBlockAllocatorT<POLYTYPE>::NextBlockSize(void) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int32_t tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::NextBlockSize(void) const
 {
-	int32_t nextblocksize=((!m_NumBlocks)?m_InitialSize:m_SubsequentBlockSize);
+	int32_t nextblocksize;
+	if(m_NumBlocks)
+	{
+		nextblocksize=((m_GrowthPercent)?m_GrowthBlockSize:m_SubsequentBlockSize);
+	}
+	else
+	{
+		// The first block after a Reset fits everything used in the previous cycle
+		nextblocksize=((m_FirstBlockSize>m_InitialSize)?m_FirstBlockSize:m_InitialSize);
+	}
 	nextblocksize+=AlignmentPaddingForBlocksize(nextblocksize);
 	return nextblocksize;
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::ManageObjectDestruction(const unsigned char blockidx,POLYTYPE& managedobject)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::ManageObjectDestruction(_tMemoryBlock& block,
+ const char blockidx,TYPE& managedobject)
+{
+	const int32_t bytesused=block.NumBytesUsed();
+	block.ManageObjectDestruction(managedobject);
+	CountManagedObjects(blockidx,block.NumBytesUsed()-bytesused,1);
+	BlockAllocatorSetRefCounter(&managedobject,m_RefCount);
+	if(blockidx>=0)
+	{
+		// Still in use
+		_ASSERTE(&(Block(blockidx))==&block);
+		UpdateBlockSize(blockidx);
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename TYPE>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::ManageArrayDestruction(_tMemoryBlock& block,
+ const char blockidx,TYPE* const first,const int32_t count)
+{
+	const int32_t bytesused=block.NumBytesUsed();
+	block.ManageArrayDestruction(first,count);
+	CountManagedObjects(blockidx,block.NumBytesUsed()-bytesused,count);
+	for(int32_t i=0;i<count;++i)
+	{
+		BlockAllocatorSetRefCounter(first+i,m_RefCount);
+	}
+	if(blockidx>=0)
+	{
+		// Still in use
+		_ASSERTE(&(Block(blockidx))==&block);
+		UpdateBlockSize(blockidx);
+	}
+}
+
+inline void BlockAllocatorSetRefCounter(const void* const /*managedobject*/,tRefCount& /*refcounter*/)
 {
-	Block(blockidx).ManageObjectDestruction(managedobject);
-	UpdateBlockSize(blockidx);
 }
 
-template<>
-inline void tBlockAllocatorT<tBlockAllocatorRefCounter>::ManageObjectDestruction(const unsigned char blockidx,
- tBlockAllocatorRefCounter& managedobject)
+inline void BlockAllocatorSetRefCounter(tBlockAllocatorRefCounter* const managedobject,tRefCount& refcounter)
 {
-	Block(blockidx).ManageObjectDestruction(managedobject);
-	managedobject.ProxyRefCounterSetObject(m_RefCount);
-	UpdateBlockSize(blockidx);
+	managedobject->ProxyRefCounterSetObject(refcounter);
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::UpdateBlockSize(const unsigned char blockidx)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UpdateBlockSize(const unsigned char blockidx)
 {
-	m_BlockSizes[blockidx]=Block(blockidx).NumBytesLeft();
+	const _tMemoryBlock& block=Block(blockidx);
+	m_BlockSizes[blockidx]=block.NumBytesLeft();
+	m_BlockPtrLowBits[blockidx]=static_cast<unsigned short>(reinterpret_cast<uintptr_t>(block.NextBytePtr()));
 	_ASSERTE(BlockSize(blockidx)>=0);
 }
 
-template<typename POLYTYPE,typename TYPE>
+template<typename POLYTYPE,typename TYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 TYPE& AllocateAndConstructPoly(
- tBlockAllocatorT<POLYTYPE>& allocator,
+ tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>& allocator,
  const int32_t size,
  typename const TYPE::tCtorArgs& args)
 {
 	return allocator.AllocateAndConstructPoly<TYPE>(args,size);
 }
 
-template<typename POLYTYPE,typename TYPE>
+template<typename POLYTYPE,typename TYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
 TYPE& AllocateAndConstructPoly(
- tBlockAllocatorT<POLYTYPE>& allocator,
+ tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>& allocator,
  const int32_t size)
 {
 	return allocator.AllocateAndConstructPoly<TYPE>(size);
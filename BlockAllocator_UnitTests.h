@@ -3,20 +3,148 @@
 #include "stdafx.h"
 #include "BlockAllocator.h"
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "IUnitTest.h"
+#include "MemoryResource.h"
+#include "StlAllocator.h"
 
-template<typename POLYTYPE>
-class tBlockAllocatorT<POLYTYPE>::UnitTest : public IUnitTest
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+class tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest : public IUnitTest
 {
 	enum eTestNumber
 	{
 		eTestFirst=0,
 		//
 		eUseUpAllBlocksTest=0,
+		eCheckpointRewindTest,
+		eScopeReusesBlocksTest,
+		eResetRetainsBlocksTest,
+		eResetRetentionPolicyTest,
+		eManagedObjectFillsBlockTest,
+		eManagedRecordSizeTest,
+		eFitPoliciesTest,
+		eAlignedFitTest,
+		eRunLengthRecordsTest,
+		eTrivialDestructorTest,
+		ePlainManagedObjectTest,
+		eEmplaceTest,
+		eArrayTest,
+		eDeallocateUnmanagedTest,
+		eStlAllocatorTest,
+		eStatsTest,
+		eBlockReportTest,
+		eBlockGrowthTest,
+		eLargeObjectTest,
 		//
 		TestCount,
 	};
 	bool UseUpAllBlocksTest();
+	bool CheckpointRewindTest();
+	bool ScopeReusesBlocksTest();
+	bool ResetRetainsBlocksTest();
+	bool ResetRetentionPolicyTest();
+	bool ManagedObjectFillsBlockTest();
+	bool ManagedRecordSizeTest();
+	bool FitPoliciesTest();
+	template<typename FIT>
+	static bool FitPolicyUsesNewestBlock(
+	 const bool expectnewest,
+	 const int64_t expectscanned);
+	struct DECLSPEC_ALIGN(64) _tAligned64
+	{
+		char Bytes[64];
+	};
+	template<typename FIT>
+	static bool AlignedFit(int64_t& numscanned);
+	bool AlignedFitTest();
+	bool RunLengthRecordsTest();
+	struct _tTrivial
+	{
+		int32_t Value;
+		_tTrivial(void):Value(7) {}
+	};
+	bool TrivialDestructorTest();
+	struct _tPlain
+	{
+		struct tCtorArgs
+		{
+			int32_t* NextToDestroy;
+			int32_t Index;
+		};
+		int32_t* m_NextToDestroy;
+		int32_t m_Index;
+		_tPlain(const tCtorArgs& args):m_NextToDestroy(args.NextToDestroy),m_Index(args.Index) {}
+		~_tPlain(void)
+		{
+			// Counts down only if destroyed newest first
+			if(*m_NextToDestroy==m_Index)
+			{
+				--*m_NextToDestroy;
+			}
+		}
+	};
+	bool PlainManagedObjectTest();
+	struct _tEmplaced
+	{
+		int32_t* m_NumAlive;
+		int32_t m_Sum;
+		_tEmplaced(
+		 int32_t* const numalive,
+		 const int32_t a,
+		 const int32_t b,
+		 const char c):m_NumAlive(numalive),m_Sum(a+b+c)
+		{
+			++*m_NumAlive;
+		}
+		~_tEmplaced(void)
+		{
+			--*m_NumAlive;
+		}
+	};
+	bool EmplaceTest();
+	bool ArrayTest();
+	bool DeallocateUnmanagedTest();
+	template<typename RESOURCE>
+	static bool StlAllocatorUsesBlocks(
+	 tBlockAllocatorT& allocator,
+	 RESOURCE& resource);
+	bool StlAllocatorTest();
+	bool StatsTest();
+	struct _tBlockReportTotals
+	{
+		int32_t NumLines;
+		int32_t NumInUse;
+		int32_t NumFull;
+		int32_t NumEvicted;
+		int32_t NumSpare;
+		int32_t NumLarge;
+		int64_t Size;
+		int64_t Used;
+		int64_t Stranded;
+		int64_t ManagedObjects;
+	};
+	static bool ReadBlockReport(
+	 const tBlockAllocatorT& allocator,
+	 _tBlockReportTotals& totals);
+	bool BlockReportTest();
+	bool BlockGrowthTest();
+	struct _tRecordsNumAlive
+	{
+		const int32_t* m_NumAlive;
+		int32_t* m_NumAliveWhenDestroyed;
+		_tRecordsNumAlive(
+		 const int32_t* const numalive,
+		 int32_t* const numalivewhendestroyed):m_NumAlive(numalive),m_NumAliveWhenDestroyed(numalivewhendestroyed) {}
+		~_tRecordsNumAlive(void)
+		{
+			*m_NumAliveWhenDestroyed=*m_NumAlive;
+		}
+	};
+	bool LargeObjectTest();
+	static int NumSpareBlocks(const tBlockAllocatorT& allocator);
+	static void AllocateCycle(tBlockAllocatorT& allocator);
 public:
 	unsigned short GetFirstTest(void) const override
 	{
@@ -37,9 +165,9 @@ public:
 	bool DoTest(const unsigned short testnum) override;
 };
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::UnitTest::GetTestName(const unsigned short testnum,const unsigned short testnamecount,
- WCHAR* const testname) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::GetTestName(const unsigned short testnum,
+ const unsigned short testnamecount,WCHAR* const testname) const
 {
 	switch(testnum)
 	{
@@ -49,12 +177,69 @@ void tBlockAllocatorT<POLYTYPE>::UnitTest::GetTestName(const unsigned short test
 	case eUseUpAllBlocksTest:
 		wcscpy_s(testname,testnamecount,L"UseUpAllBlocks");
 		break;
+	case eCheckpointRewindTest:
+		wcscpy_s(testname,testnamecount,L"CheckpointRewind");
+		break;
+	case eScopeReusesBlocksTest:
+		wcscpy_s(testname,testnamecount,L"ScopeReusesBlocks");
+		break;
+	case eResetRetainsBlocksTest:
+		wcscpy_s(testname,testnamecount,L"ResetRetainsBlocks");
+		break;
+	case eResetRetentionPolicyTest:
+		wcscpy_s(testname,testnamecount,L"ResetRetentionPolicy");
+		break;
+	case eManagedObjectFillsBlockTest:
+		wcscpy_s(testname,testnamecount,L"ManagedObjectFillsBlock");
+		break;
+	case eManagedRecordSizeTest:
+		wcscpy_s(testname,testnamecount,L"ManagedRecordSize");
+		break;
+	case eFitPoliciesTest:
+		wcscpy_s(testname,testnamecount,L"FitPolicies");
+		break;
+	case eAlignedFitTest:
+		wcscpy_s(testname,testnamecount,L"AlignedFit");
+		break;
+	case eRunLengthRecordsTest:
+		wcscpy_s(testname,testnamecount,L"RunLengthRecords");
+		break;
+	case eTrivialDestructorTest:
+		wcscpy_s(testname,testnamecount,L"TrivialDestructor");
+		break;
+	case ePlainManagedObjectTest:
+		wcscpy_s(testname,testnamecount,L"PlainManagedObject");
+		break;
+	case eEmplaceTest:
+		wcscpy_s(testname,testnamecount,L"Emplace");
+		break;
+	case eArrayTest:
+		wcscpy_s(testname,testnamecount,L"Array");
+		break;
+	case eDeallocateUnmanagedTest:
+		wcscpy_s(testname,testnamecount,L"DeallocateUnmanaged");
+		break;
+	case eStlAllocatorTest:
+		wcscpy_s(testname,testnamecount,L"StlAllocator");
+		break;
+	case eStatsTest:
+		wcscpy_s(testname,testnamecount,L"Stats");
+		break;
+	case eBlockReportTest:
+		wcscpy_s(testname,testnamecount,L"BlockReport");
+		break;
+	case eBlockGrowthTest:
+		wcscpy_s(testname,testnamecount,L"BlockGrowth");
+		break;
+	case eLargeObjectTest:
+		wcscpy_s(testname,testnamecount,L"LargeObject");
+		break;
 	}
 }
 
-template<typename POLYTYPE>
-void tBlockAllocatorT<POLYTYPE>::UnitTest::GetTestDescription(const unsigned short testnum,
- const unsigned short descrcount,WCHAR* const descr) const
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::GetTestDescription(
+ const unsigned short testnum,const unsigned short descrcount,WCHAR* const descr) const
 {
 	switch(testnum)
 	{
@@ -65,11 +250,86 @@ void tBlockAllocatorT<POLYTYPE>::UnitTest::GetTestDescription(const unsigned sho
 		wcscpy_s(descr,descrcount,
 		 L"Test the mechanism which throws away the smallest block when all block spaces are used up");
 		break;
+	case eCheckpointRewindTest:
+		wcscpy_s(descr,descrcount,
+		 L"Rewinding to a checkpoint destroys the objects allocated since and puts the blocks back as they were");
+		break;
+	case eScopeReusesBlocksTest:
+		wcscpy_s(descr,descrcount,
+		 L"Allocating in a scope within a loop reuses the same blocks on every iteration");
+		break;
+	case eResetRetainsBlocksTest:
+		wcscpy_s(descr,descrcount,
+		 L"After a Reset the same cycle of allocations fits in one first block which is reused every cycle");
+		break;
+	case eResetRetentionPolicyTest:
+		wcscpy_s(descr,descrcount,
+		 L"Reset keeps only the blocks the retention policy allows");
+		break;
+	case eManagedObjectFillsBlockTest:
+		wcscpy_s(descr,descrcount,
+		 L"A managed object which leaves it's block nearly full is destroyed with that block once it's removed");
+		break;
+	case eManagedRecordSizeTest:
+		wcscpy_s(descr,descrcount,L"An object derived from POLYTYPE needs only a pointer's space for it's record");
+		break;
+	case eFitPoliciesTest:
+		wcscpy_s(descr,descrcount,
+		 L"First fit uses the oldest block with space, best fit the fullest and next fit the last used");
+		break;
+	case eAlignedFitTest:
+		wcscpy_s(descr,descrcount,
+		 L"Only blocks with space for an object once it's aligned are tried");
+		break;
+	case eRunLengthRecordsTest:
+		wcscpy_s(descr,descrcount,
+		 L"Consecutive managed objects of the same type share one record, which a rewind can cut short");
+		break;
+	case eTrivialDestructorTest:
+		wcscpy_s(descr,descrcount,
+		 L"An object with a trivial destructor is constructed but not wrapped or managed");
+		break;
+	case ePlainManagedObjectTest:
+		wcscpy_s(descr,descrcount,
+		 L"Objects with no vtable are allocated unwrapped, one after the other, and destroyed newest first");
+		break;
+	case eEmplaceTest:
+		wcscpy_s(descr,descrcount,
+		 L"Objects are constructed in place from their constructor arguments, with no tCtorArgs");
+		break;
+	case eArrayTest:
+		wcscpy_s(descr,descrcount,
+		 L"An array is allocated in one go with a single destruction record, which a rewind can cut short");
+		break;
+	case eDeallocateUnmanagedTest:
+		wcscpy_s(descr,descrcount,
+		 L"Memory given back is reused only if it was the last allocated, and a rewind past it still works");
+		break;
+	case eStlAllocatorTest:
+		wcscpy_s(descr,descrcount,
+		 L"An STL container allocates from the blocks, directly and through an IMemoryResource");
+		break;
+	case eStatsTest:
+		wcscpy_s(descr,descrcount,
+		 L"The stats follow the blocks, padding, held on blocks and managed objects through a rewind, reset and clear");
+		break;
+	case eBlockReportTest:
+		wcscpy_s(descr,descrcount,
+		 L"The block report has a line for every block, with why each held on block was retired, adding up to the stats");
+		break;
+	case eBlockGrowthTest:
+		wcscpy_s(descr,descrcount,
+		 L"Subsequent blocks grow by the growth factor up to the maximum, and shrink back after quiet cycles");
+		break;
+	case eLargeObjectTest:
+		wcscpy_s(descr,descrcount,
+		 L"Objects over the threshold get a block of their own, leaving the blocks in use alone, until rewound or reset");
+		break;
 	}
 }
 
-template<typename POLYTYPE>
-bool tBlockAllocatorT<POLYTYPE>::UnitTest::DoTest(const unsigned short testnum)
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::DoTest(const unsigned short testnum)
 {
 	switch(testnum)
 	{
@@ -78,13 +338,51 @@ bool tBlockAllocatorT<POLYTYPE>::UnitTest::DoTest(const unsigned short testnum)
 		// No return
 	case eUseUpAllBlocksTest:
 		return UseUpAllBlocksTest();
+	case eCheckpointRewindTest:
+		return CheckpointRewindTest();
+	case eScopeReusesBlocksTest:
+		return ScopeReusesBlocksTest();
+	case eResetRetainsBlocksTest:
+		return ResetRetainsBlocksTest();
+	case eResetRetentionPolicyTest:
+		return ResetRetentionPolicyTest();
+	case eManagedObjectFillsBlockTest:
+		return ManagedObjectFillsBlockTest();
+	case eManagedRecordSizeTest:
+		return ManagedRecordSizeTest();
+	case eFitPoliciesTest:
+		return FitPoliciesTest();
+	case eAlignedFitTest:
+		return AlignedFitTest();
+	case eRunLengthRecordsTest:
+		return RunLengthRecordsTest();
+	case eTrivialDestructorTest:
+		return TrivialDestructorTest();
+	case ePlainManagedObjectTest:
+		return PlainManagedObjectTest();
+	case eEmplaceTest:
+		return EmplaceTest();
+	case eArrayTest:
+		return ArrayTest();
+	case eDeallocateUnmanagedTest:
+		return DeallocateUnmanagedTest();
+	case eStlAllocatorTest:
+		return StlAllocatorTest();
+	case eStatsTest:
+		return StatsTest();
+	case eBlockReportTest:
+		return BlockReportTest();
+	case eBlockGrowthTest:
+		return BlockGrowthTest();
+	case eLargeObjectTest:
+		return LargeObjectTest();
 	}
 }
 
-template<typename POLYTYPE>
-bool tBlockAllocatorT<POLYTYPE>::UnitTest::UseUpAllBlocksTest()
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::UseUpAllBlocksTest()
 {
-	typedef tBlockAllocatorT<POLYTYPE> _tAllocator;
+	typedef tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY> _tAllocator;
 	typedef tManagedMemoryBlockT<POLYTYPE> _tMemBlock;
 	_tAllocator allocator(1000);
 	allocator.CreateFirstBlock();
@@ -170,4 +468,722 @@ bool tBlockAllocatorT<POLYTYPE>::UnitTest::UseUpAllBlocksTest()
 		}
 	}
 	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::CheckpointRewindTest()
+{
+	typedef tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY> _tAllocator;
+	typedef tManagedMemoryBlockT<POLYTYPE> _tMemBlock;
+	_tAllocator allocator(1000);
+	allocator.AllocateAndConstructPoly<POLYTYPE>();
+	allocator.AllocateUnmanaged<char[100]>();
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==1);
+	const unsigned char numblocks=allocator.m_NumBlocks;
+	_tMemBlock* const block=allocator.m_Blocks[0];
+	const int32_t blocksize=allocator.m_BlockSizes[0];
+	const typename _tAllocator::tCheckpoint checkpoint=allocator.Checkpoint();
+	// Enough to create new blocks and retire some of them, including the block in use at the checkpoint
+	POLYTYPE& firstobject=allocator.AllocateAndConstructPoly<POLYTYPE>();
+	for(int i=0;i<20;++i)
+	{
+		allocator.AllocateAndConstructPoly<POLYTYPE>();
+		allocator.AllocateUnmanaged<char[500]>();
+	}
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==22);
+	allocator.Rewind(checkpoint);
+	// Only the object allocated before the checkpoint is left
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==1);
+	UNITTEST_ASSERT(allocator.m_NumBlocks==numblocks);
+	UNITTEST_ASSERT(allocator.m_Blocks[0]==block && allocator.m_BlockSizes[0]==blocksize);
+	UNITTEST_ASSERT(!block->PreviousBlock());
+	UNITTEST_ASSERT(allocator.m_SpareBlocks);
+	// The memory is used again
+	POLYTYPE& object=allocator.AllocateAndConstructPoly<POLYTYPE>();
+	UNITTEST_ASSERT(&object==&firstobject);
+	// An object allocated since the checkpoint in a block in use at the time, referring to one in a block created
+	//  since, which must still be alive when it's destroyed
+	int32_t numalive=0;
+	{
+		_tAllocator refallocator(1000);
+		refallocator.AllocateUnmanaged<char[100]>();
+		const _tMemBlock* const oldblock=refallocator.m_Blocks[0];
+		const typename _tAllocator::tCheckpoint refcheckpoint=refallocator.Checkpoint();
+		// Too big for the block in use, so goes in a new block
+		const int32_t count=900/sizeof(_tEmplaced);
+		refallocator.AllocateAndConstructArray<_tEmplaced>(count,&numalive,1,2,'3');
+		UNITTEST_ASSERT(numalive==count && !oldblock->NumManagedObjects());
+		// Fits back in to the old block
+		int32_t numalivewhendestroyed=-1;
+		refallocator.Emplace<_tRecordsNumAlive>(&numalive,&numalivewhendestroyed);
+		UNITTEST_ASSERT(oldblock->NumManagedObjects()==1);
+		refallocator.Rewind(refcheckpoint);
+		UNITTEST_ASSERT(numalivewhendestroyed==count && !numalive);
+	}
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::ScopeReusesBlocksTest()
+{
+	typedef tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY> _tAllocator;
+	typedef tManagedMemoryBlockT<POLYTYPE> _tMemBlock;
+	_tAllocator allocator(1000);
+	allocator.CreateFirstBlock();
+	int numspareblocksexpected=-1;
+	for(int iteration=0;iteration<10;++iteration)
+	{
+		{
+			tBlockAllocatorScopeT<_tAllocator> scope(allocator);
+			for(int i=0;i<20;++i)
+			{
+				allocator.AllocateAndConstructPoly<POLYTYPE>();
+				allocator.AllocateUnmanaged<char[500]>();
+			}
+			UNITTEST_ASSERT(allocator.m_RefCount.Count()==20);
+		}
+		UNITTEST_ASSERT(allocator.m_RefCount.Count()==0);
+		// Every block created during the first iteration is kept. Had any more been created since, there would be
+		//  more spare blocks.
+		int numspareblocks=0;
+		for(_tMemBlock* pblock=allocator.m_SpareBlocks;pblock;pblock=pblock->PreviousBlock())
+		{
+			++numspareblocks;
+		}
+		if(!iteration)
+		{
+			numspareblocksexpected=numspareblocks;
+		}
+		UNITTEST_ASSERT(numspareblocks>0 && numspareblocks==numspareblocksexpected);
+	}
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+int tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::NumSpareBlocks(
+ const tBlockAllocatorT& allocator)
+{
+	int rv=0;
+	for(_tMemoryBlock* pblock=allocator.m_SpareBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		++rv;
+	}
+	for(_tMemoryBlock* pblock=allocator.m_RetainedBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		++rv;
+	}
+	return rv;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+void tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::AllocateCycle(tBlockAllocatorT& allocator)
+{
+	for(int i=0;i<20;++i)
+	{
+		allocator.AllocateAndConstructPoly<POLYTYPE>();
+		allocator.AllocateUnmanaged<char[500]>();
+	}
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::ResetRetainsBlocksTest()
+{
+	tBlockAllocatorT allocator(1000);
+	// The first cycle uses many small blocks
+	AllocateCycle(allocator);
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==20);
+	allocator.Reset();
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==0);
+	UNITTEST_ASSERT(!allocator.m_NumBlocks);
+	const int numblocksfirstcycle=NumSpareBlocks(allocator);
+	UNITTEST_ASSERT(numblocksfirstcycle>1);
+	// From then on it all fits in the first block
+	AllocateCycle(allocator);
+	UNITTEST_ASSERT(allocator.m_NumBlocks==1);
+	_tMemoryBlock* const firstblock=allocator.m_Blocks[0];
+	allocator.Reset();
+	// So the small blocks went unused and are freed, leaving only the first block
+	UNITTEST_ASSERT(NumSpareBlocks(allocator)==1 && allocator.m_RetainedBlocks==firstblock);
+	for(int cycle=0;cycle<10;++cycle)
+	{
+		AllocateCycle(allocator);
+		UNITTEST_ASSERT(allocator.m_NumBlocks==1 && allocator.m_Blocks[0]==firstblock);
+		allocator.Reset();
+		UNITTEST_ASSERT(NumSpareBlocks(allocator)==1 && allocator.m_RetainedBlocks==firstblock);
+	}
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::ResetRetentionPolicyTest()
+{
+	tBlockAllocatorT allocator(1000);
+	AllocateCycle(allocator);
+	allocator.SetRetention(eRetainBytes,2500);
+	allocator.Reset();
+	// The blocks from the first cycle are 1000 bytes each
+	UNITTEST_ASSERT(NumSpareBlocks(allocator)==2);
+	for(_tMemoryBlock* pblock=allocator.m_RetainedBlocks;pblock;pblock=pblock->PreviousBlock())
+	{
+		UNITTEST_ASSERT(pblock->Size()==1000);
+	}
+	AllocateCycle(allocator);
+	allocator.SetRetention(eRetainLargestBlocks,2);
+	allocator.Reset();
+	// The small blocks went unused so only the right sized first block is kept
+	UNITTEST_ASSERT(NumSpareBlocks(allocator)==1 && allocator.m_RetainedBlocks->Size()>1000);
+	allocator.SetRetention(eRetainBytes,0);
+	allocator.Reset();
+	UNITTEST_ASSERT(!NumSpareBlocks(allocator));
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::ManagedObjectFillsBlockTest()
+{
+	tBlockAllocatorT allocator(1000);
+	allocator.AllocateUnmanaged<char[600]>();
+	allocator.AllocateUnmanaged<char[600]>();
+	UNITTEST_ASSERT(allocator.m_NumBlocks==2);
+	_tMemoryBlock* const firstblock=allocator.m_Blocks[0];
+	_tMemoryBlock* const secondblock=allocator.m_Blocks[1];
+	// Leave more than the cut off point, but not once the managed object's pointer is added
+	const int32_t size=allocator.m_BlockSizes[0]-static_cast<int32_t>(eBlockCutOffPointBytes+sizeof(POLYTYPE*));
+	allocator.AllocateAndConstructPoly<POLYTYPE>(size);
+	UNITTEST_ASSERT(firstblock->NumBytesLeft()<=eBlockCutOffPointBytes);
+	// The first block was removed and the last block has taken it's place
+	UNITTEST_ASSERT(allocator.m_NumBlocks==1 && allocator.m_Blocks[0]==secondblock);
+	UNITTEST_ASSERT(secondblock->PreviousBlock()==firstblock);
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==1);
+	allocator.DestroyManagedObjects();
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==0);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::ManagedRecordSizeTest()
+{
+	tBlockAllocatorT allocator(1000);
+	allocator.CreateFirstBlock();
+	_tMemoryBlock* const firstblock=allocator.m_Blocks[0];
+	// Leave only the space for a single record, which would be too little were a run counted for every object
+	const int32_t size=allocator.m_BlockSizes[0]-static_cast<int32_t>(sizeof(POLYTYPE*));
+	allocator.AllocateAndConstructPoly<POLYTYPE>(size);
+	UNITTEST_ASSERT(allocator.m_NumBlocks==1 && allocator.m_Blocks[0]==firstblock);
+	UNITTEST_ASSERT(!firstblock->NumBytesLeft() && firstblock->NumManagedObjects()==1);
+	// Only a single object derived from POLYTYPE can be recorded singly, anything else managed starts a run
+	UNITTEST_ASSERT(_tMemoryBlock::RecordSize<POLYTYPE>(1)==static_cast<int32_t>(sizeof(POLYTYPE*)));
+	UNITTEST_ASSERT(_tMemoryBlock::RecordSize<POLYTYPE>(2)==_tMemoryBlock::eOverheadForManagedObject);
+	UNITTEST_ASSERT(_tMemoryBlock::RecordSize<std::string>(1)==_tMemoryBlock::eOverheadForManagedObject);
+	UNITTEST_ASSERT(_tMemoryBlock::RecordSize<int32_t>(1)==0);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename FIT>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::FitPolicyUsesNewestBlock(
+ const bool expectnewest,const int64_t expectscanned)
+{
+	tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FIT> allocator(2000);
+	// Two blocks, the newest with the least space left
+	char* const first=allocator.AllocateUnmanaged<char[1000]>();
+	char* const second=allocator.AllocateUnmanaged<char[1500]>();
+	char* const third=allocator.AllocateUnmanaged<char[100]>();
+	UNITTEST_ASSERT(third==((expectnewest)?second+1500:first+1000));
+	const tBlockAllocatorCounters& counters=allocator.Counters();
+	UNITTEST_ASSERT(counters.NumAllocations==3 && counters.NumBlocksScanned==expectscanned);
+	UNITTEST_ASSERT(counters.NumBlocksCreated==2 && counters.NumBytesWasted==0);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::FitPoliciesTest()
+{
+	// The first two allocations each look at the only block. For the third, first fit stops at the oldest block,
+	//  best fit looks at both and next fit starts from the newest
+	UNITTEST_ASSERT(FitPolicyUsesNewestBlock<tFirstFit>(false,3));
+	// The newest block is the fullest and the last used
+	UNITTEST_ASSERT(FitPolicyUsesNewestBlock<tBestFit>(true,4));
+	UNITTEST_ASSERT(FitPolicyUsesNewestBlock<tNextFit>(true,3));
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename FIT>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::AlignedFit(int64_t& numscanned)
+{
+	tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FIT> allocator(1000);
+	// Odd sizes so blocks are left at every alignment, with every amount of space
+	for(int i=0;i<200;++i)
+	{
+		const int32_t oddsize=((i*37)%200)+1;
+		allocator.AllocateUnmanaged(oddsize,1);
+		_tAligned64& aligned=allocator.AllocateUnmanaged<_tAligned64>();
+		UNITTEST_ASSERT(!(reinterpret_cast<uintptr_t>(&aligned)%64));
+	}
+	// Every allocation looked at the block it used at least
+	const tBlockAllocatorCounters& counters=allocator.Counters();
+	UNITTEST_ASSERT(counters.NumAllocations==400 && counters.NumBlocksScanned>=counters.NumAllocations);
+	numscanned=counters.NumBlocksScanned;
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::AlignedFitTest()
+{
+	int64_t firstfitscanned=0;
+	UNITTEST_ASSERT(AlignedFit<tFirstFit>(firstfitscanned));
+	int64_t bestfitscanned=0;
+	UNITTEST_ASSERT(AlignedFit<tBestFit>(bestfitscanned));
+	// Best fit looks at every block each time, first fit stops at the first with space
+	UNITTEST_ASSERT(bestfitscanned>firstfitscanned);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::RunLengthRecordsTest()
+{
+	tBlockAllocatorT allocator(10000);
+	for(int i=0;i<100;++i)
+	{
+		allocator.AllocateAndConstructPoly<POLYTYPE>();
+	}
+	const _tMemoryBlock& block=*(allocator.m_Blocks[0]);
+	UNITTEST_ASSERT(allocator.m_NumBlocks==1 && block.NumManagedObjects()==100);
+	// A run takes the space of 4 single records however many objects it has
+	const int32_t runsize=4*sizeof(POLYTYPE*);
+	UNITTEST_ASSERT(block.NumBytesUsed()==static_cast<int32_t>(100*sizeof(POLYTYPE))+runsize);
+	const typename tBlockAllocatorT::tCheckpoint checkpoint=allocator.Checkpoint();
+	for(int i=0;i<50;++i)
+	{
+		allocator.AllocateAndConstructPoly<POLYTYPE>();
+	}
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==150);
+	UNITTEST_ASSERT(block.NumBytesUsed()==static_cast<int32_t>(150*sizeof(POLYTYPE))+runsize);
+	// Only the objects after the checkpoint are destroyed
+	allocator.Rewind(checkpoint);
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==100 && block.NumManagedObjects()==100);
+	// The run carries on from where it was cut short
+	for(int i=0;i<10;++i)
+	{
+		allocator.AllocateAndConstructPoly<POLYTYPE>();
+	}
+	UNITTEST_ASSERT(block.NumBytesUsed()==static_cast<int32_t>(110*sizeof(POLYTYPE))+runsize);
+	allocator.Reset();
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==0);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::TrivialDestructorTest()
+{
+	tBlockAllocatorT allocator(1000);
+	const _tTrivial& object=allocator.AllocateAndConstruct<_tTrivial>();
+	UNITTEST_ASSERT(object.Value==7);
+	const _tMemoryBlock& block=*(allocator.m_Blocks[0]);
+	UNITTEST_ASSERT(block.NumManagedObjects()==0);
+	UNITTEST_ASSERT(block.NumBytesUsed()==sizeof(_tTrivial));
+	// A destructor which does something is still managed
+	allocator.AllocateAndConstructPoly<POLYTYPE>();
+	UNITTEST_ASSERT(block.NumManagedObjects()==1);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::PlainManagedObjectTest()
+{
+	int32_t nexttodestroy=9;
+	{
+		tBlockAllocatorT allocator(1000);
+		const _tPlain* previous=NULL;
+		for(int32_t i=0;i<10;++i)
+		{
+			const typename _tPlain::tCtorArgs args=
+			{
+				&nexttodestroy,
+				i,
+			};
+			const _tPlain& object=allocator.AllocateAndConstruct<_tPlain>(args);
+			UNITTEST_ASSERT(!previous || &object==previous+1);
+			previous=&object;
+		}
+		// The objects share a single run record
+		const _tMemoryBlock& block=*(allocator.m_Blocks[0]);
+		UNITTEST_ASSERT(block.NumManagedObjects()==10);
+		UNITTEST_ASSERT(block.NumBytesUsed()==
+		 static_cast<int32_t>((10*sizeof(_tPlain))+_tMemoryBlock::eOverheadForManagedObject));
+	}
+	UNITTEST_ASSERT(nexttodestroy==-1);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::EmplaceTest()
+{
+	int32_t numalive=0;
+	{
+		tBlockAllocatorT allocator(1000);
+		const _tEmplaced& object=allocator.Emplace<_tEmplaced>(&numalive,1,2,'\x03');
+		UNITTEST_ASSERT(object.m_Sum==6);
+		UNITTEST_ASSERT(numalive==1);
+		// Lazily
+		tLazyT<_tEmplaced,POLYTYPE>& lazy=allocator.Allocate<_tEmplaced>();
+		UNITTEST_ASSERT(!lazy.IsConstructed());
+		lazy.Emplace(&numalive,10,20,'\0');
+		UNITTEST_ASSERT(lazy.IsConstructed());
+		UNITTEST_ASSERT((*lazy).m_Sum==30);
+		UNITTEST_ASSERT(numalive==2);
+		// Constructed again in place
+		lazy.Emplace(&numalive,4,5,'\0');
+		UNITTEST_ASSERT((*lazy).m_Sum==9);
+		UNITTEST_ASSERT(numalive==2);
+	}
+	UNITTEST_ASSERT(numalive==0);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::ArrayTest()
+{
+	tBlockAllocatorT allocator(10000);
+	const POLYTYPE* const objects=allocator.AllocateArray<POLYTYPE>(100);
+	const _tMemoryBlock& block=*(allocator.m_Blocks[0]);
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==100 && block.NumManagedObjects()==100);
+	// The objects are consecutive and share a single run record
+	UNITTEST_ASSERT(block.NextBytePtr()==reinterpret_cast<const char*>(objects+100));
+	UNITTEST_ASSERT(block.NumBytesUsed()==
+	 static_cast<int32_t>((100*sizeof(POLYTYPE))+_tMemoryBlock::eOverheadForManagedObject));
+	// Objects which follow on are added to the run
+	const typename tBlockAllocatorT::tCheckpoint checkpoint=allocator.Checkpoint();
+	allocator.AllocateAndConstructPoly<POLYTYPE>();
+	allocator.AllocateArray<POLYTYPE>(49);
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==150 && block.NumManagedObjects()==150);
+	UNITTEST_ASSERT(block.NumBytesUsed()==
+	 static_cast<int32_t>((150*sizeof(POLYTYPE))+_tMemoryBlock::eOverheadForManagedObject));
+	allocator.Rewind(checkpoint);
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==100 && block.NumManagedObjects()==100);
+	// Constructed from arguments
+	int32_t numalive=0;
+	const _tEmplaced* const emplaced=allocator.AllocateAndConstructArray<_tEmplaced>(10,&numalive,1,2,'\x03');
+	UNITTEST_ASSERT(numalive==10);
+	for(int i=0;i<10;++i)
+	{
+		UNITTEST_ASSERT(emplaced[i].m_Sum==6);
+	}
+	// Not managed
+	const _tTrivial* const trivial=allocator.AllocateArray<_tTrivial>(10);
+	UNITTEST_ASSERT(trivial[0].Value==7 && trivial[9].Value==7);
+	UNITTEST_ASSERT(block.NumManagedObjects()==110);
+	allocator.Reset();
+	UNITTEST_ASSERT(allocator.m_RefCount.Count()==0 && numalive==0);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::DeallocateUnmanagedTest()
+{
+	tBlockAllocatorT allocator(1000);
+	allocator.CreateFirstBlock();
+	const _tMemoryBlock& block=*(allocator.m_Blocks[0]);
+	// A multiple of the alignment, so there is no padding between them
+	void* const first=allocator.AllocateUnmanaged(96,8);
+	void* const second=allocator.AllocateUnmanaged(96,8);
+	const int32_t bytesused=block.NumBytesUsed();
+	// Not the newest, kept
+	allocator.DeallocateUnmanaged(first,96);
+	UNITTEST_ASSERT(block.NumBytesUsed()==bytesused);
+	// The newest, reused straight away
+	allocator.DeallocateUnmanaged(second,96);
+	UNITTEST_ASSERT(block.NumBytesUsed()==bytesused-96);
+	void* const reused=allocator.AllocateUnmanaged(96,8);
+	UNITTEST_ASSERT(reused==second);
+	// Given back past a checkpoint, the rewind leaves the pointer where it is
+	const typename tBlockAllocatorT::tCheckpoint checkpoint=allocator.Checkpoint();
+	allocator.DeallocateUnmanaged(second,96);
+	allocator.DeallocateUnmanaged(first,96);
+	const int32_t bytesgivenback=block.NumBytesUsed();
+	allocator.Rewind(checkpoint);
+	UNITTEST_ASSERT(block.NumBytesUsed()==bytesgivenback);
+	void* const reusedafterrewind=allocator.AllocateUnmanaged(96,8);
+	UNITTEST_ASSERT(reusedafterrewind==first);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+template<typename RESOURCE>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::StlAllocatorUsesBlocks(
+ tBlockAllocatorT& allocator,RESOURCE& resource)
+{
+	typedef tStlAllocatorT<int32_t,RESOURCE> _tStlAllocator;
+	const int32_t bytesused=allocator.NumBytesUsed();
+	{
+		std::vector<int32_t,_tStlAllocator> values((_tStlAllocator(resource)));
+		values.reserve(100);
+		UNITTEST_ASSERT(allocator.NumBytesUsed()==bytesused+static_cast<int32_t>(100*sizeof(int32_t)));
+		for(int32_t i=0;i<100;++i)
+		{
+			values.push_back(i);
+		}
+		UNITTEST_ASSERT(values[99]==99);
+		// Only what was reserved
+		UNITTEST_ASSERT(allocator.NumBytesUsed()==bytesused+static_cast<int32_t>(100*sizeof(int32_t)));
+	}
+	// It was the last allocation so it's given back
+	UNITTEST_ASSERT(allocator.NumBytesUsed()==bytesused);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::StlAllocatorTest()
+{
+	tBlockAllocatorT allocator(10000);
+	allocator.CreateFirstBlock();
+	UNITTEST_ASSERT(StlAllocatorUsesBlocks(allocator,allocator));
+	tMemoryResourceT<tBlockAllocatorT> memoryresource(allocator);
+	IMemoryResource& resource=memoryresource;
+	UNITTEST_ASSERT(StlAllocatorUsesBlocks(allocator,resource));
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::StatsTest()
+{
+	tBlockAllocatorT allocator(1000);
+	tBlockAllocatorStats stats=allocator.Stats();
+	UNITTEST_ASSERT(!stats.NumBytesReserved && !stats.NumBytesUsed && !stats.NumBlocks);
+	allocator.CreateFirstBlock();
+	const _tMemoryBlock& firstblock=*(allocator.m_Blocks[0]);
+	// An odd size leaves the next object to be padded
+	const char* const odd=static_cast<const char*>(allocator.AllocateUnmanaged(1,1));
+	const _tAligned64& aligned=allocator.AllocateUnmanaged<_tAligned64>();
+	const int32_t pad=static_cast<int32_t>(reinterpret_cast<const char*>(&aligned)-(odd+1));
+	allocator.AllocateAndConstructPoly<POLYTYPE>();
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(stats.NumBlocks==1 && stats.NumBytesReserved==firstblock.Size());
+	UNITTEST_ASSERT(stats.NumBytesUsed==firstblock.NumBytesUsed());
+	UNITTEST_ASSERT(stats.Counters.NumBytesPadded==pad && stats.NumManagedObjects==1);
+	UNITTEST_ASSERT(!stats.NumBlocksRetired && !stats.NumBytesStranded);
+	// Too big for the first block, then leave the first block with too little space to be kept in use once the managed
+	//  object's pointer is added
+	const typename tBlockAllocatorT::tCheckpoint checkpoint=allocator.Checkpoint();
+	allocator.AllocateUnmanaged(allocator.m_BlockSizes[0]+1,1);
+	UNITTEST_ASSERT(allocator.m_NumBlocks==2);
+	const int32_t size=allocator.m_BlockSizes[0]-static_cast<int32_t>(eBlockCutOffPointBytes+sizeof(POLYTYPE*));
+	allocator.AllocateAndConstructPoly<POLYTYPE>(size);
+	UNITTEST_ASSERT(allocator.m_NumBlocks==1 && allocator.m_Blocks[0]!=&firstblock);
+	const _tMemoryBlock& secondblock=*(allocator.m_Blocks[0]);
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(stats.NumBlocks==2 && stats.NumBytesReserved==firstblock.Size()+secondblock.Size());
+	UNITTEST_ASSERT(stats.NumBytesUsed==firstblock.NumBytesUsed()+secondblock.NumBytesUsed());
+	UNITTEST_ASSERT(stats.NumBlocksRetired==1 && stats.Counters.NumBlocksRetired==1);
+	UNITTEST_ASSERT(stats.NumBytesStranded==firstblock.NumBytesLeft() && stats.NumManagedObjects==2);
+	UNITTEST_ASSERT(stats.Counters.NumBlocksCreated==2 && stats.Counters.NumBlocksAllocated==2);
+	// The block created since the checkpoint is kept as a spare
+	allocator.Rewind(checkpoint);
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(stats.NumBlocks==2 && stats.NumSpareBlocks==1 && !stats.NumBlocksRetired);
+	UNITTEST_ASSERT(stats.NumBytesUsed==firstblock.NumBytesUsed() && stats.NumManagedObjects==1);
+	// Spares are reused rather than allocated
+	allocator.AllocateUnmanaged(allocator.m_BlockSizes[0]+1,1);
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(stats.Counters.NumBlocksCreated==3 && stats.Counters.NumBlocksAllocated==2);
+	UNITTEST_ASSERT(stats.NumBlocks==2 && !stats.NumSpareBlocks);
+	allocator.Reset();
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(stats.NumBlocks==2 && stats.NumSpareBlocks==2);
+	UNITTEST_ASSERT(!stats.NumBytesUsed && !stats.NumBytesStranded && !stats.NumManagedObjects);
+	// The counters start again but what the allocator holds doesn't
+	allocator.ResetCounters();
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(!stats.Counters.NumBlocksCreated && stats.NumBlocks==2);
+	allocator.Clear();
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(!stats.NumBytesReserved && !stats.NumBytesUsed && !stats.NumBlocks && !stats.NumSpareBlocks);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::ReadBlockReport(
+ const tBlockAllocatorT& allocator,_tBlockReportTotals& totals)
+{
+	memset(&totals,0,sizeof(totals));
+	std::ostringstream out;
+	allocator.WriteBlockReport(out);
+	std::istringstream in(out.str());
+	std::string line;
+	std::getline(in,line);
+	UNITTEST_ASSERT(line=="chain,state,size,used,stranded,managedobjects");
+	while(std::getline(in,line))
+	{
+		std::istringstream fields(line);
+		std::string chain,state,size,used,stranded,managedobjects;
+		std::getline(fields,chain,',');
+		std::getline(fields,state,',');
+		std::getline(fields,size,',');
+		std::getline(fields,used,',');
+		std::getline(fields,stranded,',');
+		std::getline(fields,managedobjects);
+		++totals.NumLines;
+		if(state=="inuse")
+		{
+			++totals.NumInUse;
+		}
+		else if(state=="full")
+		{
+			++totals.NumFull;
+		}
+		else if(state=="evicted")
+		{
+			++totals.NumEvicted;
+		}
+		else if(state=="large")
+		{
+			UNITTEST_ASSERT(chain=="-1");
+			++totals.NumLarge;
+		}
+		else
+		{
+			UNITTEST_ASSERT(state=="spare" && chain=="-1");
+			++totals.NumSpare;
+		}
+		totals.Size+=atoi(size.c_str());
+		totals.Used+=atoi(used.c_str());
+		totals.Stranded+=atoi(stranded.c_str());
+		totals.ManagedObjects+=atoi(managedobjects.c_str());
+	}
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::BlockReportTest()
+{
+	tBlockAllocatorT allocator(1000);
+	// Leave the first of two blocks with too little space to be kept in use
+	allocator.AllocateUnmanaged<char[600]>();
+	allocator.AllocateUnmanaged<char[600]>();
+	const int32_t size=allocator.m_BlockSizes[0]-static_cast<int32_t>(eBlockCutOffPointBytes+sizeof(POLYTYPE*));
+	allocator.AllocateAndConstructPoly<POLYTYPE>(size);
+	UNITTEST_ASSERT(allocator.m_NumBlocks==1);
+	// Then fill the table, and need one more block so the smallest is evicted
+	for(int i=0;i<eMaxNumBlocks;++i)
+	{
+		allocator.AllocateUnmanaged<char[600]>();
+	}
+	UNITTEST_ASSERT(allocator.m_NumBlocks==eMaxNumBlocks);
+	tBlockAllocatorStats stats=allocator.Stats();
+	_tBlockReportTotals totals;
+	UNITTEST_ASSERT(ReadBlockReport(allocator,totals));
+	UNITTEST_ASSERT(totals.NumLines==stats.NumBlocks && totals.NumInUse==eMaxNumBlocks);
+	UNITTEST_ASSERT(totals.NumFull==1 && totals.NumEvicted==1 && !totals.NumSpare);
+	UNITTEST_ASSERT(totals.Size==stats.NumBytesReserved && totals.Used==stats.NumBytesUsed);
+	UNITTEST_ASSERT(totals.Stranded==stats.NumBytesStranded && totals.Stranded>0);
+	UNITTEST_ASSERT(totals.ManagedObjects==1);
+	// Every block is kept as a spare
+	allocator.Reset();
+	stats=allocator.Stats();
+	UNITTEST_ASSERT(ReadBlockReport(allocator,totals));
+	UNITTEST_ASSERT(totals.NumLines==stats.NumBlocks && totals.NumSpare==stats.NumBlocks);
+	UNITTEST_ASSERT(totals.Size==stats.NumBytesReserved && !totals.Used && !totals.Stranded);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::BlockGrowthTest()
+{
+	tBlockAllocatorT allocator(1000);
+	allocator.SetBlockGrowth(100,1000,8000,true);
+	allocator.CreateFirstBlock();
+	// Each block doubles until the maximum
+	const int32_t expectedsizes[]={1000,2000,4000,8000,8000,8000};
+	int expectedidx=0;
+	tBlockAllocatorStats stats=allocator.Stats();
+	while(expectedidx<_countof(expectedsizes))
+	{
+		allocator.AllocateUnmanaged(500,1);
+		const tBlockAllocatorStats newstats=allocator.Stats();
+		if(newstats.Counters.NumBlocksAllocated!=stats.Counters.NumBlocksAllocated)
+		{
+			UNITTEST_ASSERT(newstats.NumBytesReserved-stats.NumBytesReserved==expectedsizes[expectedidx]);
+			++expectedidx;
+		}
+		stats=newstats;
+	}
+	UNITTEST_ASSERT(allocator.m_GrowthBlockSize==8000);
+	// A busy cycle doesn't shrink it
+	allocator.Reset();
+	UNITTEST_ASSERT(allocator.m_GrowthBlockSize==8000);
+	// Each quiet cycle shrinks it a step, but not below the minimum
+	const int32_t expectedshrinks[]={4000,2000,1000,1000};
+	for(int i=0;i<_countof(expectedshrinks);++i)
+	{
+		allocator.AllocateUnmanaged(500,1);
+		allocator.Reset();
+		UNITTEST_ASSERT(allocator.m_GrowthBlockSize==expectedshrinks[i]);
+	}
+	// Without growth subsequent blocks are all the same size
+	tBlockAllocatorT fixed(1000,2000);
+	fixed.CreateFirstBlock();
+	fixed.AllocateUnmanaged(900,1);
+	fixed.AllocateUnmanaged(900,1);
+	fixed.AllocateUnmanaged(900,1);
+	stats=fixed.Stats();
+	UNITTEST_ASSERT(stats.NumBlocks==2 && stats.NumBytesReserved==1000+2000);
+	return true;
+}
+
+template<typename POLYTYPE,typename BLOCKSOURCE,int MAXNUMBLOCKS,typename FITPOLICY>
+bool tBlockAllocatorT<POLYTYPE,BLOCKSOURCE,MAXNUMBLOCKS,FITPOLICY>::UnitTest::LargeObjectTest()
+{
+	int32_t numalive=0;
+	{
+		tBlockAllocatorT allocator(1000);
+		allocator.SetLargeObjectThreshold(500);
+		allocator.CreateFirstBlock();
+		allocator.AllocateUnmanaged(100,1);
+		const _tMemoryBlock* const firstblock=allocator.m_Blocks[0];
+		const int32_t firstblocksize=allocator.m_BlockSizes[0];
+		const typename tBlockAllocatorT::tCheckpoint checkpoint=allocator.Checkpoint();
+		// Neither replaces nor takes space from the block in use
+		const int32_t count=1000/sizeof(_tEmplaced);
+		const _tEmplaced* const array=allocator.AllocateAndConstructArray<_tEmplaced>(count,&numalive,1,2,'3');
+		const void* const buffer=allocator.AllocateUnmanaged(2000,16);
+		UNITTEST_ASSERT(numalive==count && array[count-1].m_Sum==1+2+'3');
+		UNITTEST_ASSERT(!(reinterpret_cast<uintptr_t>(buffer)%16));
+		UNITTEST_ASSERT(allocator.m_NumBlocks==1 && allocator.m_Blocks[0]==firstblock);
+		UNITTEST_ASSERT(allocator.m_BlockSizes[0]==firstblocksize);
+		// A small object referring to the large ones, which must still be alive when it's destroyed
+		int32_t numalivewhendestroyed=-1;
+		allocator.Emplace<_tRecordsNumAlive>(&numalive,&numalivewhendestroyed);
+		tBlockAllocatorStats stats=allocator.Stats();
+		UNITTEST_ASSERT(stats.NumLargeBlocks==2 && stats.Counters.NumLargeObjects==2 && stats.NumBlocks==3);
+		UNITTEST_ASSERT(stats.NumManagedObjects==count+1 && !stats.NumBlocksRetired);
+		// The large objects are allocations too, but only the small ones look through the blocks in use
+		UNITTEST_ASSERT(stats.Counters.NumAllocations==4 && stats.Counters.NumBlocksScanned==2);
+		// Each is only just big enough
+		UNITTEST_ASSERT(stats.NumBytesStranded<2*(16+_tMemoryBlock::eOverheadForManagedObject+sizeof(void*)));
+		_tBlockReportTotals totals;
+		UNITTEST_ASSERT(ReadBlockReport(allocator,totals));
+		UNITTEST_ASSERT(totals.NumLarge==2 && totals.NumInUse==1 && totals.Size==stats.NumBytesReserved);
+		UNITTEST_ASSERT(totals.Stranded==stats.NumBytesStranded && totals.ManagedObjects==count+1);
+		// Freed rather than kept as spares
+		allocator.Rewind(checkpoint);
+		stats=allocator.Stats();
+		UNITTEST_ASSERT(numalivewhendestroyed==count && !numalive && !allocator.m_LargeBlocks);
+		UNITTEST_ASSERT(!stats.NumLargeBlocks && stats.NumBlocks==1 && !stats.NumSpareBlocks);
+		allocator.AllocateAndConstructArray<_tEmplaced>(count,&numalive,1,2,'3');
+		allocator.Reset();
+		stats=allocator.Stats();
+		UNITTEST_ASSERT(!numalive && !allocator.m_LargeBlocks);
+		UNITTEST_ASSERT(!stats.NumLargeBlocks && stats.NumBlocks==1 && stats.NumSpareBlocks==1);
+		// Freed by Clear, here through the destructor
+		allocator.AllocateAndConstructArray<_tEmplaced>(count,&numalive,1,2,'3');
+		UNITTEST_ASSERT(numalive==count);
+	}
+	UNITTEST_ASSERT(!numalive);
+	// Without a threshold the object goes in a block in use
+	tBlockAllocatorT allocator(1000);
+	allocator.AllocateUnmanaged(2000,1);
+	const tBlockAllocatorStats stats=allocator.Stats();
+	UNITTEST_ASSERT(!stats.NumLargeBlocks && allocator.m_NumBlocks==1);
+	return true;
 }
\ No newline at end of file
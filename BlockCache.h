@@ -0,0 +1,210 @@
+#pragma once
+
+#include <intrin.h>
+#include "BlockSource.h"
+
+// A cache of freed blocks which any number of allocators on any thread can share, so that allocators which are
+//  created and destroyed often take their blocks from here rather than from BLOCKSOURCE. Blocks are grouped in to
+//  size classes, 4 for every power of 2, and are created with at least the size of their class so that any block in
+//  a class can be used for any request in that class. Each class is an interlocked singly linked list so no lock is
+//  taken.
+template<typename BLOCKSOURCE>
+class tBlockCacheT
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	enum
+	{
+		eMinSizeShift=10,																		// The smallest size class is 1kB
+		eMaxSizeShift=28,																		// Blocks of 256MB or more are not cached
+		eSubClassShift=2,																		// 4 size classes per power of 2
+		eNumSizeClasses=(eMaxSizeShift-eMinSizeShift)<<eSubClassShift,
+		eDefaultMaxBlocksPerClass=16,
+	};
+	struct _tCachedBlock
+	{
+		SLIST_ENTRY Entry;																	// Must be first, at the beginning of the
+																									//  block's memory
+		int32_t Size;																			// The size BLOCKSOURCE gave the block
+	};
+	struct _tSizeClass
+	{
+		SLIST_HEADER Blocks;																	// The cached blocks, as _tCachedBlock
+		volatile long NumBlocks;															// The number of cached blocks
+		long MaxBlocks;																		// Blocks freed beyond this are given back to
+																									//  BLOCKSOURCE
+	};
+	friend class tBlockCache_UnitTest;
+	_tSizeClass m_SizeClasses[eNumSizeClasses];
+	//~V
+	tBlockCacheT(const tBlockCacheT&);
+	tBlockCacheT& operator=(const tBlockCacheT&);
+	static int SizeClassAtLeast(const int32_t nbytes);								// The smallest class which fits 'nbytes' or
+																									//  -1 if it's too large to cache
+	static int SizeClassAtMost(const int32_t nbytes);								// The largest class no bigger than 'nbytes'
+																									//  or -1 if there isn't one
+	static int32_t SizeClassSize(const int sizeclass);								// The block size of this class
+	//~F
+public:
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tBlockCacheT(void);
+	~tBlockCacheT(void);																		// Frees the cached blocks. No allocator may
+																									//  be using the cache
+	void* Allocate(int32_t& nbytes);														// Memory for a block of at least 'nbytes'.
+																									//  'nbytes' is rounded up to the size of
+																									//  the block given. Returns NULL if
+																									//  BLOCKSOURCE fails
+	void Free(
+	 void* const memory,
+	 const int32_t nbytes);																	// Keep this block's memory for reuse or
+																									//  free it if it's class is full
+	void SetMaxBlocks(
+	 const int32_t nbytes,
+	 const long maxblocks);																	// The number of blocks kept in the class
+																									//  for blocks of this size
+	void Trim(void);																			// Free every cached block
+	//~PF
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename BLOCKSOURCE>
+tBlockCacheT<BLOCKSOURCE>::tBlockCacheT(void)
+{
+	for(int sizeclass=0;sizeclass<eNumSizeClasses;++sizeclass)
+	{
+		_tSizeClass& iterclass=m_SizeClasses[sizeclass];
+		InitializeSListHead(&iterclass.Blocks);
+		iterclass.NumBlocks=0;
+		iterclass.MaxBlocks=eDefaultMaxBlocksPerClass;
+	}
+}
+
+template<typename BLOCKSOURCE>
+tBlockCacheT<BLOCKSOURCE>::~tBlockCacheT(void)
+{
+	Trim();
+}
+
+template<typename BLOCKSOURCE>
+int tBlockCacheT<BLOCKSOURCE>::SizeClassAtLeast(const int32_t nbytes)
+{
+	_ASSERTE(nbytes>0);
+	if(nbytes<=(1<<eMinSizeShift))
+	{
+		return 0;
+	}
+	// The classes between 2^n and 2^(n+1) are split by the next 2 bits below the most significant
+	const unsigned long lessone=static_cast<unsigned long>(nbytes-1);
+	unsigned long msb;
+	_BitScanReverse(&msb,lessone);
+	const int subclass=static_cast<int>(((lessone>>(msb-eSubClassShift))&((1<<eSubClassShift)-1))+1);
+	const int sizeclass=static_cast<int>(((msb-eMinSizeShift)<<eSubClassShift)+subclass);
+	return ((sizeclass<eNumSizeClasses)?sizeclass:-1);
+}
+
+template<typename BLOCKSOURCE>
+int tBlockCacheT<BLOCKSOURCE>::SizeClassAtMost(const int32_t nbytes)
+{
+	if(nbytes<(1<<eMinSizeShift))
+	{
+		return -1;
+	}
+	unsigned long msb;
+	_BitScanReverse(&msb,static_cast<unsigned long>(nbytes));
+	const int subclass=static_cast<int>((nbytes>>(msb-eSubClassShift))&((1<<eSubClassShift)-1));
+	const int sizeclass=static_cast<int>(((msb-eMinSizeShift)<<eSubClassShift)+subclass);
+	return ((sizeclass<eNumSizeClasses)?sizeclass:-1);
+}
+
+template<typename BLOCKSOURCE>
+int32_t tBlockCacheT<BLOCKSOURCE>::SizeClassSize(const int sizeclass)
+{
+	_ASSERTE(sizeclass>=0 && sizeclass<eNumSizeClasses);
+	const int shift=eMinSizeShift+(sizeclass>>eSubClassShift);
+	const int subclass=sizeclass&((1<<eSubClassShift)-1);
+	return (1<<shift)+(subclass<<(shift-eSubClassShift));
+}
+
+template<typename BLOCKSOURCE>
+void* tBlockCacheT<BLOCKSOURCE>::Allocate(int32_t& nbytes)
+{
+	const int sizeclass=SizeClassAtLeast(nbytes);
+	if(sizeclass<0)
+	{
+		// Too large to be cached
+		return BLOCKSOURCE::Allocate(nbytes);
+	}
+	_tSizeClass& cacheclass=m_SizeClasses[sizeclass];
+	_tCachedBlock* const cachedblock=reinterpret_cast<_tCachedBlock*>(InterlockedPopEntrySList(&cacheclass.Blocks));
+	if(cachedblock)
+	{
+		InterlockedDecrement(&cacheclass.NumBlocks);
+		nbytes=cachedblock->Size;
+		return cachedblock;
+	}
+	// Create it with the size of the class so it can be reused for any size in the class
+	nbytes=SizeClassSize(sizeclass);
+	return BLOCKSOURCE::Allocate(nbytes);
+}
+
+template<typename BLOCKSOURCE>
+void tBlockCacheT<BLOCKSOURCE>::Free(void* const memory,const int32_t nbytes)
+{
+	_ASSERTE(memory);
+	// The list entry needs the alignment malloc gives. BLOCKSOURCE must give at least the same.
+	_ASSERTE(!(reinterpret_cast<uintptr_t>(memory)%MEMORY_ALLOCATION_ALIGNMENT));
+	// A block not created by the cache may be larger than it's class, which only wastes the difference
+	const int sizeclass=SizeClassAtMost(nbytes);
+	if(sizeclass>=0)
+	{
+		_tSizeClass& cacheclass=m_SizeClasses[sizeclass];
+		if(InterlockedIncrement(&cacheclass.NumBlocks)<=cacheclass.MaxBlocks)
+		{
+			_tCachedBlock* const cachedblock=static_cast<_tCachedBlock*>(memory);
+			cachedblock->Size=nbytes;
+			InterlockedPushEntrySList(&cacheclass.Blocks,&(cachedblock->Entry));
+			return;
+		}
+		// The class is full
+		InterlockedDecrement(&cacheclass.NumBlocks);
+	}
+	BLOCKSOURCE::Free(memory,nbytes);
+}
+
+template<typename BLOCKSOURCE>
+void tBlockCacheT<BLOCKSOURCE>::SetMaxBlocks(const int32_t nbytes,const long maxblocks)
+{
+	_ASSERTE(maxblocks>=0);
+	const int sizeclass=SizeClassAtLeast(nbytes);
+	if(sizeclass>=0)
+	{
+		// Blocks already cached beyond the new limit are kept until they are used or trimmed
+		m_SizeClasses[sizeclass].MaxBlocks=maxblocks;
+	}
+}
+
+template<typename BLOCKSOURCE>
+void tBlockCacheT<BLOCKSOURCE>::Trim(void)
+{
+	for(int sizeclass=0;sizeclass<eNumSizeClasses;++sizeclass)
+	{
+		_tSizeClass& cacheclass=m_SizeClasses[sizeclass];
+		PSLIST_ENTRY entry=InterlockedFlushSList(&cacheclass.Blocks);
+		while(entry)
+		{
+			PSLIST_ENTRY const next=entry->Next;
+			InterlockedDecrement(&cacheclass.NumBlocks);
+			_tCachedBlock* const cachedblock=reinterpret_cast<_tCachedBlock*>(entry);
+			BLOCKSOURCE::Free(cachedblock,cachedblock->Size);
+			entry=next;
+		}
+	}
+}
+
+typedef tBlockCacheT<tMallocBlockSource> tBlockCache;
\ No newline at end of file
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "BlockAllocator.h"
+#include "BlockCache.h"
+#include "IUnitTest.h"
+
+class tBlockCache_UnitTest : public IUnitTest
+{
+	enum eTestNumber
+	{
+		eTestFirst=0,
+		//
+		eSizeClasses=0,
+		eReuseBetweenAllocators,
+		eMaxBlocksAndTrim,
+		//
+		TestCount,
+	};
+	typedef tBlockAllocatorT<tBlockAllocatorRefCounter> _tAllocator;
+	bool SizeClasses(void);
+	bool ReuseBetweenAllocators(void);
+	bool MaxBlocksAndTrim(void);
+public:
+	unsigned short GetFirstTest(void) const override
+	{
+		return eTestFirst;
+	}
+	unsigned short GetTestCount(void) const override
+	{
+		return TestCount;
+	}
+	void GetTestName(
+	 const unsigned short testnum,
+	 const unsigned short testnamecount,
+	 WCHAR* const testname) const override;
+	void GetTestDescription(
+	 const unsigned short testnum,
+	 const unsigned short descrcount,
+	 WCHAR* const descr) const override;
+	bool DoTest(const unsigned short testnum) override;
+};
+
+inline void tBlockCache_UnitTest::GetTestName(const unsigned short testnum,const unsigned short testnamecount,
+ WCHAR* const testname) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eSizeClasses:
+		wcscpy_s(testname,testnamecount,L"SizeClasses");
+		break;
+	case eReuseBetweenAllocators:
+		wcscpy_s(testname,testnamecount,L"ReuseBetweenAllocators");
+		break;
+	case eMaxBlocksAndTrim:
+		wcscpy_s(testname,testnamecount,L"MaxBlocksAndTrim");
+		break;
+	}
+}
+
+inline void tBlockCache_UnitTest::GetTestDescription(const unsigned short testnum,const unsigned short descrcount,
+ WCHAR* const descr) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eSizeClasses:
+		wcscpy_s(descr,descrcount,L"Block sizes are rounded up to the size of their class");
+		break;
+	case eReuseBetweenAllocators:
+		wcscpy_s(descr,descrcount,
+		 L"The blocks of a destroyed allocator are used by the next allocator rather than being freed");
+		break;
+	case eMaxBlocksAndTrim:
+		wcscpy_s(descr,descrcount,L"A size class keeps no more than it's maximum and Trim empties the cache");
+		break;
+	}
+}
+
+inline bool tBlockCache_UnitTest::SizeClasses(void)
+{
+	tBlockCache cache;
+	const int32_t requested[]=
+	{
+		1,1000,1024,1025,1280,1281,2047,2048,2049,100000,
+	};
+	const int32_t expected[]=
+	{
+		1024,1024,1024,1280,1280,1536,2048,2048,2560,114688,
+	};
+	C_ASSERT(_countof(requested)==_countof(expected));
+	for(int i=0;i<_countof(requested);++i)
+	{
+		int32_t nbytes=requested[i];
+		void* const memory=cache.Allocate(nbytes);
+		UNITTEST_ASSERT(memory);
+		UNITTEST_ASSERT(nbytes==expected[i]);
+		cache.Free(memory,nbytes);
+		// The same memory is given back for the same class
+		int32_t nbytesagain=requested[i];
+		void* const memoryagain=cache.Allocate(nbytesagain);
+		UNITTEST_ASSERT(memoryagain==memory);
+		cache.Free(memoryagain,nbytesagain);
+	}
+	return true;
+}
+
+inline bool tBlockCache_UnitTest::ReuseBetweenAllocators(void)
+{
+	tBlockCache cache;
+	void* firstblock;
+	{
+		_tAllocator allocator(1000);
+		allocator.SetBlockCache(&cache);
+		firstblock=&(allocator.AllocateUnmanaged<char[100]>());
+	}
+	{
+		_tAllocator allocator(1000);
+		allocator.SetBlockCache(&cache);
+		void* const object=&(allocator.AllocateUnmanaged<char[100]>());
+		UNITTEST_ASSERT(object==firstblock);
+	}
+	return true;
+}
+
+inline bool tBlockCache_UnitTest::MaxBlocksAndTrim(void)
+{
+	tBlockCache cache;
+	cache.SetMaxBlocks(1000,2);
+	void* memory[3];
+	for(int i=0;i<_countof(memory);++i)
+	{
+		int32_t nbytes=1000;
+		memory[i]=cache.Allocate(nbytes);
+	}
+	for(int i=0;i<_countof(memory);++i)
+	{
+		cache.Free(memory[i],1024);
+	}
+	// Only two were kept
+	int32_t nbytes=1000;
+	void* const first=cache.Allocate(nbytes);
+	void* const second=cache.Allocate(nbytes);
+	UNITTEST_ASSERT(first==memory[1] && second==memory[0]);
+	cache.Free(first,nbytes);
+	cache.Free(second,nbytes);
+	cache.Trim();
+	UNITTEST_ASSERT(!cache.m_SizeClasses[0].NumBlocks);
+	return true;
+}
+
+inline bool tBlockCache_UnitTest::DoTest(const unsigned short testnum)
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eSizeClasses:
+		return SizeClasses();
+	case eReuseBetweenAllocators:
+		return ReuseBetweenAllocators();
+	case eMaxBlocksAndTrim:
+		return MaxBlocksAndTrim();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "PsyncLib.h"
+
+// How tBlockAllocatorT chooses which of it's blocks to allocate from. A fit policy provides:
+//  int32_t ChooseBlock(const int32_t* const blocksizes,const uint32_t numblocks,const int32_t nbytes) - The index of
+//   the block to try first for an allocation of 'nbytes', or -1 if none of 'blocksizes' are large enough. If the
+//   block can't be used after all, due to alignment padding, the others are tried in order.
+//  uint32_t NumScanned(const uint32_t numblocks,const int32_t blockidx) const - How many blocks the ChooseBlock which
+//   returned 'blockidx' looked at, for tBlockAllocatorCounters. Called before BlockUsed.
+//  void BlockUsed(const int32_t blockidx) - An allocation was made from this block.
+// 'blocksizes' is the space left in each block, padded for the searches in PsyncLib.h.
+
+// The first block with enough space. Fastest, but small objects fill the oldest blocks first so larger objects which
+//  would have fitted there need another block.
+class tFirstFit
+{
+public:
+	int32_t ChooseBlock(
+	 const int32_t* const blocksizes,
+	 const uint32_t numblocks,
+	 const int32_t nbytes) const;
+	uint32_t NumScanned(
+	 const uint32_t numblocks,
+	 const int32_t blockidx) const;
+	void BlockUsed(const int32_t /*blockidx*/) {}
+};
+
+// The block with the least space which is still enough. Keeps the blocks with the most space for larger objects, at the
+//  cost of searching every block.
+class tBestFit
+{
+public:
+	int32_t ChooseBlock(
+	 const int32_t* const blocksizes,
+	 const uint32_t numblocks,
+	 const int32_t nbytes) const;
+	uint32_t NumScanned(
+	 const uint32_t numblocks,
+	 const int32_t blockidx) const;
+	void BlockUsed(const int32_t /*blockidx*/) {}
+};
+
+// The first block with enough space starting from the last block used, wrapping round. Objects allocated together
+//  are kept together and the search usually ends at the first block tried.
+class tNextFit
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	uint32_t m_Cursor;																		// The block last used. May be beyond the
+																									//  blocks in use as they are removed
+	//~V
+public:
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tNextFit(void);
+	int32_t ChooseBlock(
+	 const int32_t* const blocksizes,
+	 const uint32_t numblocks,
+	 const int32_t nbytes) const;
+	uint32_t NumScanned(
+	 const uint32_t numblocks,
+	 const int32_t blockidx) const;
+	void BlockUsed(const int32_t blockidx);
+	//~PF
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+inline int32_t tFirstFit::ChooseBlock(const int32_t* const blocksizes,const uint32_t numblocks,
+ const int32_t nbytes) const
+{
+	return FirstIndexAtLeast(blocksizes,numblocks,0,nbytes);
+}
+
+inline uint32_t tFirstFit::NumScanned(const uint32_t numblocks,const int32_t blockidx) const
+{
+	// Up to the block found
+	return ((blockidx<0)?numblocks:static_cast<uint32_t>(blockidx)+1);
+}
+
+inline int32_t tBestFit::ChooseBlock(const int32_t* const blocksizes,const uint32_t numblocks,
+ const int32_t nbytes) const
+{
+	return SmallestIndexAtLeast(blocksizes,numblocks,nbytes);
+}
+
+inline uint32_t tBestFit::NumScanned(const uint32_t numblocks,const int32_t /*blockidx*/) const
+{
+	// Every block, as a smaller one could follow the one found
+	return numblocks;
+}
+
+inline tNextFit::tNextFit(void):m_Cursor(0)
+{
+}
+
+inline int32_t tNextFit::ChooseBlock(const int32_t* const blocksizes,const uint32_t numblocks,
+ const int32_t nbytes) const
+{
+	const uint32_t cursor=((m_Cursor<numblocks)?m_Cursor:0);
+	int32_t rv=FirstIndexAtLeast(blocksizes,numblocks,cursor,nbytes);
+	if(rv<0 && cursor)
+	{
+		// Wrap round to the blocks before the cursor
+		rv=FirstIndexAtLeast(blocksizes,cursor,0,nbytes);
+	}
+	return rv;
+}
+
+inline uint32_t tNextFit::NumScanned(const uint32_t numblocks,const int32_t blockidx) const
+{
+	if(blockidx<0)
+	{
+		return numblocks;
+	}
+	// From the cursor up to the block found, wrapping round
+	const uint32_t cursor=((m_Cursor<numblocks)?m_Cursor:0);
+	const uint32_t found=static_cast<uint32_t>(blockidx);
+	return ((found>=cursor)?found-cursor:(numblocks-cursor)+found)+1;
+}
+
+inline void tNextFit::BlockUsed(const int32_t blockidx)
+{
+	_ASSERTE(blockidx>=0);
+	m_Cursor=static_cast<uint32_t>(blockidx);
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+// Where the memory for blocks comes from. A block source provides:
+//  static void* Allocate(int32_t& nbytes) - Memory for a block of at least 'nbytes', or NULL. May round 'nbytes' up
+//   to the size actually given, all of which the block can use.
+//  static void Free(void* const memory,const int32_t nbytes) - Give back memory from Allocate with the size it gave.
+
+// The system heap. The default.
+class tMallocBlockSource
+{
+public:
+	static void* Allocate(int32_t& nbytes);
+	static void Free(
+	 void* const memory,
+	 const int32_t nbytes);
+};
+
+// Memory directly from the virtual memory manager, rounded up to the allocation granularity (64kB) so none of it is
+//  wasted. Suited to large blocks.
+// LARGEPAGES - Use large pages (2MB on x64) where possible, which greatly reduces TLB misses when working through a
+//  large block. The process needs SeLockMemoryPrivilege enabled; without it, or where large pages are not supported,
+//  normal pages are used instead. Large pages are always resident.
+// PREFAULT - Touch every page up front so that the page faults happen when the block is created rather than whilst it
+//  is being allocated from.
+template<bool LARGEPAGES,bool PREFAULT>
+class tVirtualAllocBlockSourceT
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	static SIZE_T RoundUp(
+	 const SIZE_T nbytes,
+	 const SIZE_T granularity);															// Round up to a multiple of 'granularity'
+	static void* AllocateLargePages(int32_t& nbytes);								// Returns NULL if large pages can't be
+																									//  used
+	//~F
+public:
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	static void* Allocate(int32_t& nbytes);
+	static void Free(
+	 void* const memory,
+	 const int32_t nbytes);
+	//~PF
+};
+
+typedef tVirtualAllocBlockSourceT<false,false> tVirtualAllocBlockSource;
+typedef tVirtualAllocBlockSourceT<true,false> tLargePageBlockSource;
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+inline void* tMallocBlockSource::Allocate(int32_t& nbytes)
+{
+	return malloc(nbytes);
+}
+
+inline void tMallocBlockSource::Free(void* const memory,const int32_t /*nbytes*/)
+{
+	::free(memory);
+}
+
+template<bool LARGEPAGES,bool PREFAULT>
+SIZE_T tVirtualAllocBlockSourceT<LARGEPAGES,PREFAULT>::RoundUp(const SIZE_T nbytes,const SIZE_T granularity)
+{
+	return ((nbytes+granularity-1)/granularity)*granularity;
+}
+
+template<bool LARGEPAGES,bool PREFAULT>
+void* tVirtualAllocBlockSourceT<LARGEPAGES,PREFAULT>::AllocateLargePages(int32_t& nbytes)
+{
+	// 0 if large pages aren't supported
+	const SIZE_T largepagesize=GetLargePageMinimum();
+	if(!largepagesize)
+	{
+		return NULL;
+	}
+	const SIZE_T size=RoundUp(nbytes,largepagesize);
+	if(size>static_cast<SIZE_T>(numeric_limits<int32_t>::max()))
+	{
+		return NULL;
+	}
+	// Fails if the process doesn't have the lock memory privilege or there isn't enough contiguous physical memory
+	void* const memory=VirtualAlloc(NULL,size,MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES,PAGE_READWRITE);
+	if(memory)
+	{
+		nbytes=static_cast<int32_t>(size);
+	}
+	return memory;
+}
+
+template<bool LARGEPAGES,bool PREFAULT>
+void* tVirtualAllocBlockSourceT<LARGEPAGES,PREFAULT>::Allocate(int32_t& nbytes)
+{
+	_ASSERTE(nbytes>0);
+	if(LARGEPAGES)
+	{
+		// Large pages are resident as soon as they are allocated so there is nothing to prefault
+		void* const memory=AllocateLargePages(nbytes);
+		if(memory)
+		{
+			return memory;
+		}
+	}
+	SYSTEM_INFO systeminfo;
+	GetSystemInfo(&systeminfo);
+	const SIZE_T size=RoundUp(nbytes,systeminfo.dwAllocationGranularity);
+	if(size>static_cast<SIZE_T>(numeric_limits<int32_t>::max()))
+	{
+		return NULL;
+	}
+	char* const memory=static_cast<char*>(VirtualAlloc(NULL,size,MEM_RESERVE|MEM_COMMIT,PAGE_READWRITE));
+	if(memory)
+	{
+		nbytes=static_cast<int32_t>(size);
+		if(PREFAULT)
+		{
+			// The memory is already zero, writing to it makes the pages resident
+			for(SIZE_T offset=0;offset<size;offset+=systeminfo.dwPageSize)
+			{
+				*static_cast<volatile char*>(memory+offset)=0;
+			}
+		}
+	}
+	return memory;
+}
+
+template<bool LARGEPAGES,bool PREFAULT>
+void tVirtualAllocBlockSourceT<LARGEPAGES,PREFAULT>::Free(void* const memory,const int32_t /*nbytes*/)
+{
+	VirtualFree(memory,0,MEM_RELEASE);
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "BlockAllocator.h"
+#include "BlockSource.h"
+#include "IUnitTest.h"
+
+class tBlockSource_UnitTest : public IUnitTest
+{
+	enum eTestNumber
+	{
+		eTestFirst=0,
+		//
+		eVirtualAllocWholeBlock=0,
+		eLargePages,
+		eCacheVirtualAllocBlocks,
+		//
+		TestCount,
+	};
+	template<typename BLOCKSOURCE>
+	static bool UsesWholeBlock(void);													// Is all of a rounded up block used?
+	bool VirtualAllocWholeBlock(void);
+	bool LargePages(void);
+	bool CacheVirtualAllocBlocks(void);
+public:
+	unsigned short GetFirstTest(void) const override
+	{
+		return eTestFirst;
+	}
+	unsigned short GetTestCount(void) const override
+	{
+		return TestCount;
+	}
+	void GetTestName(
+	 const unsigned short testnum,
+	 const unsigned short testnamecount,
+	 WCHAR* const testname) const override;
+	void GetTestDescription(
+	 const unsigned short testnum,
+	 const unsigned short descrcount,
+	 WCHAR* const descr) const override;
+	bool DoTest(const unsigned short testnum) override;
+};
+
+inline void tBlockSource_UnitTest::GetTestName(const unsigned short testnum,const unsigned short testnamecount,
+ WCHAR* const testname) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eVirtualAllocWholeBlock:
+		wcscpy_s(testname,testnamecount,L"VirtualAllocWholeBlock");
+		break;
+	case eLargePages:
+		wcscpy_s(testname,testnamecount,L"LargePages");
+		break;
+	case eCacheVirtualAllocBlocks:
+		wcscpy_s(testname,testnamecount,L"CacheVirtualAllocBlocks");
+		break;
+	}
+}
+
+inline void tBlockSource_UnitTest::GetTestDescription(const unsigned short testnum,const unsigned short descrcount,
+ WCHAR* const descr) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eVirtualAllocWholeBlock:
+		wcscpy_s(descr,descrcount,
+		 L"A block from VirtualAlloc is rounded up to the allocation granularity and all of it is used");
+		break;
+	case eLargePages:
+		wcscpy_s(descr,descrcount,
+		 L"Blocks can be allocated with the large page source whether or not large pages are available");
+		break;
+	case eCacheVirtualAllocBlocks:
+		wcscpy_s(descr,descrcount,L"A block cache returns VirtualAlloc blocks to the next allocator");
+		break;
+	}
+}
+
+template<typename BLOCKSOURCE>
+bool tBlockSource_UnitTest::UsesWholeBlock(void)
+{
+	tBlockAllocatorT<tBlockAllocatorRefCounter,BLOCKSOURCE> allocator(1000);
+	// The block is at least 64kB so every object fits in the first block, one after the other
+	char* previous=allocator.AllocateUnmanaged<char[1000]>();
+	for(int i=0;i<50;++i)
+	{
+		char* const object=allocator.AllocateUnmanaged<char[1000]>();
+		UNITTEST_ASSERT(object==previous+1000);
+		previous=object;
+	}
+	return true;
+}
+
+inline bool tBlockSource_UnitTest::VirtualAllocWholeBlock(void)
+{
+	return UsesWholeBlock<tVirtualAllocBlockSourceT<false,true> >();
+}
+
+inline bool tBlockSource_UnitTest::LargePages(void)
+{
+	// Falls back to normal pages without the lock memory privilege
+	return UsesWholeBlock<tLargePageBlockSource>();
+}
+
+inline bool tBlockSource_UnitTest::CacheVirtualAllocBlocks(void)
+{
+	typedef tBlockAllocatorT<tBlockAllocatorRefCounter,tVirtualAllocBlockSource> _tAllocator;
+	tBlockCacheT<tVirtualAllocBlockSource> cache;
+	void* firstobject;
+	// A block size whose class is already a multiple of 64kB, otherwise the rounded up block is cached in a larger
+	//  class than the allocator asks for
+	{
+		_tAllocator allocator(60000);
+		allocator.SetBlockCache(&cache);
+		firstobject=&(allocator.AllocateUnmanaged<char[100]>());
+	}
+	{
+		_tAllocator allocator(60000);
+		allocator.SetBlockCache(&cache);
+		void* const object=&(allocator.AllocateUnmanaged<char[100]>());
+		UNITTEST_ASSERT(object==firstobject);
+	}
+	return true;
+}
+
+inline bool tBlockSource_UnitTest::DoTest(const unsigned short testnum)
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eVirtualAllocWholeBlock:
+		return VirtualAllocWholeBlock();
+	case eLargePages:
+		return LargePages();
+	case eCacheVirtualAllocBlocks:
+		return CacheVirtualAllocBlocks();
+	}
+}
\ No newline at end of file
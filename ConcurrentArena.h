@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ManagedMemoryBlock.h"
+
+// An arena which any number of threads can allocate from at the same time without a lock. All threads allocate from
+//  the same block until it's full, at which point one of them adds another. Objects live until the arena is
+//  destroyed, which must not happen whilst any thread is still allocating.
+template<typename POLYTYPE>
+class tConcurrentArenaT
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	typedef tManagedMemoryBlockT<POLYTYPE> _tMemoryBlock;
+	_tMemoryBlock* volatile m_CurrentBlock;											// The block being allocated from. Earlier
+																									//  blocks are chained behind it
+	const int32_t m_BlockSize;																// The size of each block
+	//~V
+	tConcurrentArenaT(const tConcurrentArenaT&);
+	tConcurrentArenaT& operator=(const tConcurrentArenaT&);
+	void* _Allocate(
+	 const int32_t size,
+	 const unsigned short alignment,
+	 const bool ismanaged,
+	 POLYTYPE**& managedslot);
+	void AddBlock(_tMemoryBlock* const fullblock);									// Replace the full block with a new one
+	//~F
+public:
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tConcurrentArenaT(const int32_t blocksize);
+	~tConcurrentArenaT(void);
+	template<typename TYPE>
+	TYPE& AllocateUnmanaged(void);														// Allocated but not constructed
+	template<typename TYPE>
+	TYPE& AllocateAndConstructPoly(void);												// Objects must derive from POLYTYPE
+	template<typename TYPE>
+	TYPE& AllocateAndConstructPoly(
+	 typename const TYPE::tCtorArgs& args);											// Objects must derive from POLYTYPE
+	//~PF
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename POLYTYPE>
+tConcurrentArenaT<POLYTYPE>::tConcurrentArenaT(const int32_t blocksize):m_CurrentBlock(NULL),m_BlockSize(blocksize)
+{
+	// A block has to fit more than just it's header
+	_ASSERTE(m_BlockSize>sizeof(_tMemoryBlock));
+	AddBlock(NULL);
+}
+
+template<typename POLYTYPE>
+tConcurrentArenaT<POLYTYPE>::~tConcurrentArenaT(void)
+{
+	_tMemoryBlock* pblock=m_CurrentBlock;
+	while(pblock)
+	{
+		_tMemoryBlock& iterblock=*pblock;
+		pblock=iterblock.PreviousBlock();
+		iterblock.EndConcurrentUse();
+		// Destroys the managed objects in this block only, the chain is walked here
+		iterblock.~_tMemoryBlock();
+		::free(static_cast<void*>(&iterblock));
+	}
+	m_CurrentBlock=NULL;
+}
+
+template<typename POLYTYPE>
+void tConcurrentArenaT<POLYTYPE>::AddBlock(_tMemoryBlock* const fullblock)
+{
+	void* const newmemory=malloc(m_BlockSize);
+	if(!newmemory)
+	{
+		char errormsg[56];
+		sprintf_s(errormsg,"Failed to allocate a block of %ld bytes.",m_BlockSize);
+		throw std::bad_alloc(errormsg);
+	}
+	// The full block is held on to by the new one
+	const bool zeroinitialise=false;
+	_tMemoryBlock* const newblock=::new(newmemory) _tMemoryBlock(fullblock,m_BlockSize,zeroinitialise);
+	newblock->BeginConcurrentUse();
+	if(InterlockedCompareExchangePointer(reinterpret_cast<void* volatile*>(&m_CurrentBlock),newblock,fullblock)!=
+	 fullblock)
+	{
+		// Another thread replaced the full block first. Nothing has been allocated from ours so throw it away.
+		newblock->EndConcurrentUse();
+		newblock->~_tMemoryBlock();
+		::free(newmemory);
+	}
+}
+
+template<typename POLYTYPE>
+void* tConcurrentArenaT<POLYTYPE>::_Allocate(const int32_t size,const unsigned short alignment,const bool ismanaged,
+ POLYTYPE**& managedslot)
+{
+	// An object too big for an empty block would never fit
+	const int32_t maxsizerequired=
+	 static_cast<int32_t>(sizeof(_tMemoryBlock)+size+alignment+((ismanaged)?sizeof(POLYTYPE*):0));
+	if(maxsizerequired>m_BlockSize)
+	{
+		throw std::bad_alloc("Object is too large for the arena's block size.");
+	}
+	for(;;)
+	{
+		_tMemoryBlock* const block=m_CurrentBlock;
+		void* const rv=block->UseConcurrent(size,alignment,ismanaged,managedslot);
+		if(rv)
+		{
+			return rv;
+		}
+		AddBlock(block);
+	}
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+TYPE& tConcurrentArenaT<POLYTYPE>::AllocateUnmanaged(void)
+{
+	POLYTYPE** unused;
+	const bool manage=false;
+	return *static_cast<TYPE*>(_Allocate(sizeof(TYPE),alignment_of<TYPE>::value,manage,unused));
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+TYPE& tConcurrentArenaT<POLYTYPE>::AllocateAndConstructPoly(void)
+{
+	POLYTYPE** managedslot;
+	const bool manage=true;
+	void* const memory=_Allocate(sizeof(TYPE),alignment_of<TYPE>::value,manage,managedslot);
+	TYPE& allocatedobject=*::new(memory) TYPE();
+	_tMemoryBlock::ManageObjectDestructionConcurrent(managedslot,allocatedobject);
+	return allocatedobject;
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+TYPE& tConcurrentArenaT<POLYTYPE>::AllocateAndConstructPoly(typename const TYPE::tCtorArgs& args)
+{
+	POLYTYPE** managedslot;
+	const bool manage=true;
+	void* const memory=_Allocate(sizeof(TYPE),alignment_of<TYPE>::value,manage,managedslot);
+	TYPE& allocatedobject=*::new(memory) TYPE(args);
+	_tMemoryBlock::ManageObjectDestructionConcurrent(managedslot,allocatedobject);
+	return allocatedobject;
+}
\ No newline at end of file
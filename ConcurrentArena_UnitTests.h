@@ -0,0 +1,170 @@
+#pragma once
+
+#include "ConcurrentArena.h"
+#include "IUnitTest.h"
+#include "RefCount.h"
+
+class tConcurrentArena_UnitTest : public IUnitTest
+{
+	enum eTestNumber
+	{
+		eTestFirst=0,
+		//
+		eConcurrentAllocate=0,
+		//
+		TestCount,
+	};
+	typedef tConcurrentArenaT<IPoly> _tArena;
+	struct _tObject : public IPoly
+	{
+		struct tCtorArgs
+		{
+			tRefCount& RefCounter;
+			int32_t Value;
+		};
+		tRefCount& m_RefCounter;
+		int32_t m_Values[5];
+		_tObject(const tCtorArgs& args):m_RefCounter(args.RefCounter)
+		{
+			for(int i=0;i<_countof(m_Values);++i)
+			{
+				m_Values[i]=args.Value;
+			}
+			m_RefCounter.AddRef();
+		}
+		~_tObject(void)
+		{
+			m_RefCounter.Release();
+		}
+	};
+	enum
+	{
+		eNumThreads=4,
+		eNumObjectsPerThread=10000,
+	};
+	struct _tThreadArgs
+	{
+		_tArena* Arena;
+		tRefCount* RefCounter;
+		int32_t ThreadNum;
+		_tObject** Objects;
+	};
+	static DWORD WINAPI AllocateObjects(LPVOID param);
+	bool ConcurrentAllocate(void);
+public:
+	unsigned short GetFirstTest(void) const override
+	{
+		return eTestFirst;
+	}
+	unsigned short GetTestCount(void) const override
+	{
+		return TestCount;
+	}
+	void GetTestName(
+	 const unsigned short testnum,
+	 const unsigned short testnamecount,
+	 WCHAR* const testname) const override;
+	void GetTestDescription(
+	 const unsigned short testnum,
+	 const unsigned short descrcount,
+	 WCHAR* const descr) const override;
+	bool DoTest(const unsigned short testnum) override;
+};
+
+inline void tConcurrentArena_UnitTest::GetTestName(const unsigned short testnum,
+ const unsigned short testnamecount,WCHAR* const testname) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eConcurrentAllocate:
+		wcscpy_s(testname,testnamecount,L"ConcurrentAllocate");
+		break;
+	}
+}
+
+inline void tConcurrentArena_UnitTest::GetTestDescription(const unsigned short testnum,
+ const unsigned short descrcount,WCHAR* const descr) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eConcurrentAllocate:
+		wcscpy_s(descr,descrcount,
+		 L"Allocate managed objects from several threads at once and confirm none of them overlap");
+		break;
+	}
+}
+
+inline DWORD WINAPI tConcurrentArena_UnitTest::AllocateObjects(LPVOID param)
+{
+	_tThreadArgs& args=*static_cast<_tThreadArgs*>(param);
+	const _tObject::tCtorArgs objectargs=
+	{
+		*args.RefCounter,
+		args.ThreadNum,
+	};
+	for(int i=0;i<eNumObjectsPerThread;++i)
+	{
+		args.Objects[i]=&(args.Arena->AllocateAndConstructPoly<_tObject>(objectargs));
+	}
+	return 0;
+}
+
+inline bool tConcurrentArena_UnitTest::ConcurrentAllocate(void)
+{
+	tRefCount refcounter;
+	{
+		// Small blocks so that the threads also race to add blocks
+		_tArena arena(1000);
+		_tThreadArgs args[eNumThreads];
+		HANDLE threads[eNumThreads];
+		for(int i=0;i<eNumThreads;++i)
+		{
+			args[i].Arena=&arena;
+			args[i].RefCounter=&refcounter;
+			args[i].ThreadNum=i;
+			args[i].Objects=new _tObject*[eNumObjectsPerThread];
+			threads[i]=CreateThread(NULL,0,&AllocateObjects,&args[i],0,NULL);
+			UNITTEST_ASSERT(threads[i]);
+		}
+		for(int i=0;i<eNumThreads;++i)
+		{
+			WaitForSingleObject(threads[i],INFINITE);
+			CloseHandle(threads[i]);
+		}
+		UNITTEST_ASSERT(refcounter.Count()==eNumThreads*eNumObjectsPerThread);
+		// If any two objects overlapped then one would have overwritten the values of the other
+		for(int i=0;i<eNumThreads;++i)
+		{
+			for(int objectidx=0;objectidx<eNumObjectsPerThread;++objectidx)
+			{
+				const _tObject& object=*(args[i].Objects[objectidx]);
+				for(int valueidx=0;valueidx<_countof(object.m_Values);++valueidx)
+				{
+					UNITTEST_ASSERT(object.m_Values[valueidx]==i);
+				}
+			}
+			delete[] args[i].Objects;
+		}
+	}
+	// Confirm all objects were destroyed
+	UNITTEST_ASSERT(refcounter.Count()==0);
+	return true;
+}
+
+inline bool tConcurrentArena_UnitTest::DoTest(const unsigned short testnum)
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eConcurrentAllocate:
+		return ConcurrentAllocate();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+// The arguments for constructing a TYPE in place, held by reference until the memory for it is known. Emplace
+//  functions take the arguments themselves and pass them straight to TYPE's constructor, so a type needs no tCtorArgs
+//  struct and nothing is copied on the way. Without variadic templates up to 4 arguments are supported, each passed
+//  on as a const reference; a constructor taking a non-const reference can be given a pointer instead.
+template<typename TYPE,typename A1=void,typename A2=void,typename A3=void,typename A4=void>
+class tEmplaceArgsT
+{
+	const A1& m_A1;
+	const A2& m_A2;
+	const A3& m_A3;
+	const A4& m_A4;
+	//~V
+	tEmplaceArgsT& operator=(const tEmplaceArgsT&);
+	//~F
+public:
+	tEmplaceArgsT(const A1& a1,const A2& a2,const A3& a3,const A4& a4):m_A1(a1),m_A2(a2),m_A3(a3),m_A4(a4) {}
+	TYPE& Construct(void* const memory) const											// Construct a TYPE in 'memory'
+	{
+		return *::new(memory) TYPE(m_A1,m_A2,m_A3,m_A4);
+	}
+};
+
+template<typename TYPE,typename A1,typename A2,typename A3>
+class tEmplaceArgsT<TYPE,A1,A2,A3,void>
+{
+	const A1& m_A1;
+	const A2& m_A2;
+	const A3& m_A3;
+	//~V
+	tEmplaceArgsT& operator=(const tEmplaceArgsT&);
+	//~F
+public:
+	tEmplaceArgsT(const A1& a1,const A2& a2,const A3& a3):m_A1(a1),m_A2(a2),m_A3(a3) {}
+	TYPE& Construct(void* const memory) const
+	{
+		return *::new(memory) TYPE(m_A1,m_A2,m_A3);
+	}
+};
+
+template<typename TYPE,typename A1,typename A2>
+class tEmplaceArgsT<TYPE,A1,A2,void,void>
+{
+	const A1& m_A1;
+	const A2& m_A2;
+	//~V
+	tEmplaceArgsT& operator=(const tEmplaceArgsT&);
+	//~F
+public:
+	tEmplaceArgsT(const A1& a1,const A2& a2):m_A1(a1),m_A2(a2) {}
+	TYPE& Construct(void* const memory) const
+	{
+		return *::new(memory) TYPE(m_A1,m_A2);
+	}
+};
+
+template<typename TYPE,typename A1>
+class tEmplaceArgsT<TYPE,A1,void,void,void>
+{
+	const A1& m_A1;
+	//~V
+	tEmplaceArgsT& operator=(const tEmplaceArgsT&);
+	//~F
+public:
+	explicit tEmplaceArgsT(const A1& a1):m_A1(a1) {}
+	TYPE& Construct(void* const memory) const
+	{
+		return *::new(memory) TYPE(m_A1);
+	}
+};
+
+template<typename TYPE>
+class tEmplaceArgsT<TYPE,void,void,void,void>
+{
+public:
+	TYPE& Construct(void* const memory) const
+	{
+		return *::new(memory) TYPE();
+	}
+};
\ No newline at end of file
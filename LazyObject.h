@@ -1,6 +1,7 @@
 #pragma once
 
 #include <type_traits>
+#include "Emplace.h"
 #include "EmptyClass.h"
 #include "IPoly.h"
 
@@ -22,8 +23,9 @@ class tLazyT : public BASECLASS
 																									//  due to alignment issues.
 	//~V
 	void Invariant();
-	template<typename OTHER>
-	void _Construct(OTHER rhs);
+	template<typename ARGS>
+	void _Emplace(const ARGS& args);														// Construct the object from these
+																									//  tEmplaceArgsT
 	tLazyT(const tLazyT&);
 	tLazyT& operator=(const tLazyT&);
 	//~F
@@ -38,7 +40,29 @@ public:
 	tLazyT(void);
 	~tLazyT(void);
 	void Construct(void);																	// Construct the object
-	void Construct(typename const TYPE::tCtorArgs& args);							// Construct the object
+	template<typename ARGS>
+	void Construct(const ARGS& args);													// Construct the object from it's
+																									//  tCtorArgs
+	void Emplace(void);																		// Construct the object from these
+																									//  arguments, passed straight to it's
+																									//  constructor
+	template<typename A1>
+	void Emplace(const A1& a1);
+	template<typename A1,typename A2>
+	void Emplace(
+	 const A1& a1,
+	 const A2& a2);
+	template<typename A1,typename A2,typename A3>
+	void Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3);
+	template<typename A1,typename A2,typename A3,typename A4>
+	void Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3,
+	 const A4& a4);
 	void operator=(const TYPE& rhs);														// Assign the object
 	void Clear(void);																			// Destruct the object
 	TYPE& operator*(void);																	// Dereference to get at the object
@@ -58,15 +82,50 @@ tLazyT<TYPE,BASECLASS>::~tLazyT(void)
 }
 
 template<typename TYPE,typename BASECLASS>
-void tLazyT<TYPE,BASECLASS>::Construct(typename const TYPE::tCtorArgs& args)
+template<typename ARGS>
+void tLazyT<TYPE,BASECLASS>::Construct(const ARGS& args)
 {
-	_Construct(args);
+	_Emplace(tEmplaceArgsT<TYPE,ARGS>(args));
+}
+
+template<typename TYPE,typename BASECLASS>
+void tLazyT<TYPE,BASECLASS>::Emplace(void)
+{
+	_Emplace(tEmplaceArgsT<TYPE>());
+}
+
+template<typename TYPE,typename BASECLASS>
+template<typename A1>
+void tLazyT<TYPE,BASECLASS>::Emplace(const A1& a1)
+{
+	_Emplace(tEmplaceArgsT<TYPE,A1>(a1));
+}
+
+template<typename TYPE,typename BASECLASS>
+template<typename A1,typename A2>
+void tLazyT<TYPE,BASECLASS>::Emplace(const A1& a1,const A2& a2)
+{
+	_Emplace(tEmplaceArgsT<TYPE,A1,A2>(a1,a2));
+}
+
+template<typename TYPE,typename BASECLASS>
+template<typename A1,typename A2,typename A3>
+void tLazyT<TYPE,BASECLASS>::Emplace(const A1& a1,const A2& a2,const A3& a3)
+{
+	_Emplace(tEmplaceArgsT<TYPE,A1,A2,A3>(a1,a2,a3));
+}
+
+template<typename TYPE,typename BASECLASS>
+template<typename A1,typename A2,typename A3,typename A4>
+void tLazyT<TYPE,BASECLASS>::Emplace(const A1& a1,const A2& a2,const A3& a3,const A4& a4)
+{
+	_Emplace(tEmplaceArgsT<TYPE,A1,A2,A3,A4>(a1,a2,a3,a4));
 }
 
 template<typename TYPE,typename BASECLASS>
 void tLazyT<TYPE,BASECLASS>::operator=(const TYPE& rhs)
 {
-	_Construct(rhs);
+	_Emplace(tEmplaceArgsT<TYPE,TYPE>(rhs));
 }
 
 template<typename TYPE,typename BASECLASS>
@@ -105,20 +164,16 @@ void tLazyT<TYPE,BASECLASS>::Invariant()
 template<typename TYPE,typename BASECLASS>
 void tLazyT<TYPE,BASECLASS>::Construct(void)
 {
-	Invariant();
-	Clear();
-	::new(static_cast<void*>(&m_Memory)) TYPE();
-	m_Constructed=true;
-	Invariant();
+	_Emplace(tEmplaceArgsT<TYPE>());
 }
 
 template<typename TYPE,typename BASECLASS>
-template<typename OTHER>
-void tLazyT<TYPE,BASECLASS>::_Construct(OTHER rhs)
+template<typename ARGS>
+void tLazyT<TYPE,BASECLASS>::_Emplace(const ARGS& args)
 {
 	Invariant();
 	Clear();
-	::new(static_cast<void*>(&m_Memory)) TYPE(rhs);
+	args.Construct(&m_Memory);
 	m_Constructed=true;
 	Invariant();
 }
@@ -1,20 +1,66 @@
 #pragma once
 
 // A block is arranged in memory as follows:
-// [previous block ptr][current ptr][last block byte ptr][count of non-POD ptrs][memory ...............][managed ptr]
-//  [managed ptr]
+// [previous block ptr][current ptr][last block byte ptr][count of managed objects][count of managed slots]
+//  [pending run][retire reason][concurrent state][memory ...............][managed record][managed record]
+//
+// Memory is used from the front of the block and the managed object records from the back. A record is either a single
+//  POLYTYPE* or a run of objects of the same type at a fixed stride: (destructor, first object, stride, count). A run
+//  takes the slots of eRunSlots single records, so objects derived from POLYTYPE are recorded singly until that many
+//  follow one another and are then replaced with a run, which grows from then on without using any more space. Other
+//  objects have no POLYTYPE* so each starts a run, as does an array however long it is. Destroying a run is a loop over
+//  the objects calling their destructor directly rather than through a vtable, so objects which don't derive from
+//  POLYTYPE need no vtable at all. Normally a block has a single writer. Between BeginConcurrentUse and
+//  EndConcurrentUse any number of threads may allocate from it with UseConcurrent. Both ends of the block are then
+//  held in one 64 bit value so that a single compare and swap moves both; updating them separately would let two
+//  threads take the same free bytes from opposite ends.
 
 template<typename POLYTYPE>
 class tManagedMemoryBlockT
 {
 //=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	typedef void (*_tDestroyRun)(
+	 char* const first,
+	 const intptr_t stride,
+	 const int32_t begin,
+	 const int32_t end);																		// Destroy objects 'begin' to 'end'-1 of a
+																									//  run, newest first
+	struct _tRun
+	{
+		uintptr_t Count;																		// The number of objects shifted left 1
+																									//  with eRunTag set. A POLYTYPE* is at
+																									//  least 2 byte aligned so a single record
+																									//  never has the bit set
+		_tDestroyRun Destroy;																// Identifies the type
+		char* First;																			// The oldest object
+		intptr_t Stride;																		// The distance between objects
+	};
+	enum
+	{
+		eRunTag=1,
+		eRunSlots=sizeof(_tRun)/sizeof(POLYTYPE*),									// Slots taken by a run. Also the number of
+																									//  single records which become a run
+	};
+//=====================================================================================================================
 // PROPERTIES
 //=====================================================================================================================
 public:
 	enum
 	{
-		eOverheadForManagedObject=sizeof(POLYTYPE*),									// The overhead required for managing an
-																									//  object lifespan
+		eOverheadForManagedObject=sizeof(_tRun),										// The most space the record for a managed
+																									//  object can take, a run of one
+	};
+	template<typename TYPE>
+	static int32_t RecordSize(const int32_t count);									// The most space the record for 'count'
+																									//  TYPEs can take. None if the destructor
+																									//  is trivial, a slot for one object
+																									//  derived from POLYTYPE, otherwise a run
+	struct tMark
+	{
+		const char* Ptr;																		// Where the next allocation would be made
+		int32_t NumManagedObjects;															// The number of managed objects at the time
 	};
 	int32_t NumManagedObjects(void) const;												// The number of objects allocated where
 																									//  destruction is managed by the the memory
@@ -23,6 +69,15 @@ public:
 																									//  block that can be used for allocation
 	int32_t NumBytesUsed(void) const;													// The number of bytes used including the
 																									//  managed objects
+	int32_t Size(void) const;																// The size of the block including this
+																									//  header
+	tMark Mark(void) const;																	// The position to pass to Rewind
+	const char* NextBytePtr(void) const;												// Where the next allocation would be made,
+																									//  before alignment padding
+	unsigned char RetireReason(void) const;											// Why the owner stopped allocating from
+																									//  this block, as set by SetRetireReason
+	int32_t UseOrder(void) const;															// When the owner started allocating from
+																									//  this block, as set by SetUseOrder
 //=====================================================================================================================
 // FUNCTIONS/MODIFIERS
 //=====================================================================================================================
@@ -39,21 +94,72 @@ public:
 	bool EnoughSpace(
 	 const int32_t size,
 	 const unsigned short alignmentpadrequired,
-	 const bool ismanaged) const;															// Is there enough space for an object of
-																									//  this size/alignment?
-	void ManageObjectDestruction(POLYTYPE& managedobject);						// Manage the destruction of this object
+	 const int32_t recordsize) const;													// Is there enough space for an object of
+																									//  this size/alignment and a managed record
+																									//  of 'recordsize' bytes?
+	template<typename TYPE>
+	void ManageObjectDestruction(TYPE& managedobject);								// Manage the destruction of this object.
+																									//  It's type must be exactly TYPE, not a
+																									//  class derived from it. TYPE need not
+																									//  derive from POLYTYPE
+	template<typename TYPE>
+	void ManageArrayDestruction(
+	 TYPE* const first,
+	 const int32_t count);																	// Manage the destruction of this array
+																									//  with a single run record
 	unsigned short AlignmentPadRequired(const unsigned short alignment)
 	 const;																						// Padding required to allocate an object
 																									//  with this alignment
 	void* Use(
 	 const int32_t size,
 	 const unsigned short alignment,
-	 const bool ismanaged);																	// Use this amount of memory with this
-																									//  alignment requirement. Returns
-																									//  a pointer to the memory
+	 const int32_t recordsize);															// Use this amount of memory with this
+																									//  alignment requirement, leaving space for
+																									//  a managed record of 'recordsize' bytes.
+																									//  Returns a pointer to the memory
+	bool Unuse(
+	 void* const memory,
+	 const int32_t size);																	// Give back unmanaged memory from Use if
+																									//  nothing has been used after it. Returns
+																									//  false, and does nothing, otherwise
 	void ChainAttachBlock(tManagedMemoryBlockT& block) throw();					// Add this block to the end of the previous
 																									//  block chain
 	tManagedMemoryBlockT* PreviousBlock(void);										// Return the previous block (if any)
+	const tManagedMemoryBlockT* PreviousBlock(void) const;
+	void SetPreviousBlock(
+	 tManagedMemoryBlockT* const previousblock) throw();							// Replace the previous block chain. The
+																									//  existing chain is not freed
+	tManagedMemoryBlockT& LastChainedBlock(void) throw();							// The end of the previous block chain, or
+																									//  this block if there is no chain
+	void BeginConcurrentUse(void);														// Allow UseConcurrent from any thread. Use
+																									//  and ManageObjectDestruction must not be
+																									//  called until EndConcurrentUse
+	void* UseConcurrent(
+	 const int32_t size,
+	 const unsigned short alignment,
+	 const bool ismanaged,
+	 POLYTYPE**& managedslot);																// Thread safe Use. If 'ismanaged' a slot is
+																									//  reserved to be passed to
+																									//  ManageObjectDestructionConcurrent once
+																									//  the object is constructed. Returns NULL
+																									//  if there isn't enough space
+	static void ManageObjectDestructionConcurrent(
+	 POLYTYPE** const managedslot,
+	 POLYTYPE& managedobject);																// Manage the destruction of this object
+	void EndConcurrentUse(void);															// All threads have finished with
+																									//  UseConcurrent
+	void DestroyManagedObjects(void);													// Destroy the managed objects, newest
+																									//  first. Memory used by the objects is not
+																									//  reclaimed
+	void Rewind(const tMark& mark);														// Destroy the managed objects created since
+																									//  'mark', newest first, and reclaim the
+																									//  memory used since
+	void Reset(void);																			// Rewind to empty
+	void SetRetireReason(const unsigned char reason);								// Recorded by the owner for diagnostics.
+																									//  0 until set
+	void SetUseOrder(const int32_t order);												// Recorded by the owner, higher for each
+																									//  block it starts allocating from. 0 until
+																									//  set
 private:
 //=====================================================================================================================
 // PRIVATE
@@ -62,7 +168,50 @@ private:
 	char* m_Ptr;																				
 	char* const m_EndBytePtr;																
 	int32_t m_NumManagedObjects;
+	int32_t m_NumManagedSlots;																// Slots used by the managed records
+	_tDestroyRun m_PendingRunDestroy;													// The newest 'm_PendingRunLength' records
+	int32_t m_PendingRunLength;															//  are single records of this type at
+	intptr_t m_PendingRunStride;															//  this stride which could become a run
+	unsigned char m_RetireReason;
+	int32_t m_UseOrder;
+	volatile LONGLONG m_ConcurrentState;												// Bytes used from the beginning in the
+																									//  low 32 bits, and the number of managed
+																									//  slots in the high 32 bits. Only in use
+																									//  between Begin/EndConcurrentUse
 	//~V
+	enum
+	{
+		eNotConcurrent=-1,																	// m_ConcurrentState when not in use
+	};
+	static unsigned short AlignmentPadRequired(
+	 const char* const ptr,
+	 const unsigned short alignment);													// Padding required to align 'ptr'
+	bool IsConcurrent(void) const;
+	template<typename TYPE>
+	static void DestroyRun(
+	 char* const first,
+	 const intptr_t stride,
+	 const int32_t begin,
+	 const int32_t end);
+	_tRun* NewestRun(void);																	// The newest record if it's a run, otherwise
+																									//  NULL
+	static bool IsNextInRun(
+	 const _tRun& run,
+	 const char* const object);															// Does 'object' follow on from the run? A
+																									//  run of one takes it's stride from the
+																									//  next object
+	template<typename TYPE>
+	void AddRecord(
+	 TYPE& managedobject,
+	 const true_type& ispolytype);														// Record it singly, replacing the newest
+																									//  singles with a run once there are enough
+	template<typename TYPE>
+	void AddRecord(
+	 TYPE& managedobject,
+	 const false_type& ispolytype);														// Start a run
+	void DestroyNewestManagedObjects(
+	 const int32_t numtokeep);																// Destroy all but the oldest 'numtokeep'
+																									//  managed objects
 	char* BeginBytePtr(void);																// The beginning of the memory
 	const char* BeginBytePtr(void) const;
 	char* EndAllocateableBytePtr(void);													// The last byte in the block of memory + 1
@@ -73,7 +222,7 @@ private:
 	const char* EndAllocateableBytePtr(void) const;
 	const POLYTYPE** PFirstManagedObject(void) const;								// Pointer to the first managed object
 	POLYTYPE** PFirstManagedObject(void);
-	void DestroyManagedObjects(void);
+	POLYTYPE** PNewestRecord(void);														// Pointer to the newest managed record
 	//~F
 };
 
@@ -86,7 +235,9 @@ tManagedMemoryBlockT<POLYTYPE>::tManagedMemoryBlockT(tManagedMemoryBlockT* const
  const bool zeroinitialise) throw():m_PreviousBlock(previousblock),m_Ptr(BeginBytePtr()),
 //warning C4355: 'this' : used in base member initializer list
 #pragma warning(suppress:4355)
- m_EndBytePtr(reinterpret_cast<char*>(this)+blocksize),m_NumManagedObjects(0)
+ m_EndBytePtr(reinterpret_cast<char*>(this)+blocksize),m_NumManagedObjects(0),m_NumManagedSlots(0),
+ m_PendingRunDestroy(NULL),m_PendingRunLength(0),m_PendingRunStride(0),m_RetireReason(0),
+ m_UseOrder(0),m_ConcurrentState(eNotConcurrent)
 {
 	_ASSERTE(blocksize>0);
 	if(zeroinitialise)
@@ -109,17 +260,26 @@ template<typename POLYTYPE>
 void tManagedMemoryBlockT<POLYTYPE>::ChainAttachBlock(tManagedMemoryBlockT& block) throw()
 {
 	Invariant();
-	for(tManagedMemoryBlockT* iterblock=this;;/* Increment done inside the loop */)
+	// Found the end - attach this one.
+	LastChainedBlock().m_PreviousBlock=&block;
+	Invariant();
+}
+
+template<typename POLYTYPE>
+tManagedMemoryBlockT<POLYTYPE>& tManagedMemoryBlockT<POLYTYPE>::LastChainedBlock(void) throw()
+{
+	tManagedMemoryBlockT* iterblock=this;
+	while(iterblock->m_PreviousBlock)
 	{
-		if(!iterblock->m_PreviousBlock)
-		{
-			// Found the end - attach this one.
-			iterblock->m_PreviousBlock=&block;
-			break;
-		}
 		iterblock=iterblock->m_PreviousBlock;
 	}
-	Invariant();
+	return *iterblock;
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::SetPreviousBlock(tManagedMemoryBlockT* const previousblock) throw()
+{
+	m_PreviousBlock=previousblock;
 }
 
 template<typename POLYTYPE>
@@ -143,6 +303,24 @@ POLYTYPE** tManagedMemoryBlockT<POLYTYPE>::PFirstManagedObject(void)
 	return const_cast<POLYTYPE**>(static_cast<const tManagedMemoryBlockT&>(*this).PFirstManagedObject());
 }
 
+template<typename POLYTYPE>
+POLYTYPE** tManagedMemoryBlockT<POLYTYPE>::PNewestRecord(void)
+{
+	// Records grow towards the allocated memory
+	return PFirstManagedObject()-(m_NumManagedSlots-1);
+}
+
+template<typename POLYTYPE>
+typename tManagedMemoryBlockT<POLYTYPE>::_tRun* tManagedMemoryBlockT<POLYTYPE>::NewestRun(void)
+{
+	if(!m_NumManagedSlots)
+	{
+		return NULL;
+	}
+	POLYTYPE** const pnewest=PNewestRecord();
+	return ((reinterpret_cast<uintptr_t>(*pnewest)&eRunTag)?reinterpret_cast<_tRun*>(pnewest):NULL);
+}
+
 template<typename POLYTYPE>
 const char* tManagedMemoryBlockT<POLYTYPE>::BeginBytePtr(void) const
 {
@@ -165,7 +343,7 @@ char* tManagedMemoryBlockT<POLYTYPE>::EndAllocateableBytePtr(void)
 template<typename POLYTYPE>
 const char* tManagedMemoryBlockT<POLYTYPE>::EndAllocateableBytePtr(void) const
 {
-	char* rv=m_EndBytePtr-(NumManagedObjects()*sizeof(POLYTYPE*));
+	char* rv=m_EndBytePtr-(m_NumManagedSlots*sizeof(POLYTYPE*));
 	// Sanity check
 	_ASSERTE(rv>=m_Ptr && rv<=m_EndBytePtr);
 	return rv;
@@ -183,45 +361,305 @@ int32_t tManagedMemoryBlockT<POLYTYPE>::NumBytesLeft(void) const
 template<typename POLYTYPE>
 int32_t tManagedMemoryBlockT<POLYTYPE>::NumBytesUsed(void) const
 {
-	const int32_t rv=static_cast<int32_t>((m_Ptr-BeginBytePtr())+(m_NumManagedObjects*sizeof(POLYTYPE*)));
+	const int32_t rv=static_cast<int32_t>((m_Ptr-BeginBytePtr())+(m_NumManagedSlots*sizeof(POLYTYPE*)));
 	// Never should the number of bytes used be less than 0
 	_ASSERTE(rv>=0);
 	return rv;
 }
 
 template<typename POLYTYPE>
-void tManagedMemoryBlockT<POLYTYPE>::ManageObjectDestruction(POLYTYPE& managedobject)
+int32_t tManagedMemoryBlockT<POLYTYPE>::Size(void) const
+{
+	return static_cast<int32_t>(m_EndBytePtr-reinterpret_cast<const char*>(this));
+}
+
+template<typename POLYTYPE>
+typename tManagedMemoryBlockT<POLYTYPE>::tMark tManagedMemoryBlockT<POLYTYPE>::Mark(void) const
+{
+	_ASSERTE(!IsConcurrent());
+	const tMark rv=
+	{
+		m_Ptr,
+		m_NumManagedObjects,
+	};
+	return rv;
+}
+
+template<typename POLYTYPE>
+const char* tManagedMemoryBlockT<POLYTYPE>::NextBytePtr(void) const
+{
+	_ASSERTE(!IsConcurrent());
+	return m_Ptr;
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+int32_t tManagedMemoryBlockT<POLYTYPE>::RecordSize(const int32_t count)
+{
+	if(has_trivial_destructor<TYPE>::value)
+	{
+		return 0;
+	}
+	// A single record replaced by a run takes no more space, as the run reuses the slots of the singles before it.
+	//  Whether any other object carries on from the newest run isn't known until it's been placed.
+	return ((count==1 && is_base_of<POLYTYPE,TYPE>::value)?static_cast<int32_t>(sizeof(POLYTYPE*)):
+	 eOverheadForManagedObject);
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+void tManagedMemoryBlockT<POLYTYPE>::ManageObjectDestruction(TYPE& managedobject)
 {
 	Invariant();
-	// Get the next managed object to use
-	POLYTYPE*& pnewmanaged=*(PFirstManagedObject()-m_NumManagedObjects);
-	pnewmanaged=&managedobject;
+	_ASSERTE(!IsConcurrent());
+	char* const object=reinterpret_cast<char*>(&managedobject);
+	_tRun* const newestrun=NewestRun();
+	if(newestrun && newestrun->Destroy==&DestroyRun<TYPE> && IsNextInRun(*newestrun,object))
+	{
+		// The next object in the run, no more space is used
+		if((newestrun->Count>>1)==1)
+		{
+			newestrun->Stride=object-newestrun->First;
+		}
+		newestrun->Count+=(1<<1);
+	}
+	else
+	{
+		AddRecord(managedobject,is_base_of<POLYTYPE,TYPE>());
+	}
 	++m_NumManagedObjects;
 	Invariant();
 }
 
+template<typename POLYTYPE>
+template<typename TYPE>
+void tManagedMemoryBlockT<POLYTYPE>::ManageArrayDestruction(TYPE* const first,const int32_t count)
+{
+	_ASSERTE(count>0);
+	if(count==1)
+	{
+		ManageObjectDestruction(*first);
+		return;
+	}
+	Invariant();
+	_ASSERTE(!IsConcurrent());
+	char* const object=reinterpret_cast<char*>(first);
+	const intptr_t stride=sizeof(TYPE);
+	_tRun* const newestrun=NewestRun();
+	if(newestrun && newestrun->Destroy==&DestroyRun<TYPE> && IsNextInRun(*newestrun,object) &&
+	 (((newestrun->Count>>1)==1)?object-newestrun->First:newestrun->Stride)==stride)
+	{
+		// Carries on from the newest run, no more space is used
+		newestrun->Stride=stride;
+		newestrun->Count+=(static_cast<uintptr_t>(count)<<1);
+	}
+	else
+	{
+		// The space for a run was reserved by Use
+		m_NumManagedSlots+=eRunSlots;
+		_tRun& run=*reinterpret_cast<_tRun*>(PNewestRecord());
+		run.Count=(static_cast<uintptr_t>(count)<<1)|eRunTag;
+		run.Destroy=&DestroyRun<TYPE>;
+		run.First=object;
+		run.Stride=stride;
+		// The pending singles are no longer the newest records
+		m_PendingRunLength=0;
+	}
+	m_NumManagedObjects+=count;
+	Invariant();
+}
+
+template<typename POLYTYPE>
+bool tManagedMemoryBlockT<POLYTYPE>::IsNextInRun(const _tRun& run,const char* const object)
+{
+	const intptr_t count=static_cast<intptr_t>(run.Count>>1);
+	return ((count==1)?object>run.First:run.First+(run.Stride*count)==object);
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+void tManagedMemoryBlockT<POLYTYPE>::AddRecord(TYPE& managedobject,const true_type& /*ispolytype*/)
+{
+	const _tDestroyRun destroy=&DestroyRun<TYPE>;
+	// Get the next slot to use
+	POLYTYPE** const pnewmanaged=PFirstManagedObject()-m_NumManagedSlots;
+	*pnewmanaged=&managedobject;
+	++m_NumManagedSlots;
+	if(m_PendingRunLength && m_PendingRunDestroy==destroy)
+	{
+		// The previous record is also a TYPE
+		const char* const previous=reinterpret_cast<const char*>(static_cast<TYPE*>(*(pnewmanaged+1)));
+		const intptr_t stride=reinterpret_cast<char*>(&managedobject)-previous;
+		if(stride>0 && (m_PendingRunLength==1 || stride==m_PendingRunStride))
+		{
+			m_PendingRunStride=stride;
+			++m_PendingRunLength;
+		}
+		else
+		{
+			m_PendingRunLength=1;
+		}
+	}
+	else
+	{
+		m_PendingRunDestroy=destroy;
+		m_PendingRunLength=1;
+	}
+	if(m_PendingRunLength==eRunSlots)
+	{
+		// Replace the single records with a run in the same slots
+		char* const first=reinterpret_cast<char*>(static_cast<TYPE*>(pnewmanaged[eRunSlots-1]));
+		_tRun& run=*reinterpret_cast<_tRun*>(pnewmanaged);
+		run.Count=(static_cast<uintptr_t>(eRunSlots)<<1)|eRunTag;
+		run.Destroy=destroy;
+		run.First=first;
+		run.Stride=m_PendingRunStride;
+		m_PendingRunLength=0;
+	}
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+void tManagedMemoryBlockT<POLYTYPE>::AddRecord(TYPE& managedobject,const false_type& /*ispolytype*/)
+{
+	// There is no POLYTYPE* to record singly. The space for a run was reserved by Use.
+	m_NumManagedSlots+=eRunSlots;
+	_tRun& run=*reinterpret_cast<_tRun*>(PNewestRecord());
+	run.Count=(1<<1)|eRunTag;
+	run.Destroy=&DestroyRun<TYPE>;
+	run.First=reinterpret_cast<char*>(&managedobject);
+	run.Stride=0;
+	// The pending singles are no longer the newest records
+	m_PendingRunLength=0;
+}
+
+template<typename POLYTYPE>
+template<typename TYPE>
+void tManagedMemoryBlockT<POLYTYPE>::DestroyRun(char* const first,const intptr_t stride,const int32_t begin,
+ const int32_t end)
+{
+	// The type is known so the destructor is called directly and can be inlined
+	for(int32_t i=end-1;i>=begin;--i)
+	{
+		reinterpret_cast<TYPE*>(first+(i*stride))->TYPE::~TYPE();
+	}
+}
+
 template<typename POLYTYPE>
 unsigned short tManagedMemoryBlockT<POLYTYPE>::AlignmentPadRequired(const unsigned short alignment) const
 {
-	return static_cast<unsigned short>(reinterpret_cast<uintptr_t>(m_Ptr)%alignment);
+	return AlignmentPadRequired(m_Ptr,alignment);
+}
+
+template<typename POLYTYPE>
+unsigned short tManagedMemoryBlockT<POLYTYPE>::AlignmentPadRequired(const char* const ptr,
+ const unsigned short alignment)
+{
+	_ASSERTE(alignment>0);
+	// The distance to the next 'alignment' boundary, not the distance from the previous one
+	const unsigned short misalignment=static_cast<unsigned short>(reinterpret_cast<uintptr_t>(ptr)%alignment);
+	return ((misalignment)?alignment-misalignment:0);
 }
 
 template<typename POLYTYPE>
 void tManagedMemoryBlockT<POLYTYPE>::DestroyManagedObjects(void)
 {
+	DestroyNewestManagedObjects(0);
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::DestroyNewestManagedObjects(const int32_t numtokeep)
+{
+	Invariant();
+	_ASSERTE(!IsConcurrent());
+	_ASSERTE(numtokeep>=0 && numtokeep<=m_NumManagedObjects);
+	// The newest object is the one nearest the allocated memory. Objects may reference those created before them so
+	//  destroy in the reverse order to which they were created.
+	POLYTYPE** precord=PNewestRecord();
+	while(m_NumManagedObjects>numtokeep)
+	{
+		if(reinterpret_cast<uintptr_t>(*precord)&eRunTag)
+		{
+			// A rewind may only take the newest objects of a run
+			_tRun& run=*reinterpret_cast<_tRun*>(precord);
+			const int32_t count=static_cast<int32_t>(run.Count>>1);
+			const int32_t numtodestroy=
+			 ((m_NumManagedObjects-numtokeep<count)?m_NumManagedObjects-numtokeep:count);
+			run.Destroy(run.First,run.Stride,count-numtodestroy,count);
+			m_NumManagedObjects-=numtodestroy;
+			if(numtodestroy<count)
+			{
+				run.Count=(static_cast<uintptr_t>(count-numtodestroy)<<1)|eRunTag;
+			}
+			else
+			{
+				precord+=eRunSlots;
+				m_NumManagedSlots-=eRunSlots;
+			}
+		}
+		else
+		{
+			// Call the virtual destructor. The pointer is NULL where the object failed to construct after it's slot
+			//  was reserved by UseConcurrent
+			if(*precord)
+			{
+				(*precord)->~POLYTYPE();
+			}
+			// Work forwards to the older records
+			++precord;
+			--m_NumManagedSlots;
+			--m_NumManagedObjects;
+		}
+	}
+	m_PendingRunLength=0;
 	Invariant();
-	POLYTYPE** pmanagedobject=PFirstManagedObject();
-	for(int32_t i=0;i<m_NumManagedObjects;++i)
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::Rewind(const tMark& mark)
+{
+	// The mark must be from this block. Memory given back by Unuse may have taken the pointer back past it.
+	_ASSERTE(mark.Ptr>=BeginBytePtr() && mark.Ptr<=EndAllocateableBytePtr());
+	DestroyNewestManagedObjects(mark.NumManagedObjects);
+	if(mark.Ptr<m_Ptr)
 	{
-		// Call the virtual destructor
-		(*pmanagedobject)->~POLYTYPE();
-		// Work backwards
-		--pmanagedobject;
+		m_Ptr=const_cast<char*>(mark.Ptr);
 	}
-	m_NumManagedObjects=0;
 	Invariant();
 }
 
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::Reset(void)
+{
+	DestroyNewestManagedObjects(0);
+	m_Ptr=BeginBytePtr();
+	Invariant();
+}
+
+template<typename POLYTYPE>
+unsigned char tManagedMemoryBlockT<POLYTYPE>::RetireReason(void) const
+{
+	return m_RetireReason;
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::SetRetireReason(const unsigned char reason)
+{
+	m_RetireReason=reason;
+}
+
+template<typename POLYTYPE>
+int32_t tManagedMemoryBlockT<POLYTYPE>::UseOrder(void) const
+{
+	return m_UseOrder;
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::SetUseOrder(const int32_t order)
+{
+	m_UseOrder=order;
+}
+
 template<typename POLYTYPE>
 void tManagedMemoryBlockT<POLYTYPE>::Invariant(void) const
 {
@@ -249,6 +687,10 @@ void tManagedMemoryBlockT<POLYTYPE>::Invariant(void) const
 	_ASSERTE(BeginBytePtr()==reinterpret_cast<const char*>(this)+sizeof(*this));
 	// ==== m_NumManagedObjects =======================================================================================
 	_ASSERTE(m_NumManagedObjects<=NumBytesUsed()); // Can't have more managed objects than bytes used
+	// ==== m_NumManagedSlots =========================================================================================
+	_ASSERTE(m_NumManagedSlots>=0);
+	_ASSERTE(!m_NumManagedSlots==!m_NumManagedObjects); // An empty run is removed
+	_ASSERTE(m_PendingRunLength>=0 && m_PendingRunLength<eRunSlots && m_PendingRunLength<=m_NumManagedSlots);
 	// ==== PFirstManagedObject =======================================================================================
 	const char* const pfirstmanagedobject=reinterpret_cast<const char*>(PFirstManagedObject());
 	_ASSERTE(pfirstmanagedobject>reinterpret_cast<const char*>(this));
@@ -262,22 +704,25 @@ void tManagedMemoryBlockT<POLYTYPE>::Invariant(void) const
 
 template<typename POLYTYPE>
 bool tManagedMemoryBlockT<POLYTYPE>::EnoughSpace(const int32_t size,const unsigned short alignmentpadrequired,
- const bool ismanaged) const
+ const int32_t recordsize) const
 {
 	// Why would you allocate <=0 bytes?
 	_ASSERTE(size>0);
+	_ASSERTE(recordsize>=0 && recordsize<=eOverheadForManagedObject);
 	const int32_t nbytesleft=NumBytesLeft();
-	const int32_t sizeneeded=static_cast<int32_t>(alignmentpadrequired+size+((ismanaged)?sizeof(POLYTYPE*):0));
+	const int32_t sizeneeded=alignmentpadrequired+size+recordsize;
 	return (sizeneeded<=nbytesleft);
 }
 
 template<typename POLYTYPE>
-void* tManagedMemoryBlockT<POLYTYPE>::Use(const int32_t size,const unsigned short alignment,const bool ismanaged)
+void* tManagedMemoryBlockT<POLYTYPE>::Use(const int32_t size,const unsigned short alignment,
+ const int32_t recordsize)
 {
 	Invariant();
+	_ASSERTE(!IsConcurrent());
 	void* rv;
 	const unsigned short pad=AlignmentPadRequired(alignment);
-	if(EnoughSpace(size,pad,ismanaged))
+	if(EnoughSpace(size,pad,recordsize))
 	{
 		if(pad>0)
 		{
@@ -298,8 +743,108 @@ void* tManagedMemoryBlockT<POLYTYPE>::Use(const int32_t size,const unsigned shor
 	return rv;
 }
 
+template<typename POLYTYPE>
+bool tManagedMemoryBlockT<POLYTYPE>::Unuse(void* const memory,const int32_t size)
+{
+	Invariant();
+	_ASSERTE(!IsConcurrent());
+	_ASSERTE(size>0);
+	char* const ptr=static_cast<char*>(memory);
+	if(ptr+size!=m_Ptr)
+	{
+		return false;
+	}
+	// Any padding before it stays used
+	_ASSERTE(ptr>=BeginBytePtr());
+	m_Ptr=ptr;
+	Invariant();
+	return true;
+}
+
 template<typename POLYTYPE>
 tManagedMemoryBlockT<POLYTYPE>* tManagedMemoryBlockT<POLYTYPE>::PreviousBlock(void)
 {
 	return m_PreviousBlock;
+}
+
+template<typename POLYTYPE>
+const tManagedMemoryBlockT<POLYTYPE>* tManagedMemoryBlockT<POLYTYPE>::PreviousBlock(void) const
+{
+	return m_PreviousBlock;
+}
+
+template<typename POLYTYPE>
+bool tManagedMemoryBlockT<POLYTYPE>::IsConcurrent(void) const
+{
+	return (m_ConcurrentState!=eNotConcurrent);
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::BeginConcurrentUse(void)
+{
+	Invariant();
+	_ASSERTE(!IsConcurrent());
+	const LONGLONG numbytesused=m_Ptr-BeginBytePtr();
+	m_ConcurrentState=numbytesused|(static_cast<LONGLONG>(m_NumManagedSlots)<<32);
+	_ASSERTE(IsConcurrent());
+}
+
+template<typename POLYTYPE>
+void* tManagedMemoryBlockT<POLYTYPE>::UseConcurrent(const int32_t size,const unsigned short alignment,
+ const bool ismanaged,POLYTYPE**& managedslot)
+{
+	// Why would you allocate <=0 bytes?
+	_ASSERTE(size>0);
+	_ASSERTE(IsConcurrent());
+	char* const beginbyteptr=BeginBytePtr();
+	for(;;)
+	{
+		// A 64 bit read is not atomic on 32 bit platforms
+		const LONGLONG state=InterlockedCompareExchange64(&m_ConcurrentState,0,0);
+		char* const ptr=beginbyteptr+static_cast<int32_t>(state&0xFFFFFFFF);
+		const int32_t nummanagedslots=static_cast<int32_t>(state>>32);
+		const int32_t newnummanagedslots=nummanagedslots+((ismanaged)?1:0);
+		char* const rv=ptr+AlignmentPadRequired(ptr,alignment);
+		char* const newptr=rv+size;
+		// Take in to account the slot we are reserving as well as those reserved by other threads
+		if(newptr>m_EndBytePtr-(newnummanagedslots*sizeof(POLYTYPE*)))
+		{
+			return NULL;
+		}
+		const LONGLONG newstate=(newptr-beginbyteptr)|(static_cast<LONGLONG>(newnummanagedslots)<<32);
+		if(InterlockedCompareExchange64(&m_ConcurrentState,newstate,state)==state)
+		{
+			if(ismanaged)
+			{
+				// Nothing is managed until the object has been constructed
+				managedslot=PFirstManagedObject()-nummanagedslots;
+				*managedslot=NULL;
+			}
+			return rv;
+		}
+		// Another thread got there first, try again with the new state
+	}
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::ManageObjectDestructionConcurrent(POLYTYPE** const managedslot,
+ POLYTYPE& managedobject)
+{
+	_ASSERTE(managedslot && !*managedslot);
+	*managedslot=&managedobject;
+}
+
+template<typename POLYTYPE>
+void tManagedMemoryBlockT<POLYTYPE>::EndConcurrentUse(void)
+{
+	_ASSERTE(IsConcurrent());
+	const LONGLONG state=m_ConcurrentState;
+	m_Ptr=BeginBytePtr()+static_cast<int32_t>(state&0xFFFFFFFF);
+	// Every slot taken concurrently is a single record
+	const int32_t nummanagedslots=static_cast<int32_t>(state>>32);
+	m_NumManagedObjects+=nummanagedslots-m_NumManagedSlots;
+	m_NumManagedSlots=nummanagedslots;
+	m_PendingRunLength=0;
+	m_ConcurrentState=eNotConcurrent;
+	Invariant();
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+// Somewhere to allocate raw memory from, chosen at run time. Code taking an IMemoryResource can be given any
+//  allocator without being a template on it's type, at the cost of a virtual call per allocation. Use tStlAllocatorT
+//  with the allocator type itself where that matters.
+struct IMemoryResource
+{
+	virtual void* AllocateUnmanaged(
+	 const int32_t nbytes,
+	 const unsigned short alignment)=0;													// Memory for 'nbytes' with this
+																									//  alignment, a power of 2. Throws
+																									//  std::bad_alloc on failure
+	virtual void DeallocateUnmanaged(
+	 void* const memory,
+	 const int32_t nbytes)=0;																// Give back memory from AllocateUnmanaged.
+																									//  It need not be reused straight away
+};
+
+// An IMemoryResource allocating from a tBlockAllocatorT, or anything else with the same AllocateUnmanaged and
+//  DeallocateUnmanaged. The allocator must outlive it.
+template<typename ALLOCATOR>
+class tMemoryResourceT : public IMemoryResource
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	ALLOCATOR& m_Allocator;
+	//~V
+	tMemoryResourceT& operator=(const tMemoryResourceT&);
+	//~F
+public:
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	explicit tMemoryResourceT(ALLOCATOR& allocator);
+	void* AllocateUnmanaged(
+	 const int32_t nbytes,
+	 const unsigned short alignment) override;
+	void DeallocateUnmanaged(
+	 void* const memory,
+	 const int32_t nbytes) override;
+	//~PF
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename ALLOCATOR>
+tMemoryResourceT<ALLOCATOR>::tMemoryResourceT(ALLOCATOR& allocator):m_Allocator(allocator)
+{
+}
+
+template<typename ALLOCATOR>
+void* tMemoryResourceT<ALLOCATOR>::AllocateUnmanaged(const int32_t nbytes,const unsigned short alignment)
+{
+	return m_Allocator.AllocateUnmanaged(nbytes,alignment);
+}
+
+template<typename ALLOCATOR>
+void tMemoryResourceT<ALLOCATOR>::DeallocateUnmanaged(void* const memory,const int32_t nbytes)
+{
+	m_Allocator.DeallocateUnmanaged(memory,nbytes);
+}
\ No newline at end of file
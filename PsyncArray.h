@@ -1,27 +1,218 @@
 #pragma once
 
+#include "Emplace.h"
+#include "ThreadPool.h"
+#include "Span.h"
+#include <vector>
+#include <iterator>
+
+#ifdef _DEBUG
+// The iterator of a tPArrayT in debug builds, which checks it stays within the constructed elements of the array it
+//  came from. In release builds the iterator is a plain pointer. ELEMTYPE is const for a const_iterator
+template<typename CONTAINER,typename ELEMTYPE>
+class tPArrayCheckedIteratorT : public std::iterator<std::random_access_iterator_tag,
+ typename CONTAINER::value_type,ptrdiff_t,ELEMTYPE*,ELEMTYPE&>
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	template<typename,typename>
+	friend class tPArrayCheckedIteratorT;
+	ELEMTYPE* m_PItem;
+	const CONTAINER* m_Container;
+	//~V
+	void Invariant(void) const;
+	void CheckSameContainer(const tPArrayCheckedIteratorT& rhs) const;
+	//~F
+public:
+	typedef ptrdiff_t difference_type;
+//=====================================================================================================================
+// PROPERTIES
+//=====================================================================================================================
+	ELEMTYPE& operator*(void) const;
+	ELEMTYPE* operator->(void) const;
+	ELEMTYPE& operator[](const difference_type offset) const;
+	difference_type operator-(const tPArrayCheckedIteratorT& rhs) const;
+	bool operator==(const tPArrayCheckedIteratorT& rhs) const;
+	bool operator!=(const tPArrayCheckedIteratorT& rhs) const;
+	bool operator<(const tPArrayCheckedIteratorT& rhs) const;
+	bool operator>(const tPArrayCheckedIteratorT& rhs) const;
+	bool operator<=(const tPArrayCheckedIteratorT& rhs) const;
+	bool operator>=(const tPArrayCheckedIteratorT& rhs) const;
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tPArrayCheckedIteratorT(void);
+	tPArrayCheckedIteratorT(
+	 ELEMTYPE* const pitem,
+	 const CONTAINER& container);
+	tPArrayCheckedIteratorT(
+	 const tPArrayCheckedIteratorT<CONTAINER,typename CONTAINER::value_type>& rhs);// An iterator converts to a
+																									//  const_iterator
+	tPArrayCheckedIteratorT& operator++(void);
+	tPArrayCheckedIteratorT operator++(int);
+	tPArrayCheckedIteratorT& operator--(void);
+	tPArrayCheckedIteratorT operator--(int);
+	tPArrayCheckedIteratorT& operator+=(const difference_type offset);
+	tPArrayCheckedIteratorT& operator-=(const difference_type offset);
+	tPArrayCheckedIteratorT operator+(const difference_type offset) const;
+	tPArrayCheckedIteratorT operator-(const difference_type offset) const;
+	//~PF
+};
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE> operator+(
+ const ptrdiff_t offset,
+ const tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>& iterator);
+#endif
+
 template<typename BASECLASS,typename TYPE>
 class tPArrayT : public BASECLASS
 {
 public:
-	class iterator;
+	typedef TYPE value_type;
+#ifdef _DEBUG
+	typedef tPArrayCheckedIteratorT<tPArrayT,TYPE> iterator;
+	typedef tPArrayCheckedIteratorT<tPArrayT,const TYPE> const_iterator;
+	template<typename,typename>
+	friend class tPArrayCheckedIteratorT;
+#else
+	typedef TYPE* iterator;
+	typedef const TYPE* const_iterator;
+#endif
 	struct tCtorArgs;
 	friend class tPArray_UnitTest;
 	tPArrayT(const tCtorArgs& args);
 	~tPArrayT(void);
-	iterator begin();
-	iterator end();
+	iterator begin();																			// Random access, over the constructed
+	iterator end();																			//  elements
+	const_iterator begin() const;
+	const_iterator end() const;
+	TYPE* data(void);																			// The first element. The elements are
+	const TYPE* data(void) const;															//  contiguous
+	tSpanT<TYPE> Span(void);																// The constructed elements
+	tSpanT<const TYPE> Span(void) const;
 	int32_t NumReserved(void) const;														// Maximum number of elements
+	static int32_t AllocationSize(const int32_t numelements);					// Bytes needed for an array of this many
+																									//  elements
 	int32_t Size(void) const;																// Number of elements constructed
 	TYPE& Construct(void);																	// Construct another element
-	TYPE& Construct(typename const TYPE::tCtorArgs& args);						// Construct another element
+	template<typename ARGS>
+	TYPE& Construct(const ARGS& args);													// Construct another element from it's
+																									//  tCtorArgs
+	TYPE& Emplace(void);																		// Construct another element from these
+																									//  arguments, passed straight to it's
+																									//  constructor
+	template<typename A1>
+	TYPE& Emplace(const A1& a1);
+	template<typename A1,typename A2>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2);
+	template<typename A1,typename A2,typename A3>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3);
+	template<typename A1,typename A2,typename A3,typename A4>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3,
+	 const A4& a4);
+	void ConstructN(const int32_t count);												// Construct another 'count' elements
+	template<typename ARGS>
+	void ConstructN(
+	 const int32_t count,
+	 const ARGS& args);																		// Construct another 'count' elements, each
+																									//  from these tCtorArgs
+	template<typename ITERATOR>
+	void AppendRange(
+	 ITERATOR first,
+	 const ITERATOR last);																	// Copy construct another element from each
+																									//  in [first,last). A pointer range of a
+																									//  trivially copyable TYPE is copied with
+																									//  memcpy
+	void Fill(
+	 const int32_t count,
+	 const TYPE& value);																		// Copy construct another 'count' elements
+																									//  from 'value'. A trivially copyable TYPE
+																									//  is set with memset or memcpy
 	void Clear(void);																			// Remove all the constructed elements
+	template<typename FUNC>
+	void ParallelForEach(
+	 tThreadPool& pool,
+	 FUNC func);																				// Call 'func(TYPE&)' for every constructed
+																									//  element from all of the pool's
+																									//  threads. 'func' must not throw
+	template<typename VALUE,typename ACCUMULATE,typename COMBINE>
+	VALUE ParallelReduce(
+	 tThreadPool& pool,
+	 const VALUE& identity,
+	 ACCUMULATE accumulate,
+	 COMBINE combine) const;																// Each chunk's elements are accumulated
+																									//  with 'VALUE accumulate(VALUE,const
+																									//  TYPE&)' starting from 'identity', and
+																									//  the chunk totals combined in order with
+																									//  'VALUE combine(VALUE,VALUE)'. Neither
+																									//  may throw
+	void ParallelConstruct(
+	 tThreadPool& pool,
+	 const int32_t count);																	// Construct another 'count' elements from
+																									//  all of the pool's threads
+	template<typename ARGS>
+	void ParallelConstruct(
+	 tThreadPool& pool,
+	 const int32_t count,
+	 const ARGS& args);																		// Construct another 'count' elements, each
+																									//  from these tCtorArgs
+	void BeginConcurrentAppend(void);													// Allow ConstructConcurrent and
+																									//  EmplaceConcurrent from any thread.
+																									//  Nothing else may construct elements
+																									//  until EndConcurrentAppend
+	TYPE* ConstructConcurrent(void);														// Thread safe Construct. Returns NULL if
+																									//  the array is full. If TYPE's
+																									//  constructor throws the elements claimed
+																									//  after it are never published, they are
+																									//  destroyed by EndConcurrentAppend
+	template<typename ARGS>
+	TYPE* ConstructConcurrent(const ARGS& args);
+	template<typename A1>
+	TYPE* EmplaceConcurrent(const A1& a1);												// Thread safe Emplace
+	template<typename A1,typename A2>
+	TYPE* EmplaceConcurrent(
+	 const A1& a1,
+	 const A2& a2);
+	template<typename A1,typename A2,typename A3>
+	TYPE* EmplaceConcurrent(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3);
+	template<typename A1,typename A2,typename A3,typename A4>
+	TYPE* EmplaceConcurrent(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3,
+	 const A4& a4);
+	void EndConcurrentAppend(void);														// All threads have finished appending
+	bool IsAppendingConcurrently(void) const;
 	TYPE& operator[](const int32_t index);												// Item at this index/offset
 	const TYPE& operator[](const int32_t index) const;
 private:
 	const int32_t m_NumElements;															// Maximum number of elements
-	int32_t m_NumConstructed;																// Number of elements constructed
+	volatile long m_NumConstructed;														// Number of elements constructed. Between
+																									//  Begin/EndConcurrentAppend elements are
+																									//  added to it in order once constructed,
+																									//  so readers only see whole elements
+	volatile long m_NumClaimed;															// Elements claimed by threads appending.
+																									//  Only in use between
+																									//  Begin/EndConcurrentAppend
 	//~V
+	enum
+	{
+		eNotConcurrent=-1,																	// m_NumClaimed when not in use
+		eReadyFlagsPerWord=sizeof(long)*8,												// Bits in each word of ready flags
+	};
 	TYPE& BeginPtr(void);
 	const TYPE& BeginPtr(void) const;
 	TYPE& EndPtr(void);																		// The end of the constructed array
@@ -29,6 +220,57 @@ private:
 	TYPE& EndOfArrayPtr(void);																// The end of the array
 	const TYPE& EndOfArrayPtr(void) const;
 	iterator CreateIterator(TYPE& item);
+	const_iterator CreateIterator(const TYPE& item) const;
+	template<typename ARGS>
+	TYPE& _Emplace(const ARGS& args);													// Construct another element from these
+																									//  tEmplaceArgsT
+	template<typename ARGS>
+	TYPE* _EmplaceConcurrent(const ARGS& args);
+	static int32_t ReadyFlagsOffset(const int32_t numelements);					// The flags follow the elements, one bit
+																									//  for each, set once it's constructed
+																									//  while appending concurrently
+	volatile long* ReadyFlags(void) const;
+	bool IsReady(const long index) const;
+	void SetReady(const long index);
+	void ClearReadyFlags(void);
+	void PublishReady(void);																// Add the ready elements following the
+																									//  constructed ones to m_NumConstructed
+	void DestroyUnpublished(void);														// Destroy the elements constructed after
+																									//  one whose constructor threw
+	template<typename ARGS>
+	void _EmplaceN(
+	 const int32_t count,
+	 const ARGS& args);																		// Construct another 'count' elements from
+																									//  these tEmplaceArgsT
+	template<typename ITERATOR>
+	void _AppendRange(
+	 ITERATOR first,
+	 const ITERATOR last);																	// Copy construct one element at a time
+	void _AppendRange(
+	 const TYPE* const first,
+	 const TYPE* const last);
+	void _AppendRange(
+	 TYPE* const first,
+	 TYPE* const last);
+	static bool IsByteRepeated(const TYPE& value);									// Every byte of 'value' is the same, so
+																									//  it can be copied with memset
+	struct _tChunks;
+	template<typename FUNC>
+	struct _tForEachJob;
+	template<typename VALUE,typename ACCUMULATE>
+	struct _tReduceJob;
+	template<typename ARGS>
+	struct _tConstructJob;
+	_tChunks MakeChunks(
+	 const int32_t begin,
+	 const int32_t end,
+	 const int32_t numthreads) const;													// Split these elements between threads
+	template<typename ARGS>
+	void _ParallelEmplace(
+	 tThreadPool& pool,
+	 const int32_t count,
+	 const ARGS& args);																		// Construct another 'count' elements from
+																									//  these tEmplaceArgsT
 	void Invariant(void) const;
 	TYPE& ElementAt_NoCheck(const int32_t index);									// The element at this index without
 																									//  checking if it's constructed
@@ -42,6 +284,62 @@ struct tPArrayT<BASECLASS,TYPE>::tCtorArgs
 	int32_t NumElements;
 };
 
+// A run of elements split in to chunks for a tThreadPool. Every chunk but the first and last starts on a cache line
+//  and is a whole number of cache lines, so no two threads write to the same cache line
+template<typename BASECLASS,typename TYPE>
+struct tPArrayT<BASECLASS,TYPE>::_tChunks
+{
+	int32_t Begin;																				// The first element
+	int32_t End;
+	int32_t FirstSize;																		// Elements before the first cache line
+	int32_t Size;																				// Elements in every other chunk
+	int32_t Count;																				// The number of chunks
+	void Chunk(
+	 const int32_t chunk,
+	 int32_t& begin,
+	 int32_t& end) const;																	// The elements in this chunk
+};
+
+template<typename BASECLASS,typename TYPE>
+template<typename FUNC>
+struct tPArrayT<BASECLASS,TYPE>::_tForEachJob
+{
+	tPArrayT& Array;
+	const _tChunks& Chunks;
+	FUNC& Func;
+	static void RunChunk(
+	 void* const context,
+	 const int32_t chunk);
+};
+
+template<typename BASECLASS,typename TYPE>
+template<typename VALUE,typename ACCUMULATE>
+struct tPArrayT<BASECLASS,TYPE>::_tReduceJob
+{
+	const tPArrayT& Array;
+	const _tChunks& Chunks;
+	const VALUE& Identity;
+	ACCUMULATE& Accumulate;
+	VALUE* Totals;																				// The total of each chunk
+	static void RunChunk(
+	 void* const context,
+	 const int32_t chunk);
+};
+
+template<typename BASECLASS,typename TYPE>
+template<typename ARGS>
+struct tPArrayT<BASECLASS,TYPE>::_tConstructJob
+{
+	tPArrayT& Array;
+	const _tChunks& Chunks;
+	const ARGS& Args;
+	int32_t* NumConstructed;																// The elements constructed from the start
+																									//  of each chunk before one threw
+	static void RunChunk(
+	 void* const context,
+	 const int32_t chunk);
+};
+
 //=====================================================================================================================
 // ARRAY CREATION FUNCTIONS
 //=====================================================================================================================
@@ -52,36 +350,6 @@ tPArrayT<BASECLASS,TYPE>& PMakeArrayT(
  ALLOCATOR& allocator,
  const int32_t numelements);
 
-//=====================================================================================================================
-// ITERATOR CLASS DECLARATION
-//=====================================================================================================================
-
-template<typename BASECLASS,typename TYPE>
-class tPArrayT<BASECLASS,TYPE>::iterator
-{
-	TYPE* m_PItem;
-#ifdef _DEBUG
-	tPArrayT<BASECLASS,TYPE>* m_Container;
-#endif
-	//~V
-	void Invariant(void) const;
-	//~F
-public:
-	iterator(void);
-	iterator(TYPE& item
-#ifdef _DEBUG
-	 ,tPArrayT<BASECLASS,TYPE>& container
-#endif
-	);
-	iterator operator++(void);
-	iterator operator++(int);
-	iterator operator--(void);
-	iterator operator--(int);
-	bool operator==(const iterator& rhs) const;
-	bool operator!=(const iterator& rhs) const;
-	TYPE& operator*(void);
-};
-
 //=====================================================================================================================
 // IMPLEMENTATION
 //=====================================================================================================================
@@ -91,7 +359,7 @@ tPArrayT<BASECLASS,TYPE>& PMakeArrayT(ALLOCATOR& allocator,const int32_t numelem
 {
 	_ASSERTE(numelements>0);
 	typedef tPArrayT<BASECLASS,TYPE> _tPArray;
-	const int32_t size=sizeof(_tPArray)+(sizeof(TYPE)*numelements);
+	const int32_t size=_tPArray::AllocationSize(numelements);
 	const _tPArray::tCtorArgs args=
 	{
 		numelements,
@@ -101,7 +369,8 @@ tPArrayT<BASECLASS,TYPE>& PMakeArrayT(ALLOCATOR& allocator,const int32_t numelem
 }
 
 template<typename BASECLASS,typename TYPE>
-tPArrayT<BASECLASS,TYPE>::tPArrayT(const tCtorArgs& args):m_NumElements(args.NumElements),m_NumConstructed(0)
+tPArrayT<BASECLASS,TYPE>::tPArrayT(const tCtorArgs& args):m_NumElements(args.NumElements),m_NumConstructed(0),
+ m_NumClaimed(eNotConcurrent)
 {
 	_ASSERTE(m_NumElements>0);
 	Invariant();
@@ -117,10 +386,23 @@ template<typename BASECLASS,typename TYPE>
 void tPArrayT<BASECLASS,TYPE>::Clear(void)
 {
 	Invariant();
-	for(TYPE* elemptr=&BeginPtr();elemptr!=&EndPtr();++elemptr)
+	if(IsAppendingConcurrently())
+	{
+		// No thread may be appending
+		DestroyUnpublished();
+		ClearReadyFlags();
+		m_NumClaimed=0;
+	}
+	// Nothing to do for each element if the destructor does nothing
+	static const bool destroy=!has_trivial_destructor<TYPE>::value;
+	if(destroy)
 	{
-		// Destruct the element
-		elemptr->~TYPE();
+		TYPE* const endptr=&EndPtr();
+		for(TYPE* elemptr=&BeginPtr();elemptr!=endptr;++elemptr)
+		{
+			// Destruct the element
+			elemptr->~TYPE();
+		}
 	}
 	m_NumConstructed=0;
 	Invariant();
@@ -167,9 +449,20 @@ typename tPArrayT<BASECLASS,TYPE>::iterator tPArrayT<BASECLASS,TYPE>::CreateIter
 {
 	Invariant();
 #ifdef _DEBUG
-	return iterator(item,*this);
+	return iterator(&item,*this);
 #else
-	return iterator(item);
+	return &item;
+#endif
+}
+
+template<typename BASECLASS,typename TYPE>
+typename tPArrayT<BASECLASS,TYPE>::const_iterator tPArrayT<BASECLASS,TYPE>::CreateIterator(const TYPE& item) const
+{
+	Invariant();
+#ifdef _DEBUG
+	return const_iterator(&item,*this);
+#else
+	return &item;
 #endif
 }
 
@@ -185,12 +478,53 @@ typename tPArrayT<BASECLASS,TYPE>::iterator tPArrayT<BASECLASS,TYPE>::end(void)
 	return CreateIterator(EndPtr());
 }
 
+template<typename BASECLASS,typename TYPE>
+typename tPArrayT<BASECLASS,TYPE>::const_iterator tPArrayT<BASECLASS,TYPE>::begin(void) const
+{
+	return CreateIterator(BeginPtr());
+}
+
+template<typename BASECLASS,typename TYPE>
+typename tPArrayT<BASECLASS,TYPE>::const_iterator tPArrayT<BASECLASS,TYPE>::end(void) const
+{
+	return CreateIterator(EndPtr());
+}
+
+template<typename BASECLASS,typename TYPE>
+TYPE* tPArrayT<BASECLASS,TYPE>::data(void)
+{
+	return &BeginPtr();
+}
+
+template<typename BASECLASS,typename TYPE>
+const TYPE* tPArrayT<BASECLASS,TYPE>::data(void) const
+{
+	return &BeginPtr();
+}
+
+template<typename BASECLASS,typename TYPE>
+tSpanT<TYPE> tPArrayT<BASECLASS,TYPE>::Span(void)
+{
+	Invariant();
+	return tSpanT<TYPE>(&BeginPtr(),m_NumConstructed);
+}
+
+template<typename BASECLASS,typename TYPE>
+tSpanT<const TYPE> tPArrayT<BASECLASS,TYPE>::Span(void) const
+{
+	Invariant();
+	return tSpanT<const TYPE>(&BeginPtr(),m_NumConstructed);
+}
+
 template<typename BASECLASS,typename TYPE>
 void tPArrayT<BASECLASS,TYPE>::Invariant(void) const
 {
 #ifdef _DEBUG
 	_ASSERTE(m_NumElements>0);
 	_ASSERTE(m_NumConstructed>=0);
+	// Read before the claims, as another thread may be appending
+	const long numconstructed=m_NumConstructed;
+	_ASSERTE(m_NumClaimed==eNotConcurrent || m_NumClaimed>=numconstructed);
 	// Can't construct more elements than are in the array
 	_ASSERTE(m_NumConstructed<=m_NumElements);
 	_ASSERTE(reinterpret_cast<const char*>(&(BeginPtr()))==
@@ -200,144 +534,416 @@ void tPArrayT<BASECLASS,TYPE>::Invariant(void) const
 }
 
 template<typename BASECLASS,typename TYPE>
-tPArrayT<BASECLASS,TYPE>::iterator::iterator(void):m_PItem(NULL),m_Container(NULL)
+int32_t tPArrayT<BASECLASS,TYPE>::NumReserved(void) const
 {
-	Invariant();
+	return m_NumElements;
 }
 
 template<typename BASECLASS,typename TYPE>
-tPArrayT<BASECLASS,TYPE>::iterator::iterator(TYPE& item
-#ifdef _DEBUG
- ,tPArrayT<BASECLASS,TYPE>& container
-#endif
- ):m_PItem(&item)
-#ifdef _DEBUG
- ,m_Container(&container)
-#endif
+int32_t tPArrayT<BASECLASS,TYPE>::Size(void) const
+{
+	return m_NumConstructed;
+}
+
+template<typename BASECLASS,typename TYPE>
+TYPE& tPArrayT<BASECLASS,TYPE>::ElementAt_NoCheck(const int32_t index)
+{
+	return const_cast<TYPE&>(static_cast<const tPArrayT&>(*this).ElementAt_NoCheck(index));
+}
+
+template<typename BASECLASS,typename TYPE>
+const TYPE& tPArrayT<BASECLASS,TYPE>::ElementAt_NoCheck(const int32_t index) const
+{
+	_ASSERTE(index<m_NumElements);
+	return *(&(BeginPtr())+index);
+}
+
+template<typename BASECLASS,typename TYPE>
+TYPE& tPArrayT<BASECLASS,TYPE>::Construct(void)
+{
+	return _Emplace(tEmplaceArgsT<TYPE>());
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename ARGS>
+TYPE& tPArrayT<BASECLASS,TYPE>::Construct(const ARGS& args)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,ARGS>(args));
+}
+
+template<typename BASECLASS,typename TYPE>
+TYPE& tPArrayT<BASECLASS,TYPE>::Emplace(void)
+{
+	return _Emplace(tEmplaceArgsT<TYPE>());
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename A1>
+TYPE& tPArrayT<BASECLASS,TYPE>::Emplace(const A1& a1)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1>(a1));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename A1,typename A2>
+TYPE& tPArrayT<BASECLASS,TYPE>::Emplace(const A1& a1,const A2& a2)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1,A2>(a1,a2));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename A1,typename A2,typename A3>
+TYPE& tPArrayT<BASECLASS,TYPE>::Emplace(const A1& a1,const A2& a2,const A3& a3)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1,A2,A3>(a1,a2,a3));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename A1,typename A2,typename A3,typename A4>
+TYPE& tPArrayT<BASECLASS,TYPE>::Emplace(const A1& a1,const A2& a2,const A3& a3,const A4& a4)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1,A2,A3,A4>(a1,a2,a3,a4));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename ARGS>
+TYPE& tPArrayT<BASECLASS,TYPE>::_Emplace(const ARGS& args)
 {
 	Invariant();
+	_ASSERTE(!IsAppendingConcurrently());
+	_ASSERTE(m_NumConstructed<m_NumElements);
+	TYPE& item=args.Construct(&(ElementAt_NoCheck(m_NumConstructed)));
+	++m_NumConstructed;
+	Invariant();
+	return item;
 }
 
 template<typename BASECLASS,typename TYPE>
-bool tPArrayT<BASECLASS,TYPE>::iterator::operator==(const iterator& rhs) const
+void tPArrayT<BASECLASS,TYPE>::ConstructN(const int32_t count)
 {
-	_ASSERTE(rhs.m_Container==m_Container);
-	return rhs.m_PItem==m_PItem;
+	_EmplaceN(count,tEmplaceArgsT<TYPE>());
 }
 
 template<typename BASECLASS,typename TYPE>
-bool tPArrayT<BASECLASS,TYPE>::iterator::operator!=(const iterator& rhs) const
+template<typename ARGS>
+void tPArrayT<BASECLASS,TYPE>::ConstructN(const int32_t count,const ARGS& args)
 {
-	_ASSERTE(rhs.m_Container==m_Container);
-	return rhs.m_PItem!=m_PItem;
+	_EmplaceN(count,tEmplaceArgsT<TYPE,ARGS>(args));
 }
 
 template<typename BASECLASS,typename TYPE>
-typename tPArrayT<BASECLASS,TYPE>::iterator tPArrayT<BASECLASS,TYPE>::iterator::operator++(void)
+template<typename ARGS>
+void tPArrayT<BASECLASS,TYPE>::_EmplaceN(const int32_t count,const ARGS& args)
 {
 	Invariant();
-	++m_PItem;
+	_ASSERTE(!IsAppendingConcurrently());
+	_ASSERTE(count>=0);
+	_ASSERTE(count<=m_NumElements-m_NumConstructed);
+	// Counted locally and stored once at the end
+	int32_t index=m_NumConstructed;
+	const int32_t end=index+count;
+	try
+	{
+		for(;index<end;++index)
+		{
+			args.Construct(&(ElementAt_NoCheck(index)));
+		}
+	}
+	catch(...)
+	{
+		// Keep the elements constructed before the one which threw, as a Construct loop would
+		m_NumConstructed=index;
+		Invariant();
+		throw;
+	}
+	m_NumConstructed=end;
 	Invariant();
-	return *this;
 }
 
-// Postincrement
 template<typename BASECLASS,typename TYPE>
-typename tPArrayT<BASECLASS,TYPE>::iterator tPArrayT<BASECLASS,TYPE>::iterator::operator++(int)
+template<typename ITERATOR>
+void tPArrayT<BASECLASS,TYPE>::AppendRange(ITERATOR first,const ITERATOR last)
+{
+	_AppendRange(first,last);
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename ITERATOR>
+void tPArrayT<BASECLASS,TYPE>::_AppendRange(ITERATOR first,const ITERATOR last)
 {
 	Invariant();
-	iterator copy(*this);
-	++m_PItem;
+	_ASSERTE(!IsAppendingConcurrently());
+	int32_t index=m_NumConstructed;
+	try
+	{
+		for(;first!=last;++first,++index)
+		{
+			_ASSERTE(index<m_NumElements);
+			::new(&(ElementAt_NoCheck(index))) TYPE(*first);
+		}
+	}
+	catch(...)
+	{
+		m_NumConstructed=index;
+		Invariant();
+		throw;
+	}
+	m_NumConstructed=index;
 	Invariant();
-	return copy;
 }
 
 template<typename BASECLASS,typename TYPE>
-typename tPArrayT<BASECLASS,TYPE>::iterator tPArrayT<BASECLASS,TYPE>::iterator::operator--(void)
+void tPArrayT<BASECLASS,TYPE>::_AppendRange(const TYPE* const first,const TYPE* const last)
 {
+	static const bool trivialcopy=has_trivial_copy<TYPE>::value;
+	if(!trivialcopy)
+	{
+		_AppendRange<const TYPE*>(first,last);
+		return;
+	}
 	Invariant();
-	--m_PItem;
+	_ASSERTE(!IsAppendingConcurrently());
+	_ASSERTE(first<=last);
+	const int32_t count=static_cast<int32_t>(last-first);
+	_ASSERTE(count<=m_NumElements-m_NumConstructed);
+	if(count)
+	{
+		memcpy(&(ElementAt_NoCheck(m_NumConstructed)),first,count*sizeof(TYPE));
+		m_NumConstructed+=count;
+	}
 	Invariant();
-	return *this;
 }
 
-// Post decrement
 template<typename BASECLASS,typename TYPE>
-typename tPArrayT<BASECLASS,TYPE>::iterator tPArrayT<BASECLASS,TYPE>::iterator::operator--(int)
+void tPArrayT<BASECLASS,TYPE>::_AppendRange(TYPE* const first,TYPE* const last)
 {
+	_AppendRange(static_cast<const TYPE*>(first),static_cast<const TYPE*>(last));
+}
+
+template<typename BASECLASS,typename TYPE>
+void tPArrayT<BASECLASS,TYPE>::Fill(const int32_t count,const TYPE& value)
+{
+	static const bool trivialcopy=has_trivial_copy<TYPE>::value;
+	if(!trivialcopy)
+	{
+		_EmplaceN(count,tEmplaceArgsT<TYPE,TYPE>(value));
+		return;
+	}
 	Invariant();
-	iterator copy(*this);
-	--m_PItem;
+	_ASSERTE(!IsAppendingConcurrently());
+	_ASSERTE(count>=0);
+	_ASSERTE(count<=m_NumElements-m_NumConstructed);
+	if(count)
+	{
+		char* const bytes=reinterpret_cast<char*>(&(ElementAt_NoCheck(m_NumConstructed)));
+		const int32_t numbytes=count*static_cast<int32_t>(sizeof(TYPE));
+		if(IsByteRepeated(value))
+		{
+			memset(bytes,*reinterpret_cast<const unsigned char*>(&value),numbytes);
+		}
+		else
+		{
+			// Copy the value once and then keep doubling what has been filled
+			memcpy(bytes,&value,sizeof(TYPE));
+			for(int32_t numfilled=static_cast<int32_t>(sizeof(TYPE));numfilled<numbytes;)
+			{
+				const int32_t numtocopy=(numfilled<numbytes-numfilled)?numfilled:numbytes-numfilled;
+				memcpy(bytes+numfilled,bytes,numtocopy);
+				numfilled+=numtocopy;
+			}
+		}
+		m_NumConstructed+=count;
+	}
 	Invariant();
-	return copy;
 }
 
 template<typename BASECLASS,typename TYPE>
-TYPE& tPArrayT<BASECLASS,TYPE>::iterator::operator*(void)
+bool tPArrayT<BASECLASS,TYPE>::IsByteRepeated(const TYPE& value)
 {
-	_ASSERTE(m_PItem);
-#ifdef _DEBUG
-	// Can't be outside the bounds of the array
-	_ASSERTE(m_PItem>=&(m_Container->BeginPtr()) && m_PItem<&(m_Container->EndPtr()));
-#endif
-	return *m_PItem;
+	const unsigned char* const bytes=reinterpret_cast<const unsigned char*>(&value);
+	for(size_t i=1;i<sizeof(TYPE);++i)
+	{
+		if(bytes[i]!=bytes[0])
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 template<typename BASECLASS,typename TYPE>
-void tPArrayT<BASECLASS,TYPE>::iterator::Invariant(void) const
+void tPArrayT<BASECLASS,TYPE>::BeginConcurrentAppend(void)
 {
-#ifdef _DEBUG
-	m_Container->Invariant();
-#endif
+	Invariant();
+	_ASSERTE(!IsAppendingConcurrently());
+	ClearReadyFlags();
+	m_NumClaimed=m_NumConstructed;
+	_ASSERTE(IsAppendingConcurrently());
 }
 
 template<typename BASECLASS,typename TYPE>
-int32_t tPArrayT<BASECLASS,TYPE>::NumReserved(void) const
+void tPArrayT<BASECLASS,TYPE>::EndConcurrentAppend(void)
 {
-	return m_NumElements;
+	_ASSERTE(IsAppendingConcurrently());
+	DestroyUnpublished();
+	m_NumClaimed=eNotConcurrent;
+	Invariant();
 }
 
 template<typename BASECLASS,typename TYPE>
-int32_t tPArrayT<BASECLASS,TYPE>::Size(void) const
+bool tPArrayT<BASECLASS,TYPE>::IsAppendingConcurrently(void) const
 {
-	return m_NumConstructed;
+	return (m_NumClaimed!=eNotConcurrent);
 }
 
 template<typename BASECLASS,typename TYPE>
-TYPE& tPArrayT<BASECLASS,TYPE>::ElementAt_NoCheck(const int32_t index)
+TYPE* tPArrayT<BASECLASS,TYPE>::ConstructConcurrent(void)
 {
-	return const_cast<TYPE&>(static_cast<const tPArrayT&>(*this).ElementAt_NoCheck(index));
+	return _EmplaceConcurrent(tEmplaceArgsT<TYPE>());
 }
 
 template<typename BASECLASS,typename TYPE>
-const TYPE& tPArrayT<BASECLASS,TYPE>::ElementAt_NoCheck(const int32_t index) const
+template<typename ARGS>
+TYPE* tPArrayT<BASECLASS,TYPE>::ConstructConcurrent(const ARGS& args)
 {
-	_ASSERTE(index<m_NumElements);
-	return *(&(BeginPtr())+index);
+	return _EmplaceConcurrent(tEmplaceArgsT<TYPE,ARGS>(args));
 }
 
 template<typename BASECLASS,typename TYPE>
-TYPE& tPArrayT<BASECLASS,TYPE>::Construct(void)
+template<typename A1>
+TYPE* tPArrayT<BASECLASS,TYPE>::EmplaceConcurrent(const A1& a1)
 {
-	Invariant();
-	_ASSERTE(m_NumConstructed<m_NumElements);
-	TYPE& item(ElementAt_NoCheck(m_NumConstructed));
-	::new(static_cast<void*>(&item)) TYPE();
-	++m_NumConstructed;
-	Invariant();
-	return item;
+	return _EmplaceConcurrent(tEmplaceArgsT<TYPE,A1>(a1));
 }
 
 template<typename BASECLASS,typename TYPE>
-TYPE& tPArrayT<BASECLASS,TYPE>::Construct(typename const TYPE::tCtorArgs& args)
+template<typename A1,typename A2>
+TYPE* tPArrayT<BASECLASS,TYPE>::EmplaceConcurrent(const A1& a1,const A2& a2)
 {
-	Invariant();
-	_ASSERTE(m_NumConstructed<m_NumElements);
-	TYPE& item(ElementAt_NoCheck(m_NumConstructed));
-	::new(static_cast<void*>(&item)) TYPE(args);
-	++m_NumConstructed;
-	Invariant();
-	return item;
+	return _EmplaceConcurrent(tEmplaceArgsT<TYPE,A1,A2>(a1,a2));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename A1,typename A2,typename A3>
+TYPE* tPArrayT<BASECLASS,TYPE>::EmplaceConcurrent(const A1& a1,const A2& a2,const A3& a3)
+{
+	return _EmplaceConcurrent(tEmplaceArgsT<TYPE,A1,A2,A3>(a1,a2,a3));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename A1,typename A2,typename A3,typename A4>
+TYPE* tPArrayT<BASECLASS,TYPE>::EmplaceConcurrent(const A1& a1,const A2& a2,const A3& a3,const A4& a4)
+{
+	return _EmplaceConcurrent(tEmplaceArgsT<TYPE,A1,A2,A3,A4>(a1,a2,a3,a4));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename ARGS>
+TYPE* tPArrayT<BASECLASS,TYPE>::_EmplaceConcurrent(const ARGS& args)
+{
+	_ASSERTE(IsAppendingConcurrently());
+	// Stop claiming once full, rather than adding to the claims with every call
+	if(m_NumClaimed>=m_NumElements)
+	{
+		return NULL;
+	}
+	const long index=InterlockedIncrement(&m_NumClaimed)-1;
+	if(index>=m_NumElements)
+	{
+		// Another thread claimed the last slot first
+		return NULL;
+	}
+	TYPE& item=args.Construct(&(ElementAt_NoCheck(static_cast<int32_t>(index))));
+	// Elements are published in the order their slots were claimed. Rather than wait for the threads constructing
+	//  the elements before this one, mark it as ready so whichever thread finishes the element before it
+	//  publishes it
+	SetReady(index);
+	PublishReady();
+	return &item;
+}
+
+template<typename BASECLASS,typename TYPE>
+int32_t tPArrayT<BASECLASS,TYPE>::AllocationSize(const int32_t numelements)
+{
+	_ASSERTE(numelements>0);
+	const int32_t numwords=(numelements+eReadyFlagsPerWord-1)/eReadyFlagsPerWord;
+	return ReadyFlagsOffset(numelements)+static_cast<int32_t>(numwords*sizeof(long));
+}
+
+template<typename BASECLASS,typename TYPE>
+int32_t tPArrayT<BASECLASS,TYPE>::ReadyFlagsOffset(const int32_t numelements)
+{
+	// Aligned for the interlocked operations
+	const int32_t endofelements=static_cast<int32_t>(sizeof(tPArrayT)+(sizeof(TYPE)*numelements));
+	const int32_t alignment=sizeof(long);
+	return (endofelements+alignment-1)&~(alignment-1);
+}
+
+template<typename BASECLASS,typename TYPE>
+volatile long* tPArrayT<BASECLASS,TYPE>::ReadyFlags(void) const
+{
+	return reinterpret_cast<volatile long*>(
+	 const_cast<char*>(reinterpret_cast<const char*>(this))+ReadyFlagsOffset(m_NumElements));
+}
+
+template<typename BASECLASS,typename TYPE>
+bool tPArrayT<BASECLASS,TYPE>::IsReady(const long index) const
+{
+	_ASSERTE(index>=0 && index<m_NumElements);
+	const long bit=static_cast<long>(1UL<<(index%eReadyFlagsPerWord));
+	return ((ReadyFlags()[index/eReadyFlagsPerWord]&bit)!=0);
+}
+
+template<typename BASECLASS,typename TYPE>
+void tPArrayT<BASECLASS,TYPE>::SetReady(const long index)
+{
+	_ASSERTE(!IsReady(index));
+	// A full barrier, so the element is constructed before any thread sees the flag
+	const long bit=static_cast<long>(1UL<<(index%eReadyFlagsPerWord));
+	InterlockedOr(&(ReadyFlags()[index/eReadyFlagsPerWord]),bit);
+}
+
+template<typename BASECLASS,typename TYPE>
+void tPArrayT<BASECLASS,TYPE>::ClearReadyFlags(void)
+{
+	const int32_t numwords=(m_NumElements+eReadyFlagsPerWord-1)/eReadyFlagsPerWord;
+	memset(const_cast<long*>(ReadyFlags()),0,numwords*sizeof(long));
+}
+
+template<typename BASECLASS,typename TYPE>
+void tPArrayT<BASECLASS,TYPE>::PublishReady(void)
+{
+	for(;;)
+	{
+		const long numconstructed=m_NumConstructed;
+		if(numconstructed>=m_NumElements || !IsReady(numconstructed))
+		{
+			// The thread constructing the next element will publish it
+			return;
+		}
+		// Another thread may have published it first, in which case try the one after it
+		InterlockedCompareExchange(&m_NumConstructed,numconstructed+1,numconstructed);
+	}
+}
+
+template<typename BASECLASS,typename TYPE>
+void tPArrayT<BASECLASS,TYPE>::DestroyUnpublished(void)
+{
+	// No thread may be appending. Every element claimed before the array was full has been published, unless a
+	//  constructor threw which leaves the elements after it unpublished
+	const long numclaimed=(m_NumClaimed<m_NumElements)?m_NumClaimed:m_NumElements;
+	_ASSERTE(m_NumConstructed<=numclaimed);
+	static const bool destroy=!has_trivial_destructor<TYPE>::value;
+	if(destroy)
+	{
+		for(long index=m_NumConstructed;index<numclaimed;++index)
+		{
+			if(IsReady(index))
+			{
+				ElementAt_NoCheck(static_cast<int32_t>(index)).~TYPE();
+			}
+		}
+	}
 }
 
 template<typename BASECLASS,typename TYPE>
@@ -353,4 +959,425 @@ const TYPE& tPArrayT<BASECLASS,TYPE>::operator[](const int32_t index) const
 	_ASSERTE(index<m_NumConstructed);
 	_ASSERTE(index<m_NumElements);
 	return ElementAt_NoCheck(index);
-}
\ No newline at end of file
+}
+
+template<typename BASECLASS,typename TYPE>
+void tPArrayT<BASECLASS,TYPE>::_tChunks::Chunk(const int32_t chunk,int32_t& begin,int32_t& end) const
+{
+	_ASSERTE(chunk>=0 && chunk<Count);
+	if(!FirstSize)
+	{
+		begin=Begin+(chunk*Size);
+	}
+	else if(!chunk)
+	{
+		begin=Begin;
+		end=Begin+FirstSize;
+		return;
+	}
+	else
+	{
+		begin=Begin+FirstSize+((chunk-1)*Size);
+	}
+	end=(End-begin<Size)?End:begin+Size;
+}
+
+template<typename BASECLASS,typename TYPE>
+typename tPArrayT<BASECLASS,TYPE>::_tChunks tPArrayT<BASECLASS,TYPE>::MakeChunks(const int32_t begin,
+ const int32_t end,const int32_t numthreads) const
+{
+	enum
+	{
+		// A few chunks for each thread so there is something to steal when some chunks are slower than others
+		eChunksPerThread=8,
+		// The largest power of 2 which divides the element size, up to a cache line
+		eSizeAlignment=((sizeof(TYPE)&(0-sizeof(TYPE)))<tThreadPool::eCacheLineSize)?
+		 (sizeof(TYPE)&(0-sizeof(TYPE))):tThreadPool::eCacheLineSize,
+		// The fewest elements which are a whole number of cache lines
+		eLineElements=tThreadPool::eCacheLineSize/eSizeAlignment,
+	};
+	_ASSERTE(begin>=0 && begin<=end && end<=m_NumElements);
+	_ASSERTE(numthreads>0);
+	_tChunks chunks;
+	chunks.Begin=begin;
+	chunks.End=end;
+	const int32_t numelements=end-begin;
+	// The elements up to the first one which starts a cache line. None might, in which case the chunks are just
+	//  a whole number of cache lines long
+	chunks.FirstSize=0;
+	for(int32_t i=0;i<eLineElements && i<numelements;++i)
+	{
+		if(!(reinterpret_cast<uintptr_t>(&ElementAt_NoCheck(begin+i))%tThreadPool::eCacheLineSize))
+		{
+			chunks.FirstSize=i;
+			break;
+		}
+	}
+	const int32_t targetsize=numelements/(numthreads*eChunksPerThread);
+	chunks.Size=((targetsize+eLineElements-1)/eLineElements)*eLineElements;
+	if(chunks.Size<eLineElements)
+	{
+		chunks.Size=eLineElements;
+	}
+	const int32_t remaining=numelements-chunks.FirstSize;
+	chunks.Count=((chunks.FirstSize)?1:0)+((remaining+chunks.Size-1)/chunks.Size);
+	return chunks;
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename FUNC>
+void tPArrayT<BASECLASS,TYPE>::_tForEachJob<FUNC>::RunChunk(void* const context,const int32_t chunk)
+{
+	_tForEachJob& job=*static_cast<_tForEachJob*>(context);
+	int32_t begin;
+	int32_t end;
+	job.Chunks.Chunk(chunk,begin,end);
+	// A pointer rather than an iterator, which checks the array's invariant at every step in debug builds
+	TYPE* const endelemptr=&(job.Array.ElementAt_NoCheck(0))+end;
+	for(TYPE* elemptr=&(job.Array.ElementAt_NoCheck(begin));elemptr!=endelemptr;++elemptr)
+	{
+		job.Func(*elemptr);
+	}
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename FUNC>
+void tPArrayT<BASECLASS,TYPE>::ParallelForEach(tThreadPool& pool,FUNC func)
+{
+	Invariant();
+	const _tChunks chunks=MakeChunks(0,m_NumConstructed,pool.NumThreads());
+	_tForEachJob<FUNC> job=
+	{
+		*this,
+		chunks,
+		func,
+	};
+	pool.Run(chunks.Count,&_tForEachJob<FUNC>::RunChunk,&job);
+	Invariant();
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename VALUE,typename ACCUMULATE>
+void tPArrayT<BASECLASS,TYPE>::_tReduceJob<VALUE,ACCUMULATE>::RunChunk(void* const context,const int32_t chunk)
+{
+	_tReduceJob& job=*static_cast<_tReduceJob*>(context);
+	int32_t begin;
+	int32_t end;
+	job.Chunks.Chunk(chunk,begin,end);
+	// Accumulate locally so that only the total is written to memory shared with other threads
+	VALUE total=job.Identity;
+	const TYPE* const endelemptr=&(job.Array.ElementAt_NoCheck(0))+end;
+	for(const TYPE* elemptr=&(job.Array.ElementAt_NoCheck(begin));elemptr!=endelemptr;++elemptr)
+	{
+		total=job.Accumulate(total,*elemptr);
+	}
+	job.Totals[chunk]=total;
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename VALUE,typename ACCUMULATE,typename COMBINE>
+VALUE tPArrayT<BASECLASS,TYPE>::ParallelReduce(tThreadPool& pool,const VALUE& identity,ACCUMULATE accumulate,
+ COMBINE combine) const
+{
+	Invariant();
+	const _tChunks chunks=MakeChunks(0,m_NumConstructed,pool.NumThreads());
+	if(!chunks.Count)
+	{
+		return identity;
+	}
+	std::vector<VALUE> totals(chunks.Count,identity);
+	_tReduceJob<VALUE,ACCUMULATE> job=
+	{
+		*this,
+		chunks,
+		identity,
+		accumulate,
+		&totals[0],
+	};
+	pool.Run(chunks.Count,&_tReduceJob<VALUE,ACCUMULATE>::RunChunk,&job);
+	// Combined in the same order every time so that the result doesn't depend on which thread ran which chunk
+	VALUE total=totals[0];
+	for(int32_t i=1;i<chunks.Count;++i)
+	{
+		total=combine(total,totals[i]);
+	}
+	return total;
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename ARGS>
+void tPArrayT<BASECLASS,TYPE>::_tConstructJob<ARGS>::RunChunk(void* const context,const int32_t chunk)
+{
+	_tConstructJob& job=*static_cast<_tConstructJob*>(context);
+	int32_t begin;
+	int32_t end;
+	job.Chunks.Chunk(chunk,begin,end);
+	int32_t index=begin;
+	try
+	{
+		for(;index<end;++index)
+		{
+			job.Args.Construct(&(job.Array.ElementAt_NoCheck(index)));
+		}
+	}
+	catch(...)
+	{
+		// The exception can't be passed to the thread running the job. It is recorded by the chunk having fewer
+		//  elements constructed, and the construction is repeated on the thread running the job
+	}
+	job.NumConstructed[chunk]=index-begin;
+}
+
+template<typename BASECLASS,typename TYPE>
+void tPArrayT<BASECLASS,TYPE>::ParallelConstruct(tThreadPool& pool,const int32_t count)
+{
+	_ParallelEmplace(pool,count,tEmplaceArgsT<TYPE>());
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename ARGS>
+void tPArrayT<BASECLASS,TYPE>::ParallelConstruct(tThreadPool& pool,const int32_t count,const ARGS& args)
+{
+	_ParallelEmplace(pool,count,tEmplaceArgsT<TYPE,ARGS>(args));
+}
+
+template<typename BASECLASS,typename TYPE>
+template<typename ARGS>
+void tPArrayT<BASECLASS,TYPE>::_ParallelEmplace(tThreadPool& pool,const int32_t count,const ARGS& args)
+{
+	Invariant();
+	_ASSERTE(!IsAppendingConcurrently());
+	_ASSERTE(count>=0);
+	_ASSERTE(count<=m_NumElements-m_NumConstructed);
+	const _tChunks chunks=MakeChunks(m_NumConstructed,m_NumConstructed+count,pool.NumThreads());
+	if(!chunks.Count)
+	{
+		return;
+	}
+	std::vector<int32_t> numconstructed(chunks.Count,0);
+	_tConstructJob<ARGS> job=
+	{
+		*this,
+		chunks,
+		args,
+		&numconstructed[0],
+	};
+	pool.Run(chunks.Count,&_tConstructJob<ARGS>::RunChunk,&job);
+	// Publish the elements up to the first which wasn't constructed, as a sequential loop would have got that far
+	int32_t numpublished=m_NumConstructed;
+	int32_t chunk=0;
+	for(;chunk<chunks.Count;++chunk)
+	{
+		int32_t begin;
+		int32_t end;
+		chunks.Chunk(chunk,begin,end);
+		numpublished+=numconstructed[chunk];
+		if(numconstructed[chunk]!=end-begin)
+		{
+			break;
+		}
+	}
+	if(chunk!=chunks.Count)
+	{
+		// A constructor threw. Destroy what was constructed after it
+		for(int32_t laterchunk=chunk+1;laterchunk<chunks.Count;++laterchunk)
+		{
+			int32_t begin;
+			int32_t end;
+			chunks.Chunk(laterchunk,begin,end);
+			for(int32_t index=begin;index<begin+numconstructed[laterchunk];++index)
+			{
+				ElementAt_NoCheck(index).~TYPE();
+			}
+		}
+		// Carry on from where it threw on this thread, which passes the exception on if it throws again
+		m_NumConstructed=numpublished;
+		Invariant();
+		while(m_NumConstructed<chunks.End)
+		{
+			_Emplace(args);
+		}
+		return;
+	}
+	m_NumConstructed=numpublished;
+	Invariant();
+}
+
+#ifdef _DEBUG
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::tPArrayCheckedIteratorT(void):m_PItem(NULL),m_Container(NULL)
+{
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::tPArrayCheckedIteratorT(ELEMTYPE* const pitem,
+ const CONTAINER& container):m_PItem(pitem),m_Container(&container)
+{
+	Invariant();
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::tPArrayCheckedIteratorT(
+ const tPArrayCheckedIteratorT<CONTAINER,typename CONTAINER::value_type>& rhs):m_PItem(rhs.m_PItem),
+ m_Container(rhs.m_Container)
+{
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+void tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::Invariant(void) const
+{
+	// Default constructed iterators belong to no array
+	if(m_Container)
+	{
+		m_Container->Invariant();
+		// Can't be outside the bounds of the array, other than one past the end
+		_ASSERTE(m_PItem>=&(m_Container->BeginPtr()) && m_PItem<=&(m_Container->EndPtr()));
+	}
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+void tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::CheckSameContainer(const tPArrayCheckedIteratorT& rhs) const
+{
+	_ASSERTE(rhs.m_Container==m_Container);
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+ELEMTYPE& tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator*(void) const
+{
+	_ASSERTE(m_Container);
+	// Can't be the end
+	_ASSERTE(m_PItem>=&(m_Container->BeginPtr()) && m_PItem<&(m_Container->EndPtr()));
+	return *m_PItem;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+ELEMTYPE* tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator->(void) const
+{
+	return &(operator*());
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+ELEMTYPE& tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator[](const difference_type offset) const
+{
+	return *(*this+offset);
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+typename tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::difference_type
+ tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator-(const tPArrayCheckedIteratorT& rhs) const
+{
+	CheckSameContainer(rhs);
+	return m_PItem-rhs.m_PItem;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+bool tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator==(const tPArrayCheckedIteratorT& rhs) const
+{
+	CheckSameContainer(rhs);
+	return rhs.m_PItem==m_PItem;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+bool tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator!=(const tPArrayCheckedIteratorT& rhs) const
+{
+	CheckSameContainer(rhs);
+	return rhs.m_PItem!=m_PItem;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+bool tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator<(const tPArrayCheckedIteratorT& rhs) const
+{
+	CheckSameContainer(rhs);
+	return m_PItem<rhs.m_PItem;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+bool tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator>(const tPArrayCheckedIteratorT& rhs) const
+{
+	return rhs<*this;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+bool tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator<=(const tPArrayCheckedIteratorT& rhs) const
+{
+	return !(rhs<*this);
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+bool tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator>=(const tPArrayCheckedIteratorT& rhs) const
+{
+	return !(*this<rhs);
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>& tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator++(void)
+{
+	return *this+=1;
+}
+
+// Postincrement
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE> tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator++(int)
+{
+	tPArrayCheckedIteratorT copy(*this);
+	*this+=1;
+	return copy;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>& tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator--(void)
+{
+	return *this-=1;
+}
+
+// Post decrement
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE> tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator--(int)
+{
+	tPArrayCheckedIteratorT copy(*this);
+	*this-=1;
+	return copy;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>& tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator+=(
+ const difference_type offset)
+{
+	_ASSERTE(m_Container);
+	m_PItem+=offset;
+	Invariant();
+	return *this;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>& tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator-=(
+ const difference_type offset)
+{
+	return *this+=-offset;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE> tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator+(
+ const difference_type offset) const
+{
+	tPArrayCheckedIteratorT moved(*this);
+	moved+=offset;
+	return moved;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE> tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>::operator-(
+ const difference_type offset) const
+{
+	tPArrayCheckedIteratorT moved(*this);
+	moved-=offset;
+	return moved;
+}
+
+template<typename CONTAINER,typename ELEMTYPE>
+tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE> operator+(const ptrdiff_t offset,
+ const tPArrayCheckedIteratorT<CONTAINER,ELEMTYPE>& iterator)
+{
+	return iterator+offset;
+}
+#endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "IUnitTest.h"
 #include "BlockAllocator.h"
 #include "Refcount.h"
+#include <vector>
+#include <algorithm>
 
 class tPArray_UnitTest : public IUnitTest
 {
@@ -12,10 +14,60 @@ class tPArray_UnitTest : public IUnitTest
 		eTestFirst=0,
 		//
 		eCreateAndConstructAndIterate=0,
+		eEmplace,
+		eParallelForEach,
+		eParallelReduce,
+		eParallelConstruct,
+		eParallelConstructThrows,
+		eConcurrentAppend,
+		eConstructN,
+		eAppendRange,
+		eFill,
+		eRandomAccess,
 		//
 		TestCount,
 	};
 	bool CreateAndConstructAndIterate(void);
+	bool Emplace(void);
+	bool ParallelForEach(void);
+	bool ParallelReduce(void);
+	bool ParallelConstruct(void);
+	bool ParallelConstructThrows(void);
+	struct _tAppended
+	{
+		tRefCount* m_RefCounter;
+		int32_t m_ThreadNum;
+		int32_t m_Seq;
+		int32_t m_Check;																		// Set last, from the other fields
+		_tAppended(
+		 tRefCount* const refcounter,
+		 const int32_t threadnum,
+		 const int32_t seq);																	// Throws _tAppendThrown if 'seq' is
+																									//  negative
+		~_tAppended(void);
+	};
+	struct _tAppendThrown
+	{
+	};
+	typedef tPArrayT<tBlockAllocatorRefCounter,_tAppended> _tAppendArray;
+	enum
+	{
+		eNumAppendThreads=4,
+		eNumAppendsPerThread=20000,
+	};
+	struct _tAppendThreadArgs
+	{
+		_tAppendArray* Array;
+		tRefCount* RefCounter;
+		int32_t ThreadNum;
+		int32_t NumAppended;
+	};
+	static DWORD WINAPI AppendElements(LPVOID param);
+	bool ConcurrentAppend(void);
+	bool ConstructN(void);
+	bool AppendRange(void);
+	bool Fill(void);
+	bool RandomAccess(void);
 public:
 	unsigned short GetFirstTest(void) const override
 	{
@@ -47,6 +99,36 @@ inline void tPArray_UnitTest::GetTestName(const unsigned short testnum,
 	case eCreateAndConstructAndIterate:
 		wcscpy_s(testname,testnamecount,L"CreateAndConstructAndIterate");
 		break;
+	case eEmplace:
+		wcscpy_s(testname,testnamecount,L"Emplace");
+		break;
+	case eParallelForEach:
+		wcscpy_s(testname,testnamecount,L"ParallelForEach");
+		break;
+	case eParallelReduce:
+		wcscpy_s(testname,testnamecount,L"ParallelReduce");
+		break;
+	case eParallelConstruct:
+		wcscpy_s(testname,testnamecount,L"ParallelConstruct");
+		break;
+	case eParallelConstructThrows:
+		wcscpy_s(testname,testnamecount,L"ParallelConstructThrows");
+		break;
+	case eConcurrentAppend:
+		wcscpy_s(testname,testnamecount,L"ConcurrentAppend");
+		break;
+	case eConstructN:
+		wcscpy_s(testname,testnamecount,L"ConstructN");
+		break;
+	case eAppendRange:
+		wcscpy_s(testname,testnamecount,L"AppendRange");
+		break;
+	case eFill:
+		wcscpy_s(testname,testnamecount,L"Fill");
+		break;
+	case eRandomAccess:
+		wcscpy_s(testname,testnamecount,L"RandomAccess");
+		break;
 	}
 }
 
@@ -62,6 +144,48 @@ inline void tPArray_UnitTest::GetTestDescription(const unsigned short testnum,
 		wcscpy_s(descr,descrcount,
 		 L"Create an array, construct some items and then iterate");
 		break;
+	case eEmplace:
+		wcscpy_s(descr,descrcount,
+		 L"Construct items in place from their constructor arguments");
+		break;
+	case eParallelForEach:
+		wcscpy_s(descr,descrcount,
+		 L"Visit every constructed item from a thread pool and confirm each was visited once");
+		break;
+	case eParallelReduce:
+		wcscpy_s(descr,descrcount,
+		 L"Sum the items from a thread pool and compare with the sum worked out sequentially");
+		break;
+	case eParallelConstruct:
+		wcscpy_s(descr,descrcount,
+		 L"Construct items from a thread pool after some constructed sequentially");
+		break;
+	case eParallelConstructThrows:
+		wcscpy_s(descr,descrcount,
+		 L"Throw from the constructor of one item constructed from a thread pool and confirm the array is left as a "
+		 L"sequential loop would have left it");
+		break;
+	case eConcurrentAppend:
+		wcscpy_s(descr,descrcount,
+		 L"Append items from several threads at once until the array is full, whilst reading the items published so "
+		 L"far. Then throw from one item's constructor and confirm the items appended after it aren't held up");
+		break;
+	case eConstructN:
+		wcscpy_s(descr,descrcount,
+		 L"Construct many items at once, including where one of the constructors throws");
+		break;
+	case eAppendRange:
+		wcscpy_s(descr,descrcount,
+		 L"Append copies of items from pointer and iterator ranges, of types which can and can't be memcpy'd");
+		break;
+	case eFill:
+		wcscpy_s(descr,descrcount,
+		 L"Append many copies of a value, of types which can and can't be memset or memcpy'd");
+		break;
+	case eRandomAccess:
+		wcscpy_s(descr,descrcount,
+		 L"Sort and search an array with the standard algorithms, and read it through const iterators and a span");
+		break;
 	}
 }
 
@@ -148,6 +272,641 @@ inline bool tPArray_UnitTest::CreateAndConstructAndIterate()
 	return true;
 }
 
+inline bool tPArray_UnitTest::Emplace()
+{
+	struct _tPoint
+	{
+		int32_t m_X;
+		int32_t m_Y;
+		_tPoint(void):m_X(-1),m_Y(-1) {}
+		_tPoint(
+		 const int32_t x,
+		 const int32_t y):m_X(x),m_Y(y) {}
+	};
+
+	const int32_t maxelements=200;
+	tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tPoint));
+	tPArrayT<tBlockAllocatorRefCounter,_tPoint>& thearray=
+	 PMakeArrayT<tBlockAllocatorRefCounter,_tPoint>(allocator,maxelements);
+	thearray.Emplace();
+	for(int32_t i=1;i<maxelements;++i)
+	{
+		const _tPoint& point=thearray.Emplace(i,i*2);
+		UNITTEST_ASSERT(&point==&thearray[i]);
+	}
+	UNITTEST_ASSERT(thearray.Size()==maxelements);
+	UNITTEST_ASSERT(thearray[0].m_X==-1 && thearray[0].m_Y==-1);
+	for(int32_t i=1;i<maxelements;++i)
+	{
+		UNITTEST_ASSERT(thearray[i].m_X==i && thearray[i].m_Y==i*2);
+	}
+	return true;
+}
+
+inline bool tPArray_UnitTest::ParallelForEach()
+{
+	struct _tItem
+	{
+		int32_t m_Value;
+		volatile long m_NumVisits;
+		_tItem(const int32_t value):m_Value(value),m_NumVisits(0) {}
+	};
+	struct _tDouble
+	{
+		void operator()(_tItem& item) const
+		{
+			item.m_Value*=2;
+			InterlockedIncrement(&item.m_NumVisits);
+		}
+	};
+
+	const int32_t maxelements=100000;
+	tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tItem));
+	tPArrayT<tBlockAllocatorRefCounter,_tItem>& thearray=
+	 PMakeArrayT<tBlockAllocatorRefCounter,_tItem>(allocator,maxelements);
+	tThreadPool pool(3);
+	// Nothing to visit
+	thearray.ParallelForEach(pool,_tDouble());
+	for(int32_t i=0;i<maxelements;++i)
+	{
+		thearray.Emplace(i);
+	}
+	thearray.ParallelForEach(pool,_tDouble());
+	for(int32_t i=0;i<maxelements;++i)
+	{
+		UNITTEST_ASSERT(thearray[i].m_NumVisits==1);
+		UNITTEST_ASSERT(thearray[i].m_Value==i*2);
+	}
+	return true;
+}
+
+inline bool tPArray_UnitTest::ParallelReduce()
+{
+	// 12 bytes, which doesn't divide a cache line, so each chunk is several cache lines with elements straddling them
+	struct _tElement
+	{
+		int32_t m_Values[3];
+		_tElement(const int32_t value)
+		{
+			for(int i=0;i<_countof(m_Values);++i)
+			{
+				m_Values[i]=value;
+			}
+		}
+	};
+	struct _tSum
+	{
+		int64_t operator()(const int64_t total,const _tElement& element) const
+		{
+			return total+element.m_Values[0]+element.m_Values[2];
+		}
+		int64_t operator()(const int64_t lhs,const int64_t rhs) const
+		{
+			return lhs+rhs;
+		}
+	};
+
+	const int32_t maxelements=100001;
+	tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tElement));
+	tPArrayT<tBlockAllocatorRefCounter,_tElement>& thearray=
+	 PMakeArrayT<tBlockAllocatorRefCounter,_tElement>(allocator,maxelements);
+	tThreadPool pool(3);
+	UNITTEST_ASSERT(thearray.ParallelReduce(pool,static_cast<int64_t>(7),_tSum(),_tSum())==7);
+	int64_t expected=0;
+	for(int32_t i=0;i<maxelements;++i)
+	{
+		thearray.Emplace(i*3);
+		expected+=i*3*2;
+	}
+	UNITTEST_ASSERT(thearray.ParallelReduce(pool,static_cast<int64_t>(0),_tSum(),_tSum())==expected);
+	return true;
+}
+
+inline bool tPArray_UnitTest::ParallelConstruct()
+{
+	struct _tStruct
+	{
+		tRefCount& m_RefCounter;
+		int32_t m_Values[3];
+		struct tCtorArgs
+		{
+			tRefCount& RefCounter;
+			int32_t Value;
+		};
+		_tStruct(const tCtorArgs& args):m_RefCounter(args.RefCounter)
+		{
+			for(int i=0;i<_countof(m_Values);++i)
+			{
+				m_Values[i]=args.Value;
+			}
+			m_RefCounter.AddRef();
+		}
+		~_tStruct(void)
+		{
+			m_RefCounter.Release();
+		}
+	};
+
+	tRefCount refcounter;
+	{
+		const int32_t maxelements=50000;
+		tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tStruct));
+		tPArrayT<tBlockAllocatorRefCounter,_tStruct>& thearray=
+		 PMakeArrayT<tBlockAllocatorRefCounter,_tStruct>(allocator,maxelements);
+		tThreadPool pool(3);
+		// Some constructed sequentially first so the parallel elements don't start on a cache line
+		const _tStruct::tCtorArgs firstargs=
+		{
+			refcounter,
+			1,
+		};
+		for(int32_t i=0;i<5;++i)
+		{
+			thearray.Construct(firstargs);
+		}
+		const _tStruct::tCtorArgs args=
+		{
+			refcounter,
+			2,
+		};
+		thearray.ParallelConstruct(pool,maxelements-10,args);
+		UNITTEST_ASSERT(thearray.Size()==maxelements-5);
+		UNITTEST_ASSERT(refcounter.Count()==maxelements-5);
+		for(int32_t i=0;i<thearray.Size();++i)
+		{
+			const int32_t expected=(i<5)?1:2;
+			for(int valueidx=0;valueidx<_countof(thearray[i].m_Values);++valueidx)
+			{
+				UNITTEST_ASSERT(thearray[i].m_Values[valueidx]==expected);
+			}
+		}
+		// Nothing to construct
+		thearray.ParallelConstruct(pool,0,args);
+		UNITTEST_ASSERT(thearray.Size()==maxelements-5);
+		// The rest, until the array is full
+		thearray.ParallelConstruct(pool,5,args);
+		UNITTEST_ASSERT(thearray.Size()==maxelements);
+		UNITTEST_ASSERT(refcounter.Count()==maxelements);
+	}
+	// Confirm all structs were destroyed
+	UNITTEST_ASSERT(refcounter.Count()==0);
+	return true;
+}
+
+inline bool tPArray_UnitTest::ParallelConstructThrows()
+{
+	struct _tThrown
+	{
+	};
+	struct _tStruct
+	{
+		tRefCount& m_RefCounter;
+		struct tCtorArgs
+		{
+			tRefCount& RefCounter;
+			const _tStruct* Elements;														// The first element of the array
+			int32_t ThrowIndex;																// The index of the element which throws
+		};
+		_tStruct(const tCtorArgs& args):m_RefCounter(args.RefCounter)
+		{
+			if(this-args.Elements==args.ThrowIndex)
+			{
+				throw _tThrown();
+			}
+			m_RefCounter.AddRef();
+		}
+		~_tStruct(void)
+		{
+			m_RefCounter.Release();
+		}
+	};
+
+	tRefCount refcounter;
+	{
+		const int32_t maxelements=20000;
+		const int32_t throwindex=12345;
+		tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tStruct));
+		tPArrayT<tBlockAllocatorRefCounter,_tStruct>& thearray=
+		 PMakeArrayT<tBlockAllocatorRefCounter,_tStruct>(allocator,maxelements);
+		tThreadPool pool(3);
+		const _tStruct::tCtorArgs args=
+		{
+			refcounter,
+			&thearray.ElementAt_NoCheck(0),
+			throwindex,
+		};
+		bool threw=false;
+		try
+		{
+			thearray.ParallelConstruct(pool,maxelements,args);
+		}
+		catch(const _tThrown&)
+		{
+			threw=true;
+		}
+		UNITTEST_ASSERT(threw);
+		// Everything before the element which threw is constructed, and everything after it was destroyed
+		UNITTEST_ASSERT(thearray.Size()==throwindex);
+		UNITTEST_ASSERT(refcounter.Count()==throwindex);
+	}
+	UNITTEST_ASSERT(refcounter.Count()==0);
+	return true;
+}
+
+inline tPArray_UnitTest::_tAppended::_tAppended(tRefCount* const refcounter,const int32_t threadnum,
+ const int32_t seq):m_RefCounter(refcounter),m_ThreadNum(threadnum),m_Seq(seq)
+{
+	if(m_Seq<0)
+	{
+		throw _tAppendThrown();
+	}
+	m_RefCounter->AddRef();
+	m_Check=(m_ThreadNum*eNumAppendsPerThread)+m_Seq;
+}
+
+inline tPArray_UnitTest::_tAppended::~_tAppended(void)
+{
+	m_RefCounter->Release();
+}
+
+inline DWORD WINAPI tPArray_UnitTest::AppendElements(LPVOID param)
+{
+	_tAppendThreadArgs& args=*static_cast<_tAppendThreadArgs*>(param);
+	args.NumAppended=0;
+	for(int32_t seq=0;seq<eNumAppendsPerThread;++seq)
+	{
+		if(args.Array->EmplaceConcurrent(args.RefCounter,args.ThreadNum,seq))
+		{
+			++args.NumAppended;
+		}
+	}
+	return 0;
+}
+
+inline bool tPArray_UnitTest::ConcurrentAppend()
+{
+	tRefCount refcounter;
+	{
+		// Too small for every append, so the threads also race for the last slots
+		const int32_t maxelements=(eNumAppendThreads*eNumAppendsPerThread)-1000;
+		tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tAppended));
+		_tAppendArray& thearray=PMakeArrayT<tBlockAllocatorRefCounter,_tAppended>(allocator,maxelements);
+		thearray.BeginConcurrentAppend();
+		UNITTEST_ASSERT(thearray.IsAppendingConcurrently());
+		_tAppendThreadArgs args[eNumAppendThreads];
+		HANDLE threads[eNumAppendThreads];
+		for(int i=0;i<eNumAppendThreads;++i)
+		{
+			args[i].Array=&thearray;
+			args[i].RefCounter=&refcounter;
+			args[i].ThreadNum=i;
+			threads[i]=CreateThread(NULL,0,&AppendElements,&args[i],0,NULL);
+			UNITTEST_ASSERT(threads[i]);
+		}
+		// Every published element must be whole whilst the threads are still appending
+		for(int32_t numread=0;numread<maxelements;)
+		{
+			const int32_t size=thearray.Size();
+			for(;numread<size;++numread)
+			{
+				const _tAppended& appended=thearray[numread];
+				UNITTEST_ASSERT(appended.m_Check==(appended.m_ThreadNum*eNumAppendsPerThread)+appended.m_Seq);
+			}
+		}
+		for(int i=0;i<eNumAppendThreads;++i)
+		{
+			WaitForSingleObject(threads[i],INFINITE);
+			CloseHandle(threads[i]);
+		}
+		thearray.EndConcurrentAppend();
+		UNITTEST_ASSERT(!thearray.IsAppendingConcurrently());
+		int32_t numappended=0;
+		for(int i=0;i<eNumAppendThreads;++i)
+		{
+			numappended+=args[i].NumAppended;
+		}
+		UNITTEST_ASSERT(numappended==maxelements);
+		UNITTEST_ASSERT(thearray.Size()==maxelements);
+		UNITTEST_ASSERT(refcounter.Count()==maxelements);
+		// Each thread's elements are in the order it appended them, with none missing
+		int32_t nextseq[eNumAppendThreads]={0};
+		for(_tAppendArray::iterator i=thearray.begin();i!=thearray.end();++i)
+		{
+			const _tAppended& appended=*i;
+			UNITTEST_ASSERT(appended.m_Seq==nextseq[appended.m_ThreadNum]);
+			++nextseq[appended.m_ThreadNum];
+		}
+		for(int i=0;i<eNumAppendThreads;++i)
+		{
+			UNITTEST_ASSERT(nextseq[i]==args[i].NumAppended);
+		}
+		// Append from a single thread as well once cleared
+		thearray.Clear();
+		UNITTEST_ASSERT(refcounter.Count()==0);
+		thearray.BeginConcurrentAppend();
+		const _tAppended* const appended=thearray.EmplaceConcurrent(&refcounter,0,0);
+		UNITTEST_ASSERT(appended==&thearray[0]);
+		thearray.EndConcurrentAppend();
+		UNITTEST_ASSERT(thearray.Size()==1);
+		// A constructor which throws doesn't hold up the appends after it, but they can't be published and are
+		//  destroyed by EndConcurrentAppend
+		thearray.BeginConcurrentAppend();
+		bool threw=false;
+		try
+		{
+			thearray.EmplaceConcurrent(&refcounter,0,-1);
+		}
+		catch(const _tAppendThrown&)
+		{
+			threw=true;
+		}
+		UNITTEST_ASSERT(threw);
+		const _tAppended* const unpublished1=thearray.EmplaceConcurrent(&refcounter,0,1);
+		const _tAppended* const unpublished2=thearray.EmplaceConcurrent(&refcounter,0,2);
+		UNITTEST_ASSERT(unpublished1 && unpublished2);
+		UNITTEST_ASSERT(thearray.Size()==1);
+		UNITTEST_ASSERT(refcounter.Count()==3);
+		thearray.EndConcurrentAppend();
+		UNITTEST_ASSERT(thearray.Size()==1);
+		UNITTEST_ASSERT(refcounter.Count()==1);
+		// Appending again after the unpublished elements are destroyed starts after the published ones
+		thearray.BeginConcurrentAppend();
+		const _tAppended* const published=thearray.EmplaceConcurrent(&refcounter,0,3);
+		UNITTEST_ASSERT(published==&thearray[1]);
+		thearray.EndConcurrentAppend();
+		UNITTEST_ASSERT(thearray.Size()==2);
+	}
+	// Confirm every element constructed was destroyed
+	UNITTEST_ASSERT(refcounter.Count()==0);
+	return true;
+}
+
+inline bool tPArray_UnitTest::ConstructN()
+{
+	struct _tThrown
+	{
+	};
+	struct _tStruct
+	{
+		tRefCount& m_RefCounter;
+		struct tCtorArgs
+		{
+			tRefCount& RefCounter;
+			int32_t ThrowCount;																// Throw once this many are alive
+		};
+		_tStruct(const tCtorArgs& args):m_RefCounter(args.RefCounter)
+		{
+			if(m_RefCounter.Count()==args.ThrowCount)
+			{
+				throw _tThrown();
+			}
+			m_RefCounter.AddRef();
+		}
+		~_tStruct(void)
+		{
+			m_RefCounter.Release();
+		}
+	};
+
+	tRefCount refcounter;
+	{
+		const int32_t maxelements=1000;
+		tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tStruct));
+		tPArrayT<tBlockAllocatorRefCounter,_tStruct>& thearray=
+		 PMakeArrayT<tBlockAllocatorRefCounter,_tStruct>(allocator,maxelements);
+		const _tStruct::tCtorArgs args=
+		{
+			refcounter,
+			-1,
+		};
+		thearray.ConstructN(0,args);
+		UNITTEST_ASSERT(thearray.Size()==0);
+		thearray.ConstructN(400,args);
+		UNITTEST_ASSERT(thearray.Size()==400);
+		UNITTEST_ASSERT(refcounter.Count()==400);
+		// The elements before the one which throws are kept
+		const _tStruct::tCtorArgs throwargs=
+		{
+			refcounter,
+			700,
+		};
+		bool threw=false;
+		try
+		{
+			thearray.ConstructN(maxelements-400,throwargs);
+		}
+		catch(const _tThrown&)
+		{
+			threw=true;
+		}
+		UNITTEST_ASSERT(threw);
+		UNITTEST_ASSERT(thearray.Size()==700);
+		UNITTEST_ASSERT(refcounter.Count()==700);
+		thearray.ConstructN(maxelements-700,args);
+		UNITTEST_ASSERT(thearray.Size()==maxelements);
+		// Without tCtorArgs
+		tPArrayT<tBlockAllocatorRefCounter,int32_t>& ints=
+		 PMakeArrayT<tBlockAllocatorRefCounter,int32_t>(allocator,10);
+		ints.ConstructN(10);
+		UNITTEST_ASSERT(ints.Size()==10);
+	}
+	UNITTEST_ASSERT(refcounter.Count()==0);
+	return true;
+}
+
+inline bool tPArray_UnitTest::AppendRange()
+{
+	// Trivially copyable but not a POD
+	struct _tPoint
+	{
+		int32_t m_X;
+		int32_t m_Y;
+		int32_t m_Z;
+		_tPoint(void):m_X(0),m_Y(0),m_Z(0) {}
+		_tPoint(
+		 const int32_t x,
+		 const int32_t y):m_X(x),m_Y(y),m_Z(x+y) {}
+	};
+	struct _tCounted
+	{
+		tRefCount& m_RefCounter;
+		int32_t m_Value;
+		_tCounted(
+		 tRefCount* const refcounter,
+		 const int32_t value):m_RefCounter(*refcounter),m_Value(value)
+		{
+			m_RefCounter.AddRef();
+		}
+		_tCounted(const _tCounted& rhs):m_RefCounter(rhs.m_RefCounter),m_Value(rhs.m_Value)
+		{
+			m_RefCounter.AddRef();
+		}
+		~_tCounted(void)
+		{
+			m_RefCounter.Release();
+		}
+	};
+
+	const int32_t numpoints=10000;
+	_tPoint* const points=new _tPoint[numpoints];
+	for(int32_t i=0;i<numpoints;++i)
+	{
+		points[i]=_tPoint(i,i*2);
+	}
+	tRefCount refcounter;
+	{
+		tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((numpoints+10)*(sizeof(_tPoint)+sizeof(_tCounted)));
+		// From pointers, which is copied with memcpy
+		tPArrayT<tBlockAllocatorRefCounter,_tPoint>& pointarray=
+		 PMakeArrayT<tBlockAllocatorRefCounter,_tPoint>(allocator,numpoints*2);
+		pointarray.AppendRange(points,points);
+		UNITTEST_ASSERT(pointarray.Size()==0);
+		pointarray.AppendRange(points,points+numpoints);
+		const _tPoint* const constpoints=points;
+		pointarray.AppendRange(constpoints,constpoints+numpoints);
+		UNITTEST_ASSERT(pointarray.Size()==numpoints*2);
+		for(int32_t i=0;i<numpoints*2;++i)
+		{
+			const _tPoint& point=pointarray[i];
+			const int32_t expected=i%numpoints;
+			UNITTEST_ASSERT(point.m_X==expected && point.m_Y==expected*2 && point.m_Z==expected*3);
+		}
+		// From iterators
+		std::vector<_tPoint> pointvector(points,points+100);
+		tPArrayT<tBlockAllocatorRefCounter,_tPoint>& fromvector=
+		 PMakeArrayT<tBlockAllocatorRefCounter,_tPoint>(allocator,100);
+		fromvector.AppendRange(pointvector.begin(),pointvector.end());
+		UNITTEST_ASSERT(fromvector.Size()==100);
+		for(int32_t i=0;i<100;++i)
+		{
+			UNITTEST_ASSERT(fromvector[i].m_X==i && fromvector[i].m_Z==i*3);
+		}
+		// A type which has to be copy constructed
+		std::vector<_tCounted> counted;
+		for(int32_t i=0;i<100;++i)
+		{
+			counted.push_back(_tCounted(&refcounter,i));
+		}
+		tPArrayT<tBlockAllocatorRefCounter,_tCounted>& countedarray=
+		 PMakeArrayT<tBlockAllocatorRefCounter,_tCounted>(allocator,100);
+		countedarray.AppendRange(&counted[0],&counted[0]+counted.size());
+		UNITTEST_ASSERT(countedarray.Size()==100);
+		UNITTEST_ASSERT(refcounter.Count()==200);
+		for(int32_t i=0;i<100;++i)
+		{
+			UNITTEST_ASSERT(countedarray[i].m_Value==i);
+		}
+	}
+	delete[] points;
+	UNITTEST_ASSERT(refcounter.Count()==0);
+	return true;
+}
+
+inline bool tPArray_UnitTest::Fill()
+{
+	struct _tCounted
+	{
+		tRefCount& m_RefCounter;
+		int32_t m_Value;
+		_tCounted(
+		 tRefCount* const refcounter,
+		 const int32_t value):m_RefCounter(*refcounter),m_Value(value)
+		{
+			m_RefCounter.AddRef();
+		}
+		_tCounted(const _tCounted& rhs):m_RefCounter(rhs.m_RefCounter),m_Value(rhs.m_Value)
+		{
+			m_RefCounter.AddRef();
+		}
+		~_tCounted(void)
+		{
+			m_RefCounter.Release();
+		}
+	};
+
+	tRefCount refcounter;
+	{
+		const int32_t maxelements=1001;
+		tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(_tCounted)*3);
+		tPArrayT<tBlockAllocatorRefCounter,int32_t>& ints=
+		 PMakeArrayT<tBlockAllocatorRefCounter,int32_t>(allocator,maxelements);
+		// Every byte the same, which is set with memset
+		ints.Fill(10,0);
+		// Bytes which differ, copied by doubling the elements filled. The odd count cuts the last copy short
+		ints.Fill(maxelements-11,0x01020304);
+		ints.Fill(0,7);
+		ints.Fill(1,-1);
+		UNITTEST_ASSERT(ints.Size()==maxelements);
+		for(int32_t i=0;i<maxelements;++i)
+		{
+			const int32_t expected=(i<10)?0:((i==maxelements-1)?-1:0x01020304);
+			UNITTEST_ASSERT(ints[i]==expected);
+		}
+		// A type which has to be copy constructed
+		tPArrayT<tBlockAllocatorRefCounter,_tCounted>& counted=
+		 PMakeArrayT<tBlockAllocatorRefCounter,_tCounted>(allocator,maxelements);
+		counted.Fill(maxelements,_tCounted(&refcounter,5));
+		UNITTEST_ASSERT(counted.Size()==maxelements);
+		UNITTEST_ASSERT(refcounter.Count()==maxelements);
+		for(int32_t i=0;i<maxelements;++i)
+		{
+			UNITTEST_ASSERT(counted[i].m_Value==5);
+		}
+		counted.Clear();
+		UNITTEST_ASSERT(refcounter.Count()==0);
+	}
+	return true;
+}
+
+inline bool tPArray_UnitTest::RandomAccess()
+{
+	typedef tPArrayT<tBlockAllocatorRefCounter,int32_t> _tIntArray;
+	const int32_t maxelements=1000;
+	tBlockAllocatorT<tBlockAllocatorRefCounter> allocator((maxelements+10)*sizeof(int32_t));
+	_tIntArray& thearray=PMakeArrayT<tBlockAllocatorRefCounter,int32_t>(allocator,maxelements);
+	// Multiples of 3, scrambled
+	for(int32_t i=0;i<maxelements;++i)
+	{
+		thearray.Emplace(((i*7)%maxelements)*3);
+	}
+	std::sort(thearray.begin(),thearray.end());
+	for(int32_t i=0;i<maxelements;++i)
+	{
+		UNITTEST_ASSERT(thearray[i]==i*3);
+	}
+	const _tIntArray::iterator begin=thearray.begin();
+	const _tIntArray::iterator end=thearray.end();
+	UNITTEST_ASSERT(end-begin==maxelements);
+	UNITTEST_ASSERT(begin[10]==30);
+	UNITTEST_ASSERT(*(begin+10)==30 && *(10+begin)==30 && *(end-1)==(maxelements-1)*3);
+	UNITTEST_ASSERT(begin<end && end>begin && begin<=begin && begin>=begin);
+	_tIntArray::iterator moved=begin;
+	moved+=20;
+	moved-=5;
+	UNITTEST_ASSERT(moved-begin==15 && *moved==45);
+	UNITTEST_ASSERT(std::lower_bound(begin,end,300)-begin==100);
+	UNITTEST_ASSERT(std::lower_bound(begin,end,301)-begin==101);
+	UNITTEST_ASSERT(std::binary_search(begin,end,(maxelements-1)*3));
+	// Const access
+	const _tIntArray& constarray=thearray;
+	int64_t sum=0;
+	for(_tIntArray::const_iterator i=constarray.begin();i!=constarray.end();++i)
+	{
+		sum+=*i;
+	}
+	UNITTEST_ASSERT(sum==(static_cast<int64_t>(maxelements-1)*maxelements/2)*3);
+	const _tIntArray::const_iterator converted=moved;
+	UNITTEST_ASSERT(*converted==45);
+	UNITTEST_ASSERT(std::iterator_traits<_tIntArray::iterator>::difference_type(end-begin)==maxelements);
+	// Contiguous
+	UNITTEST_ASSERT(thearray.data()==&thearray[0] && constarray.data()==&thearray[0]);
+	const tSpanT<int32_t> span=thearray.Span();
+	UNITTEST_ASSERT(span.Data()==thearray.data() && span.Size()==maxelements);
+	const tSpanT<const int32_t> constspan=constarray.Span();
+	UNITTEST_ASSERT(constspan.Size()==maxelements && constspan[maxelements-1]==(maxelements-1)*3);
+	return true;
+}
+
 inline bool tPArray_UnitTest::DoTest(const unsigned short testnum)
 {
 	switch(testnum)
@@ -157,5 +916,25 @@ inline bool tPArray_UnitTest::DoTest(const unsigned short testnum)
 		// No return
 	case eCreateAndConstructAndIterate:
 		return CreateAndConstructAndIterate();
+	case eEmplace:
+		return Emplace();
+	case eParallelForEach:
+		return ParallelForEach();
+	case eParallelReduce:
+		return ParallelReduce();
+	case eParallelConstruct:
+		return ParallelConstruct();
+	case eParallelConstructThrows:
+		return ParallelConstructThrows();
+	case eConcurrentAppend:
+		return ConcurrentAppend();
+	case eConstructN:
+		return ConstructN();
+	case eAppendRange:
+		return AppendRange();
+	case eFill:
+		return Fill();
+	case eRandomAccess:
+		return RandomAccess();
 	}
 }
\ No newline at end of file
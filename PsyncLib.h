@@ -1,5 +1,13 @@
 #pragma once
 
+#include <intrin.h>
+
+// SSE2 is always available on x64, and on x86 when compiling with /arch:SSE2
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define PSYNC_SSE2
+#include <emmintrin.h>
+#endif
+
 // Memmove deals with overlapping memory regions safely
 
 template<typename TYPE>
@@ -8,6 +16,29 @@ void ShiftLeft(
  const uint32_t arraysize,
  const uint32_t indextomovefrom);
 
+// Searches of int32_t arrays, 4 elements at a time where SSE2 is available. The array must be readable up to the next
+//  multiple of 4 elements (see SearchArraySize) but the elements beyond 'arraysize' are ignored.
+int32_t FirstIndexAtLeast(
+ const int32_t* const thearray,
+ const uint32_t arraysize,
+ const uint32_t startidx,
+ const int32_t value);																		// The index of the first element from
+																									//  'startidx' that is >= 'value' or -1
+int32_t SmallestIndexAtLeast(
+ const int32_t* const thearray,
+ const uint32_t arraysize,
+ const int32_t value);																		// The index of the first smallest element
+																									//  that is >= 'value' or -1. Elements must
+																									//  be less than INT32_MAX
+int32_t SmallestIndex(
+ const int32_t* const thearray,
+ const uint32_t arraysize);																// The index of the first smallest element or
+																									//  -1 if the array is empty. Elements must
+																									//  be less than INT32_MAX
+
+// The number of elements to declare an array with to search it with the above
+#define SearchArraySize(NUMELEMENTS) (((NUMELEMENTS)+3)&~3)
+
 //=====================================================================================================================
 // IMPLEMENTATION
 //=====================================================================================================================
@@ -22,4 +53,110 @@ void ShiftLeft(TYPE* thearray,const uint32_t arraysize,const uint32_t indextomov
 	TYPE* const dest=source-1;
 	const uint32_t memorysize=sizeof(TYPE)*count; 
 	memmove(dest,source,memorysize);
+}
+
+#ifdef PSYNC_SSE2
+
+inline int32_t FirstIndexAtLeast(const int32_t* const thearray,const uint32_t arraysize,const uint32_t startidx,
+ const int32_t value)
+{
+	_ASSERTE(thearray);
+	_ASSERTE(value>numeric_limits<int32_t>::min());
+	const __m128i lessone=_mm_set1_epi32(value-1);
+	// Start from the group of 4 containing 'startidx'
+	for(uint32_t idx=startidx&~3u;idx<arraysize;idx+=4)
+	{
+		const __m128i values=_mm_loadu_si128(reinterpret_cast<const __m128i*>(thearray+idx));
+		// 4 bits per element
+		int mask=_mm_movemask_epi8(_mm_cmpgt_epi32(values,lessone));
+		if(idx<startidx)
+		{
+			mask&=~((1<<((startidx-idx)*4))-1);
+		}
+		if(arraysize-idx<4)
+		{
+			mask&=(1<<((arraysize-idx)*4))-1;
+		}
+		if(mask)
+		{
+			unsigned long bit;
+			_BitScanForward(&bit,static_cast<unsigned long>(mask));
+			return static_cast<int32_t>(idx+(bit/4));
+		}
+	}
+	return -1;
+}
+
+inline int32_t SmallestIndexAtLeast(const int32_t* const thearray,const uint32_t arraysize,const int32_t value)
+{
+	_ASSERTE(thearray);
+	// The smallest value and it's index seen by each of the 4 lanes
+	__m128i smallestvalues=_mm_set1_epi32(numeric_limits<int32_t>::max());
+	__m128i smallestindexes=_mm_set1_epi32(-1);
+	const __m128i minimum=_mm_set1_epi32(value);
+	const __m128i size=_mm_set1_epi32(static_cast<int>(arraysize));
+	__m128i indexes=_mm_setr_epi32(0,1,2,3);
+	const __m128i four=_mm_set1_epi32(4);
+	for(uint32_t idx=0;idx<arraysize;idx+=4)
+	{
+		const __m128i values=_mm_loadu_si128(reinterpret_cast<const __m128i*>(thearray+idx));
+		// Strictly less so each lane keeps the first of equal values, and ignoring those beyond the end or below the
+		//  minimum
+		const __m128i less=_mm_andnot_si128(_mm_cmplt_epi32(values,minimum),
+		 _mm_and_si128(_mm_cmplt_epi32(values,smallestvalues),_mm_cmpgt_epi32(size,indexes)));
+		smallestvalues=_mm_or_si128(_mm_and_si128(less,values),_mm_andnot_si128(less,smallestvalues));
+		smallestindexes=_mm_or_si128(_mm_and_si128(less,indexes),_mm_andnot_si128(less,smallestindexes));
+		indexes=_mm_add_epi32(indexes,four);
+	}
+	DECLSPEC_ALIGN(16) int32_t lanevalues[4];
+	DECLSPEC_ALIGN(16) int32_t laneindexes[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanevalues),smallestvalues);
+	_mm_store_si128(reinterpret_cast<__m128i*>(laneindexes),smallestindexes);
+	int32_t rv=-1;
+	for(int lane=0;lane<4;++lane)
+	{
+		if(laneindexes[lane]>=0 && (rv<0 || lanevalues[lane]<thearray[rv] ||
+		 (lanevalues[lane]==thearray[rv] && laneindexes[lane]<rv)))
+		{
+			rv=laneindexes[lane];
+		}
+	}
+	return rv;
+}
+
+#else
+
+inline int32_t FirstIndexAtLeast(const int32_t* const thearray,const uint32_t arraysize,const uint32_t startidx,
+ const int32_t value)
+{
+	_ASSERTE(thearray);
+	for(uint32_t idx=startidx;idx<arraysize;++idx)
+	{
+		if(thearray[idx]>=value)
+		{
+			return static_cast<int32_t>(idx);
+		}
+	}
+	return -1;
+}
+
+inline int32_t SmallestIndexAtLeast(const int32_t* const thearray,const uint32_t arraysize,const int32_t value)
+{
+	_ASSERTE(thearray);
+	int32_t rv=-1;
+	for(uint32_t idx=0;idx<arraysize;++idx)
+	{
+		if(thearray[idx]>=value && (rv<0 || thearray[idx]<thearray[rv]))
+		{
+			rv=static_cast<int32_t>(idx);
+		}
+	}
+	return rv;
+}
+
+#endif
+
+inline int32_t SmallestIndex(const int32_t* const thearray,const uint32_t arraysize)
+{
+	return SmallestIndexAtLeast(thearray,arraysize,numeric_limits<int32_t>::min());
 }
\ No newline at end of file
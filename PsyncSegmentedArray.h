@@ -0,0 +1,631 @@
+#pragma once
+
+#include "Emplace.h"
+
+// An array which grows a segment at a time, each allocated from the same ALLOCATOR as the array. Nothing is copied
+//  when it grows so elements never move, and there is no need to reserve for the worst case as with tPArrayT. The
+//  number of elements per segment is rounded up to a power of 2 so an element is found with a shift and a mask
+//  through the segment directory, which starts inside the array and is moved to the ALLOCATOR when it's outgrown.
+// Each segment is a managed object of the ALLOCATOR which destroys the elements constructed in it, so the elements
+//  are destroyed with the memory they are in however that is reclaimed. A rewind to a checkpoint taken after the array
+//  was made destroys and reclaims any segments added since. IsReclaimed then reports it, and debug builds assert if the
+//  array is used before Clear starts it again, empty. The elements left in the older segments are destroyed with
+//  those segments.
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+class tPSegmentedArrayT : public BASECLASS
+{
+public:
+	class iterator;
+	struct tCtorArgs;
+	friend class tPSegmentedArray_UnitTest;
+//=====================================================================================================================
+// PROPERTIES
+//=====================================================================================================================
+	int32_t NumReserved(void) const;														// Elements that fit in the segments so far
+	int32_t Size(void) const;																// Number of elements constructed
+	int32_t ElementsPerSegment(void) const;
+	int32_t NumSegments(void) const;														// Segments with at least one element
+	TYPE* Segment(const int32_t segmentidx);											// The first element of this segment. The
+																									//  elements are contiguous up to
+																									//  SegmentSize
+	const TYPE* Segment(const int32_t segmentidx) const;
+	int32_t SegmentSize(const int32_t segmentidx) const;							// Elements constructed in this segment
+	bool IsReclaimed(void) const;															// A rewind has taken back the newest
+																									//  segment
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tPSegmentedArrayT(const tCtorArgs& args);
+	~tPSegmentedArrayT(void);
+	iterator begin();
+	iterator end();
+	void Reserve(const int32_t numelements);											// Add segments until there is room for this
+																									//  many elements
+	TYPE& Construct(void);																	// Construct another element, adding a
+																									//  segment if they are full
+	template<typename ARGS>
+	TYPE& Construct(const ARGS& args);													// Construct another element from it's
+																									//  tCtorArgs
+	TYPE& Emplace(void);																		// Construct another element from these
+																									//  arguments, passed straight to it's
+																									//  constructor
+	template<typename A1>
+	TYPE& Emplace(const A1& a1);
+	template<typename A1,typename A2>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2);
+	template<typename A1,typename A2,typename A3>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3);
+	template<typename A1,typename A2,typename A3,typename A4>
+	TYPE& Emplace(
+	 const A1& a1,
+	 const A2& a2,
+	 const A3& a3,
+	 const A4& a4);
+	void Clear(void);																			// Remove all the constructed elements. The
+																									//  segments are kept, unless the array
+																									//  IsReclaimed when it forgets them all
+	TYPE& operator[](const int32_t index);												// Item at this index
+	const TYPE& operator[](const int32_t index) const;
+	//~PF
+private:
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	enum
+	{
+		eNumInlineSegments=8,																// Directory entries held in the array
+	};
+	class _tSegment;
+	ALLOCATOR& m_Allocator;
+	const unsigned char m_SegmentShift;													// log2 of the elements per segment
+	int32_t m_NumConstructed;																// Number of elements constructed
+	int32_t m_NumSegmentsAdded;															// Segments allocated, including any
+																									//  reserved but empty
+	int32_t m_DirectorySize;																// Entries in 'm_Segments'
+	_tSegment** m_Segments;																	// The segment directory
+	_tSegment* m_InlineSegments[eNumInlineSegments];								// The directory until it's outgrown
+	_tSegment* m_NewestSegment;															// Also the last in the directory, held here
+																									//  as a rewind may take back the directory
+	//~V
+	tPSegmentedArrayT(const tPSegmentedArrayT&);
+	tPSegmentedArrayT& operator=(const tPSegmentedArrayT&);
+	static unsigned char SegmentShift(const int32_t elementspersegment);		// Shift for the power of 2 at least this
+	void Forget(void);																		// Start again with no segments
+	void AddSegment(void);
+	void GrowDirectory(void);																// Move the directory to somewhere twice the
+																									//  size
+	template<typename ARGS>
+	TYPE& _Emplace(const ARGS& args);													// Construct another element from these
+																									//  tEmplaceArgsT
+	void Invariant(void) const;
+	TYPE& ElementAt_NoCheck(const int32_t index);									// The element at this index without
+																									//  checking if it's constructed
+	const TYPE& ElementAt_NoCheck(const int32_t index) const;
+	//~F
+};
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+struct tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::tCtorArgs
+{
+	ALLOCATOR* Allocator;
+	int32_t ElementsPerSegment;															// Rounded up to a power of 2
+};
+
+// The elements follow on from the header in the same allocation, the first being the last member so it's aligned
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+class tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment : public BASECLASS
+{
+	typedef typename std::tr1::aligned_storage<sizeof(TYPE),
+	 std::tr1::alignment_of<TYPE>::value>::type _tMemory;
+	const tPSegmentedArrayT* m_Array;													// The owner, or NULL once destroyed
+	int32_t m_Index;																			// In the owner's directory
+	int32_t m_NumConstructed;																// Elements constructed in this segment
+	_tMemory m_FirstElement;																// The rest follow
+	//~V
+	_tSegment(const _tSegment&);
+	_tSegment& operator=(const _tSegment&);
+	//~F
+public:
+	struct tCtorArgs
+	{
+		const tPSegmentedArrayT* Array;
+		int32_t Index;
+	};
+	_tSegment(const tCtorArgs& args);
+	~_tSegment(void);
+	bool IsSegmentOf(
+	 const tPSegmentedArrayT& thearray,
+	 const int32_t index,
+	 const int32_t numconstructed) const;												// Still this array's segment at this
+																									//  index, holding this many elements
+	static int32_t AllocationSize(const int32_t numelements);					// The bytes for a segment of this many
+																									//  elements
+	TYPE* Elements(void);																	// The first element
+	const TYPE* Elements(void) const;
+	void ElementConstructed(void);														// Another element has been constructed
+																									//  after the others
+	void Clear(void);																			// Destroy the elements, newest first
+};
+
+//=====================================================================================================================
+// ARRAY CREATION FUNCTIONS
+//=====================================================================================================================
+
+// Template create a segmented array from an allocator. Segments are allocated from it as the array grows.
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>& PMakeSegmentedArrayT(
+ ALLOCATOR& allocator,
+ const int32_t elementspersegment);
+
+//=====================================================================================================================
+// ITERATOR CLASS DECLARATION
+//=====================================================================================================================
+
+// Walks each segment in turn, so moving on is a pointer increment other than at the end of a segment. Invalidated
+//  when an element is added.
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+class tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator
+{
+	const tPSegmentedArrayT* m_Container;
+	int32_t m_Index;																			// Of the element
+	TYPE* m_PItem;
+	TYPE* m_SegmentEnd;																		// The end of the element's segment
+	//~V
+	void Invariant(void) const;
+	//~F
+public:
+	iterator(void);
+	iterator(
+	 const tPSegmentedArrayT& container,
+	 const int32_t index);
+	iterator operator++(void);
+	iterator operator++(int);
+	bool operator==(const iterator& rhs) const;
+	bool operator!=(const iterator& rhs) const;
+	TYPE& operator*(void);
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>& PMakeSegmentedArrayT(ALLOCATOR& allocator,
+ const int32_t elementspersegment)
+{
+	_ASSERTE(elementspersegment>0);
+	typedef tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR> _tPSegmentedArray;
+	const typename _tPSegmentedArray::tCtorArgs args=
+	{
+		&allocator,
+		elementspersegment,
+	};
+	// The BASECLASS is used as the POLYTYPE for the allocator
+	return AllocateAndConstructPoly<BASECLASS,_tPSegmentedArray>(allocator,sizeof(_tPSegmentedArray),args);
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::tPSegmentedArrayT(const tCtorArgs& args):m_Allocator(*args.Allocator),
+ m_SegmentShift(SegmentShift(args.ElementsPerSegment)),m_NumConstructed(0),m_NumSegmentsAdded(0),
+ m_DirectorySize(eNumInlineSegments),m_Segments(m_InlineSegments),m_NewestSegment(NULL)
+{
+	Invariant();
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::~tPSegmentedArrayT(void)
+{
+	// The elements are destroyed with their segments, and the segments and directory are reclaimed with the
+	//  allocator. Nothing is destroyed here as a rewind may already have taken back some of the segments.
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+bool tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::IsReclaimed(void) const
+{
+	if(!m_NewestSegment)
+	{
+		return false;
+	}
+	// Segments are added in order, so a rewind which took back any took back the newest. It's either been destroyed
+	//  or it's memory reused, neither of which leaves it naming this array with the elements it should have.
+	const int32_t newestidx=m_NumSegmentsAdded-1;
+	const int32_t numbefore=newestidx<<m_SegmentShift;
+	const int32_t numconstructed=(m_NumConstructed>numbefore)?m_NumConstructed-numbefore:0;
+	return !(m_NewestSegment->IsSegmentOf(*this,newestidx,numconstructed));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Forget(void)
+{
+	// The segments left destroy their own elements when they are reclaimed. Nothing is freed as the directory may
+	//  have been taken back too.
+	m_NumConstructed=0;
+	m_NumSegmentsAdded=0;
+	m_DirectorySize=eNumInlineSegments;
+	m_Segments=m_InlineSegments;
+	m_NewestSegment=NULL;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+unsigned char tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::SegmentShift(const int32_t elementspersegment)
+{
+	_ASSERTE(elementspersegment>0 && elementspersegment<=(1<<30));
+	unsigned char shift=0;
+	while((1<<shift)<elementspersegment)
+	{
+		++shift;
+	}
+	return shift;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+int32_t tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::NumReserved(void) const
+{
+	return m_NumSegmentsAdded<<m_SegmentShift;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+int32_t tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Size(void) const
+{
+	_ASSERTE(!IsReclaimed());
+	return m_NumConstructed;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+int32_t tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::ElementsPerSegment(void) const
+{
+	return 1<<m_SegmentShift;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+int32_t tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::NumSegments(void) const
+{
+	return (m_NumConstructed+ElementsPerSegment()-1)>>m_SegmentShift;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+TYPE* tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Segment(const int32_t segmentidx)
+{
+	return const_cast<TYPE*>(static_cast<const tPSegmentedArrayT&>(*this).Segment(segmentidx));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+const TYPE* tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Segment(const int32_t segmentidx) const
+{
+	_ASSERTE(segmentidx>=0 && segmentidx<NumSegments());
+	return m_Segments[segmentidx]->Elements();
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+int32_t tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::SegmentSize(const int32_t segmentidx) const
+{
+	_ASSERTE(segmentidx>=0 && segmentidx<NumSegments());
+	// Only the last can be part full
+	return ((segmentidx<NumSegments()-1)?ElementsPerSegment():m_NumConstructed-(segmentidx<<m_SegmentShift));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Clear(void)
+{
+	if(IsReclaimed())
+	{
+		// Touching the segments, or even the directory, could reach memory which has been reused
+		Forget();
+	}
+	Invariant();
+	for(int32_t segmentidx=0;segmentidx<NumSegments();++segmentidx)
+	{
+		m_Segments[segmentidx]->Clear();
+	}
+	m_NumConstructed=0;
+	Invariant();
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Reserve(const int32_t numelements)
+{
+	Invariant();
+	while(NumReserved()<numelements)
+	{
+		AddSegment();
+	}
+	Invariant();
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::AddSegment(void)
+{
+	if(m_NumSegmentsAdded==m_DirectorySize)
+	{
+		GrowDirectory();
+	}
+	// The BASECLASS is used as the POLYTYPE for the allocator
+	const int32_t nbytes=_tSegment::AllocationSize(ElementsPerSegment());
+	const typename _tSegment::tCtorArgs args=
+	{
+		this,
+		m_NumSegmentsAdded,
+	};
+	m_NewestSegment=&(AllocateAndConstructPoly<BASECLASS,_tSegment>(m_Allocator,nbytes,args));
+	m_Segments[m_NumSegmentsAdded]=m_NewestSegment;
+	++m_NumSegmentsAdded;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::GrowDirectory(void)
+{
+	const int32_t newsize=m_DirectorySize*2;
+	const unsigned short alignment=static_cast<unsigned short>(alignment_of<_tSegment*>::value);
+	_tSegment** const newsegments=static_cast<_tSegment**>(
+	 m_Allocator.AllocateUnmanaged(static_cast<int32_t>(newsize*sizeof(_tSegment*)),alignment));
+	memcpy(newsegments,m_Segments,m_DirectorySize*sizeof(_tSegment*));
+	if(m_Segments!=m_InlineSegments)
+	{
+		m_Allocator.DeallocateUnmanaged(m_Segments,static_cast<int32_t>(m_DirectorySize*sizeof(_tSegment*)));
+	}
+	m_Segments=newsegments;
+	m_DirectorySize=newsize;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+typename tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::begin(void)
+{
+	return iterator(*this,0);
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+typename tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::end(void)
+{
+	return iterator(*this,m_NumConstructed);
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Invariant(void) const
+{
+#ifdef _DEBUG
+	_ASSERTE(m_SegmentShift<31);
+	_ASSERTE(m_NumConstructed>=0);
+	// Can't construct more elements than there is room for
+	_ASSERTE(m_NumConstructed<=NumReserved());
+	_ASSERTE(m_NumSegmentsAdded>=0 && m_NumSegmentsAdded<=m_DirectorySize);
+	_ASSERTE(m_DirectorySize>=eNumInlineSegments);
+	_ASSERTE((m_Segments==m_InlineSegments)==(m_DirectorySize==eNumInlineSegments));
+	_ASSERTE((m_NewestSegment!=NULL)==(m_NumSegmentsAdded>0));
+	// Must be cleared before it's used again once a rewind has taken back a segment
+	_ASSERTE(!IsReclaimed());
+	_ASSERTE(!m_NewestSegment || m_Segments[m_NumSegmentsAdded-1]==m_NewestSegment);
+#endif
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::ElementAt_NoCheck(const int32_t index)
+{
+	return const_cast<TYPE&>(static_cast<const tPSegmentedArrayT&>(*this).ElementAt_NoCheck(index));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+const TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::ElementAt_NoCheck(const int32_t index) const
+{
+	_ASSERTE(index>=0 && index<NumReserved());
+	_ASSERTE(!IsReclaimed());
+	return m_Segments[index>>m_SegmentShift]->Elements()[index&(ElementsPerSegment()-1)];
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Construct(void)
+{
+	return _Emplace(tEmplaceArgsT<TYPE>());
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+template<typename ARGS>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Construct(const ARGS& args)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,ARGS>(args));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Emplace(void)
+{
+	return _Emplace(tEmplaceArgsT<TYPE>());
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+template<typename A1>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Emplace(const A1& a1)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1>(a1));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+template<typename A1,typename A2>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Emplace(const A1& a1,const A2& a2)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1,A2>(a1,a2));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+template<typename A1,typename A2,typename A3>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Emplace(const A1& a1,const A2& a2,const A3& a3)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1,A2,A3>(a1,a2,a3));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+template<typename A1,typename A2,typename A3,typename A4>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::Emplace(const A1& a1,const A2& a2,const A3& a3,const A4& a4)
+{
+	return _Emplace(tEmplaceArgsT<TYPE,A1,A2,A3,A4>(a1,a2,a3,a4));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+template<typename ARGS>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_Emplace(const ARGS& args)
+{
+	Invariant();
+	if(m_NumConstructed==NumReserved())
+	{
+		AddSegment();
+	}
+	TYPE& item=args.Construct(&(ElementAt_NoCheck(m_NumConstructed)));
+	m_Segments[m_NumConstructed>>m_SegmentShift]->ElementConstructed();
+	++m_NumConstructed;
+	Invariant();
+	return item;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::operator[](const int32_t index)
+{
+	return const_cast<TYPE&>(static_cast<const tPSegmentedArrayT&>(*this).operator[](index));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+const TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::operator[](const int32_t index) const
+{
+	_ASSERTE(index>=0);
+	_ASSERTE(index<m_NumConstructed);
+	return ElementAt_NoCheck(index);
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::_tSegment(const tCtorArgs& args):m_Array(args.Array),
+ m_Index(args.Index),m_NumConstructed(0)
+{
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::~_tSegment(void)
+{
+	Clear();
+	m_Array=NULL;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+bool tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::IsSegmentOf(const tPSegmentedArrayT& thearray,
+ const int32_t index,const int32_t numconstructed) const
+{
+	return (m_Array==&thearray && m_Index==index && m_NumConstructed==numconstructed);
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+int32_t tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::AllocationSize(const int32_t numelements)
+{
+	_ASSERTE(numelements>0);
+	return static_cast<int32_t>(sizeof(_tSegment)+((numelements-1)*sizeof(TYPE)));
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+TYPE* tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::Elements(void)
+{
+	return reinterpret_cast<TYPE*>(&m_FirstElement);
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+const TYPE* tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::Elements(void) const
+{
+	return reinterpret_cast<const TYPE*>(&m_FirstElement);
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::ElementConstructed(void)
+{
+	++m_NumConstructed;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::_tSegment::Clear(void)
+{
+	TYPE* const elements=Elements();
+	while(m_NumConstructed)
+	{
+		elements[--m_NumConstructed].~TYPE();
+	}
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::iterator(void):m_Container(NULL),m_Index(0),m_PItem(NULL),
+ m_SegmentEnd(NULL)
+{
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::iterator(const tPSegmentedArrayT& container,
+ const int32_t index):m_Container(&container),m_Index(index),m_PItem(NULL),m_SegmentEnd(NULL)
+{
+	if(m_Index<m_Container->Size())
+	{
+		m_PItem=const_cast<TYPE*>(&(m_Container->ElementAt_NoCheck(m_Index)));
+		m_SegmentEnd=const_cast<TYPE*>(m_Container->Segment(m_Index>>m_Container->m_SegmentShift))+
+		 m_Container->ElementsPerSegment();
+	}
+	Invariant();
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+bool tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::operator==(const iterator& rhs) const
+{
+	_ASSERTE(rhs.m_Container==m_Container);
+	return rhs.m_Index==m_Index;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+bool tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::operator!=(const iterator& rhs) const
+{
+	_ASSERTE(rhs.m_Container==m_Container);
+	return rhs.m_Index!=m_Index;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+typename tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::operator++(void)
+{
+	Invariant();
+	_ASSERTE(m_Index<m_Container->Size());
+	++m_Index;
+	++m_PItem;
+	if(m_PItem==m_SegmentEnd && m_Index<m_Container->Size())
+	{
+		// On to the next segment
+		m_PItem=const_cast<TYPE*>(m_Container->Segment(m_Index>>m_Container->m_SegmentShift));
+		m_SegmentEnd=m_PItem+m_Container->ElementsPerSegment();
+	}
+	Invariant();
+	return *this;
+}
+
+// Postincrement
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+typename tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator
+tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::operator++(int)
+{
+	iterator copy(*this);
+	operator++();
+	return copy;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+TYPE& tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::operator*(void)
+{
+	// Can't be outside the bounds of the array
+	_ASSERTE(m_PItem && m_Index<m_Container->Size());
+	return *m_PItem;
+}
+
+template<typename BASECLASS,typename TYPE,typename ALLOCATOR>
+void tPSegmentedArrayT<BASECLASS,TYPE,ALLOCATOR>::iterator::Invariant(void) const
+{
+#ifdef _DEBUG
+	if(m_Container)
+	{
+		m_Container->Invariant();
+		_ASSERTE(m_Index>=0 && m_Index<=m_Container->Size());
+		_ASSERTE(m_Index==m_Container->Size() || m_PItem==&(m_Container->ElementAt_NoCheck(m_Index)));
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "PsyncSegmentedArray.h"
+#include "IUnitTest.h"
+#include "BlockAllocator.h"
+#include "RefCount.h"
+
+class tPSegmentedArray_UnitTest : public IUnitTest
+{
+	enum eTestNumber
+	{
+		eTestFirst=0,
+		//
+		eGrowWithoutMoving=0,
+		eIterateSegments,
+		eDestroyElements,
+		//
+		TestCount,
+	};
+	typedef tBlockAllocatorT<tBlockAllocatorRefCounter> _tAllocator;
+	typedef tPSegmentedArrayT<tBlockAllocatorRefCounter,int32_t,_tAllocator> _tIntArray;
+	bool GrowWithoutMoving(void);
+	bool IterateSegments(void);
+	bool DestroyElements(void);
+public:
+	unsigned short GetFirstTest(void) const override
+	{
+		return eTestFirst;
+	}
+	unsigned short GetTestCount(void) const override
+	{
+		return TestCount;
+	}
+	void GetTestName(
+	 const unsigned short testnum,
+	 const unsigned short testnamecount,
+	 WCHAR* const testname) const override;
+	void GetTestDescription(
+	 const unsigned short testnum,
+	 const unsigned short descrcount,
+	 WCHAR* const descr) const override;
+	bool DoTest(const unsigned short testnum) override;
+};
+
+inline void tPSegmentedArray_UnitTest::GetTestName(const unsigned short testnum,
+ const unsigned short testnamecount,WCHAR* const testname) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eGrowWithoutMoving:
+		wcscpy_s(testname,testnamecount,L"GrowWithoutMoving");
+		break;
+	case eIterateSegments:
+		wcscpy_s(testname,testnamecount,L"IterateSegments");
+		break;
+	case eDestroyElements:
+		wcscpy_s(testname,testnamecount,L"DestroyElements");
+		break;
+	}
+}
+
+inline void tPSegmentedArray_UnitTest::GetTestDescription(const unsigned short testnum,
+ const unsigned short descrcount,WCHAR* const descr) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eGrowWithoutMoving:
+		wcscpy_s(descr,descrcount,
+		 L"Grow well past the first segment and the inline directory, without any element moving");
+		break;
+	case eIterateSegments:
+		wcscpy_s(descr,descrcount,
+		 L"Iterate the elements and the segments, including where the last segment is exactly full");
+		break;
+	case eDestroyElements:
+		wcscpy_s(descr,descrcount,
+		 L"Every element is destroyed with the allocator, by Clear, and by a rewind which takes back it's segment. "
+		 L"The array knows when a rewind has taken back a segment and starts again once cleared");
+		break;
+	}
+}
+
+inline bool tPSegmentedArray_UnitTest::GrowWithoutMoving()
+{
+	_tAllocator allocator(1000);
+	// Rounded up to 16
+	_tIntArray& thearray=PMakeSegmentedArrayT<tBlockAllocatorRefCounter,int32_t>(allocator,10);
+	UNITTEST_ASSERT(thearray.ElementsPerSegment()==16);
+	UNITTEST_ASSERT(thearray.NumReserved()==0 && thearray.Size()==0);
+	const int32_t* const first=&(thearray.Emplace(0));
+	// Far more segments than the directory in the array holds
+	const int32_t numelements=16*_tIntArray::eNumInlineSegments*10;
+	for(int32_t i=1;i<numelements;++i)
+	{
+		thearray.Emplace(i);
+		UNITTEST_ASSERT(thearray.Size()==i+1);
+		UNITTEST_ASSERT(thearray.NumReserved()==((i+16)/16)*16);
+	}
+	UNITTEST_ASSERT(&thearray[0]==first);
+	UNITTEST_ASSERT(thearray.NumSegments()==numelements/16);
+	for(int32_t i=0;i<numelements;++i)
+	{
+		UNITTEST_ASSERT(thearray[i]==i);
+	}
+	// Reserving adds empty segments
+	thearray.Reserve(numelements+17);
+	UNITTEST_ASSERT(thearray.NumReserved()==numelements+32);
+	UNITTEST_ASSERT(thearray.NumSegments()==numelements/16);
+	return true;
+}
+
+inline bool tPSegmentedArray_UnitTest::IterateSegments()
+{
+	_tAllocator allocator(1000);
+	_tIntArray& thearray=PMakeSegmentedArrayT<tBlockAllocatorRefCounter,int32_t>(allocator,8);
+	UNITTEST_ASSERT(thearray.begin()==thearray.end());
+	for(int32_t numelements=1;numelements<=40;++numelements)
+	{
+		thearray.Emplace(numelements-1);
+		int32_t iterationindex=0;
+		for(_tIntArray::iterator i=thearray.begin();i!=thearray.end();++i)
+		{
+			UNITTEST_ASSERT(*i==iterationindex);
+			++iterationindex;
+		}
+		UNITTEST_ASSERT(iterationindex==numelements);
+		// Segment by segment
+		iterationindex=0;
+		for(int32_t segmentidx=0;segmentidx<thearray.NumSegments();++segmentidx)
+		{
+			const int32_t* const segment=thearray.Segment(segmentidx);
+			const int32_t segmentsize=thearray.SegmentSize(segmentidx);
+			for(int32_t elementidx=0;elementidx<segmentsize;++elementidx)
+			{
+				UNITTEST_ASSERT(segment[elementidx]==iterationindex);
+				++iterationindex;
+			}
+		}
+		UNITTEST_ASSERT(iterationindex==numelements);
+	}
+	return true;
+}
+
+inline bool tPSegmentedArray_UnitTest::DestroyElements()
+{
+	struct _tCounted
+	{
+		int32_t* m_NumAlive;
+		_tCounted(int32_t* const numalive):m_NumAlive(numalive)
+		{
+			++*m_NumAlive;
+		}
+		~_tCounted(void)
+		{
+			--*m_NumAlive;
+		}
+	};
+	typedef tPSegmentedArrayT<tBlockAllocatorRefCounter,_tCounted,_tAllocator> _tPSegmentedArray;
+
+	int32_t numalive=0;
+	{
+		_tAllocator allocator(1000);
+		_tPSegmentedArray& thearray=PMakeSegmentedArrayT<tBlockAllocatorRefCounter,_tCounted>(allocator,4);
+		for(int32_t i=0;i<10;++i)
+		{
+			thearray.Emplace(&numalive);
+		}
+		UNITTEST_ASSERT(numalive==10);
+		thearray.Clear();
+		UNITTEST_ASSERT(numalive==0 && thearray.Size()==0);
+		// The segments are reused
+		UNITTEST_ASSERT(thearray.NumReserved()==12);
+		for(int32_t i=0;i<50;++i)
+		{
+			thearray.Emplace(&numalive);
+		}
+		UNITTEST_ASSERT(numalive==50);
+	}
+	// Confirm all elements were destroyed with the allocator
+	UNITTEST_ASSERT(numalive==0);
+	{
+		_tAllocator allocator(1000);
+		_tPSegmentedArray& thearray=PMakeSegmentedArrayT<tBlockAllocatorRefCounter,_tCounted>(allocator,4);
+		// Fill the first segment exactly, so that every element added after the checkpoint is in a new segment
+		for(int32_t i=0;i<4;++i)
+		{
+			thearray.Emplace(&numalive);
+		}
+		const _tAllocator::tCheckpoint checkpoint=allocator.Checkpoint();
+		for(int32_t i=0;i<10;++i)
+		{
+			thearray.Emplace(&numalive);
+		}
+		UNITTEST_ASSERT(numalive==14);
+		UNITTEST_ASSERT(!thearray.IsReclaimed());
+		allocator.Rewind(checkpoint);
+		UNITTEST_ASSERT(numalive==4 && thearray.IsReclaimed());
+		// Reuse the memory of the segments taken back. The array must not destroy their elements again.
+		memset(allocator.AllocateUnmanaged(500,1),0xFF,500);
+		UNITTEST_ASSERT(thearray.IsReclaimed());
+		// Starts again without touching any segment. The first segment still holds it's elements.
+		thearray.Clear();
+		UNITTEST_ASSERT(!thearray.IsReclaimed() && thearray.Size()==0 && numalive==4);
+		thearray.Emplace(&numalive);
+		UNITTEST_ASSERT(thearray.Size()==1 && numalive==5);
+	}
+	UNITTEST_ASSERT(numalive==0);
+	return true;
+}
+
+inline bool tPSegmentedArray_UnitTest::DoTest(const unsigned short testnum)
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eGrowWithoutMoving:
+		return GrowWithoutMoving();
+	case eIterateSegments:
+		return IterateSegments();
+	case eDestroyElements:
+		return DestroyElements();
+	}
+}
\ No newline at end of file
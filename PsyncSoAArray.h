@@ -0,0 +1,485 @@
+#pragma once
+
+#include "Span.h"
+
+// An unused column of a tPSoAArrayT
+struct tNoColumn
+{
+};
+
+// The type of each column of a tPSoAArrayT, by number
+template<int COLUMN,typename C0,typename C1,typename C2,typename C3>
+struct tSoAColumnTypeT;
+
+template<typename C0,typename C1,typename C2,typename C3>
+struct tSoAColumnTypeT<0,C0,C1,C2,C3>
+{
+	typedef C0 tType;
+};
+
+template<typename C0,typename C1,typename C2,typename C3>
+struct tSoAColumnTypeT<1,C0,C1,C2,C3>
+{
+	typedef C1 tType;
+};
+
+template<typename C0,typename C1,typename C2,typename C3>
+struct tSoAColumnTypeT<2,C0,C1,C2,C3>
+{
+	typedef C2 tType;
+};
+
+template<typename C0,typename C1,typename C2,typename C3>
+struct tSoAColumnTypeT<3,C0,C1,C2,C3>
+{
+	typedef C3 tType;
+};
+
+// Construction and destruction of the elements of one column
+template<typename TYPE>
+struct tSoAColumnT
+{
+	enum
+	{
+		eElementSize=sizeof(TYPE),
+	};
+	static void Construct(
+	 char* const column,
+	 const int32_t index,
+	 const TYPE& value);
+	static void Destroy(
+	 char* const column,
+	 const int32_t count);
+	static void DestroyAt(
+	 char* const column,
+	 const int32_t index);
+};
+
+template<>
+struct tSoAColumnT<tNoColumn>
+{
+	enum
+	{
+		eElementSize=0,
+	};
+	static void Construct(char* const /*column*/,const int32_t /*index*/,const tNoColumn& /*value*/) {}
+	static void Destroy(char* const /*column*/,const int32_t /*count*/) {}
+	static void DestroyAt(char* const /*column*/,const int32_t /*index*/) {}
+};
+
+// tPArrayT with the elements stored as a structure of arrays. Each of the up to 4 fields of an element is in it's own
+//  column, so a loop over one field reads only that field's memory rather than every element whole. The columns
+//  follow the array in the same allocation, each aligned to a cache line, and Column gives one as a tSpanT for
+//  vectorised kernels. Elements are reached through tRow, a proxy holding the array and the index.
+template<typename BASECLASS,typename C0,typename C1=tNoColumn,typename C2=tNoColumn,typename C3=tNoColumn>
+class tPSoAArrayT : public BASECLASS
+{
+public:
+	class tRow;
+	class iterator;
+	struct tCtorArgs;
+	friend class tPSoAArray_UnitTest;
+	enum
+	{
+		eMaxNumColumns=4,
+		eColumnAlignment=64,																	// A cache line, and enough for any vector
+																									//  instructions
+	};
+//=====================================================================================================================
+// PROPERTIES
+//=====================================================================================================================
+	int32_t NumReserved(void) const;														// Maximum number of elements
+	int32_t Size(void) const;																// Number of elements constructed
+	template<int COLUMN>
+	tSpanT<typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType> Column(void);	// The constructed elements of this column
+	template<int COLUMN>
+	tSpanT<const typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType> Column(void) const;
+	static int32_t AllocationSize(const int32_t numelements);					// Bytes for the array and it's columns
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tPSoAArrayT(const tCtorArgs& args);
+	~tPSoAArrayT(void);
+	iterator begin();
+	iterator end();
+	tRow Construct(void);																	// Construct another element with each field
+																									//  default constructed
+	tRow Construct(
+	 const C0& c0,
+	 const C1& c1=C1(),
+	 const C2& c2=C2(),
+	 const C3& c3=C3());																		// Construct another element, copying the
+																									//  fields
+	void Clear(void);																			// Remove all the constructed elements
+	tRow operator[](const int32_t index);												// Element at this index
+	//~PF
+private:
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	const int32_t m_NumElements;															// Maximum number of elements
+	int32_t m_NumConstructed;																// Number of elements constructed
+	char* m_Columns[eMaxNumColumns];
+	//~V
+	tPSoAArrayT(const tPSoAArrayT&);
+	tPSoAArrayT& operator=(const tPSoAArrayT&);
+	static int32_t ColumnBytes(
+	 const int32_t numelements,
+	 const int32_t elementsize);															// Rounded up so the next column is aligned
+	void Invariant(void) const;
+	//~F
+};
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+struct tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tCtorArgs
+{
+	int32_t NumElements;
+};
+
+//=====================================================================================================================
+// ARRAY CREATION FUNCTIONS
+//=====================================================================================================================
+
+// Template create an array from an allocator, with it's columns in the same allocation
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3,typename ALLOCATOR>
+tPSoAArrayT<BASECLASS,C0,C1,C2,C3>& PMakeSoAArrayT(
+ ALLOCATOR& allocator,
+ const int32_t numelements);
+
+//=====================================================================================================================
+// ROW AND ITERATOR CLASS DECLARATIONS
+//=====================================================================================================================
+
+// Stands in for a reference to an element, which has no single address
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+class tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow
+{
+	tPSoAArrayT* m_Array;
+	int32_t m_Index;
+	//~V
+public:
+	tRow(
+	 tPSoAArrayT& thearray,
+	 const int32_t index);
+	int32_t Index(void) const;
+	template<int COLUMN>
+	typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType& Field(void) const;	// This field of the element
+};
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+class tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator
+{
+	tPSoAArrayT* m_Array;
+	int32_t m_Index;
+	//~V
+public:
+	iterator(void);
+	iterator(
+	 tPSoAArrayT& thearray,
+	 const int32_t index);
+	iterator operator++(void);
+	iterator operator++(int);
+	iterator operator--(void);
+	iterator operator--(int);
+	bool operator==(const iterator& rhs) const;
+	bool operator!=(const iterator& rhs) const;
+	tRow operator*(void) const;
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename TYPE>
+void tSoAColumnT<TYPE>::Construct(char* const column,const int32_t index,const TYPE& value)
+{
+	::new(static_cast<void*>(reinterpret_cast<TYPE*>(column)+index)) TYPE(value);
+}
+
+template<typename TYPE>
+void tSoAColumnT<TYPE>::Destroy(char* const column,const int32_t count)
+{
+	TYPE* const elements=reinterpret_cast<TYPE*>(column);
+	for(int32_t i=0;i<count;++i)
+	{
+		elements[i].~TYPE();
+	}
+}
+
+template<typename TYPE>
+void tSoAColumnT<TYPE>::DestroyAt(char* const column,const int32_t index)
+{
+	(reinterpret_cast<TYPE*>(column)+index)->~TYPE();
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3,typename ALLOCATOR>
+tPSoAArrayT<BASECLASS,C0,C1,C2,C3>& PMakeSoAArrayT(ALLOCATOR& allocator,const int32_t numelements)
+{
+	_ASSERTE(numelements>0);
+	typedef tPSoAArrayT<BASECLASS,C0,C1,C2,C3> _tPSoAArray;
+	const int32_t size=_tPSoAArray::AllocationSize(numelements);
+	const typename _tPSoAArray::tCtorArgs args=
+	{
+		numelements,
+	};
+	// The BASECLASS is used as the POLYTYPE for the allocator
+	return AllocateAndConstructPoly<BASECLASS,_tPSoAArray>(allocator,size,args);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+int32_t tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::ColumnBytes(const int32_t numelements,const int32_t elementsize)
+{
+	return ((numelements*elementsize+eColumnAlignment-1)/eColumnAlignment)*eColumnAlignment;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+int32_t tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::AllocationSize(const int32_t numelements)
+{
+	// The array may not be aligned, so allow for padding before the first column
+	return static_cast<int32_t>(sizeof(tPSoAArrayT))+eColumnAlignment-1+
+	 ColumnBytes(numelements,tSoAColumnT<C0>::eElementSize)+ColumnBytes(numelements,tSoAColumnT<C1>::eElementSize)+
+	 ColumnBytes(numelements,tSoAColumnT<C2>::eElementSize)+ColumnBytes(numelements,tSoAColumnT<C3>::eElementSize);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tPSoAArrayT(const tCtorArgs& args):m_NumElements(args.NumElements),
+ m_NumConstructed(0)
+{
+	C_ASSERT(alignment_of<C0>::value<=eColumnAlignment && alignment_of<C1>::value<=eColumnAlignment &&
+	 alignment_of<C2>::value<=eColumnAlignment && alignment_of<C3>::value<=eColumnAlignment);
+	_ASSERTE(m_NumElements>0);
+	// Lay out the columns after the array
+	const uintptr_t end=reinterpret_cast<uintptr_t>(this)+sizeof(*this);
+	char* column=reinterpret_cast<char*>((end+eColumnAlignment-1)&~static_cast<uintptr_t>(eColumnAlignment-1));
+	const int32_t elementsizes[eMaxNumColumns]=
+	{
+		tSoAColumnT<C0>::eElementSize,
+		tSoAColumnT<C1>::eElementSize,
+		tSoAColumnT<C2>::eElementSize,
+		tSoAColumnT<C3>::eElementSize,
+	};
+	for(int columnidx=0;columnidx<eMaxNumColumns;++columnidx)
+	{
+		m_Columns[columnidx]=column;
+		column+=ColumnBytes(m_NumElements,elementsizes[columnidx]);
+	}
+	Invariant();
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::~tPSoAArrayT(void)
+{
+	Clear();
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+void tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::Clear(void)
+{
+	Invariant();
+	tSoAColumnT<C0>::Destroy(m_Columns[0],m_NumConstructed);
+	tSoAColumnT<C1>::Destroy(m_Columns[1],m_NumConstructed);
+	tSoAColumnT<C2>::Destroy(m_Columns[2],m_NumConstructed);
+	tSoAColumnT<C3>::Destroy(m_Columns[3],m_NumConstructed);
+	m_NumConstructed=0;
+	Invariant();
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+int32_t tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::NumReserved(void) const
+{
+	return m_NumElements;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+int32_t tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::Size(void) const
+{
+	return m_NumConstructed;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+template<int COLUMN>
+tSpanT<typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType> tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::Column(void)
+{
+	C_ASSERT(COLUMN>=0 && COLUMN<eMaxNumColumns);
+	typedef typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType _tField;
+	return tSpanT<_tField>(reinterpret_cast<_tField*>(m_Columns[COLUMN]),m_NumConstructed);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+template<int COLUMN>
+tSpanT<const typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType> tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::Column(void) const
+{
+	C_ASSERT(COLUMN>=0 && COLUMN<eMaxNumColumns);
+	typedef const typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType _tField;
+	return tSpanT<_tField>(reinterpret_cast<_tField*>(m_Columns[COLUMN]),m_NumConstructed);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::Construct(void)
+{
+	return Construct(C0(),C1(),C2(),C3());
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::Construct(const C0& c0,
+ const C1& c1,const C2& c2,const C3& c3)
+{
+	Invariant();
+	_ASSERTE(m_NumConstructed<m_NumElements);
+	int numcolumnsconstructed=0;
+	try
+	{
+		tSoAColumnT<C0>::Construct(m_Columns[0],m_NumConstructed,c0);
+		++numcolumnsconstructed;
+		tSoAColumnT<C1>::Construct(m_Columns[1],m_NumConstructed,c1);
+		++numcolumnsconstructed;
+		tSoAColumnT<C2>::Construct(m_Columns[2],m_NumConstructed,c2);
+		++numcolumnsconstructed;
+		tSoAColumnT<C3>::Construct(m_Columns[3],m_NumConstructed,c3);
+	}
+	catch(...)
+	{
+		// The element isn't counted so Clear would never destroy the fields which were constructed
+		switch(numcolumnsconstructed)
+		{
+		case 3:
+			tSoAColumnT<C2>::DestroyAt(m_Columns[2],m_NumConstructed);
+			// Fall through
+		case 2:
+			tSoAColumnT<C1>::DestroyAt(m_Columns[1],m_NumConstructed);
+			// Fall through
+		case 1:
+			tSoAColumnT<C0>::DestroyAt(m_Columns[0],m_NumConstructed);
+			break;
+		}
+		Invariant();
+		throw;
+	}
+	++m_NumConstructed;
+	Invariant();
+	return tRow(*this,m_NumConstructed-1);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::operator[](const int32_t index)
+{
+	_ASSERTE(index>=0);
+	_ASSERTE(index<m_NumConstructed);
+	return tRow(*this,index);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::begin(void)
+{
+	return iterator(*this,0);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::end(void)
+{
+	return iterator(*this,m_NumConstructed);
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+void tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::Invariant(void) const
+{
+#ifdef _DEBUG
+	_ASSERTE(m_NumElements>0);
+	_ASSERTE(m_NumConstructed>=0);
+	// Can't construct more elements than are in the array
+	_ASSERTE(m_NumConstructed<=m_NumElements);
+	_ASSERTE(m_Columns[0]>=reinterpret_cast<const char*>(this)+sizeof(*this));
+	for(int columnidx=0;columnidx<eMaxNumColumns;++columnidx)
+	{
+		_ASSERTE(!(reinterpret_cast<uintptr_t>(m_Columns[columnidx])%eColumnAlignment));
+		_ASSERTE(!columnidx || m_Columns[columnidx]>=m_Columns[columnidx-1]);
+	}
+#endif
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow::tRow(tPSoAArrayT& thearray,const int32_t index):m_Array(&thearray),
+ m_Index(index)
+{
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+int32_t tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow::Index(void) const
+{
+	return m_Index;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+template<int COLUMN>
+typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType& tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow::Field(void) const
+{
+	C_ASSERT(COLUMN>=0 && COLUMN<eMaxNumColumns);
+	_ASSERTE(m_Index>=0 && m_Index<m_Array->Size());
+	typedef typename tSoAColumnTypeT<COLUMN,C0,C1,C2,C3>::tType _tField;
+	return reinterpret_cast<_tField*>(m_Array->m_Columns[COLUMN])[m_Index];
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::iterator(void):m_Array(NULL),m_Index(0)
+{
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::iterator(tPSoAArrayT& thearray,const int32_t index):m_Array(&thearray),
+ m_Index(index)
+{
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::operator++(void)
+{
+	++m_Index;
+	return *this;
+}
+
+// Postincrement
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::operator++(int)
+{
+	iterator copy(*this);
+	++m_Index;
+	return copy;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::operator--(void)
+{
+	--m_Index;
+	return *this;
+}
+
+// Post decrement
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::operator--(int)
+{
+	iterator copy(*this);
+	--m_Index;
+	return copy;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+bool tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::operator==(const iterator& rhs) const
+{
+	_ASSERTE(rhs.m_Array==m_Array);
+	return rhs.m_Index==m_Index;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+bool tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::operator!=(const iterator& rhs) const
+{
+	_ASSERTE(rhs.m_Array==m_Array);
+	return rhs.m_Index!=m_Index;
+}
+
+template<typename BASECLASS,typename C0,typename C1,typename C2,typename C3>
+typename tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::tRow tPSoAArrayT<BASECLASS,C0,C1,C2,C3>::iterator::operator*(void) const
+{
+	// Can't be outside the bounds of the array
+	_ASSERTE(m_Array && m_Index>=0 && m_Index<m_Array->Size());
+	return tRow(*m_Array,m_Index);
+}
\ No newline at end of file
@@ -0,0 +1,264 @@
+#pragma once
+
+#include "PsyncSoAArray.h"
+#include "IUnitTest.h"
+#include "BlockAllocator.h"
+
+class tPSoAArray_UnitTest : public IUnitTest
+{
+	enum eTestNumber
+	{
+		eTestFirst=0,
+		//
+		eColumnLayout=0,
+		eConstructAndIterate,
+		eDestroyFields,
+		//
+		TestCount,
+	};
+	typedef tBlockAllocatorT<tBlockAllocatorRefCounter> _tAllocator;
+	typedef tPSoAArrayT<tBlockAllocatorRefCounter,int32_t,double,char> _tPSoAArray;
+	bool ColumnLayout(void);
+	bool ConstructAndIterate(void);
+	bool DestroyFields(void);
+public:
+	unsigned short GetFirstTest(void) const override
+	{
+		return eTestFirst;
+	}
+	unsigned short GetTestCount(void) const override
+	{
+		return TestCount;
+	}
+	void GetTestName(
+	 const unsigned short testnum,
+	 const unsigned short testnamecount,
+	 WCHAR* const testname) const override;
+	void GetTestDescription(
+	 const unsigned short testnum,
+	 const unsigned short descrcount,
+	 WCHAR* const descr) const override;
+	bool DoTest(const unsigned short testnum) override;
+};
+
+inline void tPSoAArray_UnitTest::GetTestName(const unsigned short testnum,
+ const unsigned short testnamecount,WCHAR* const testname) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eColumnLayout:
+		wcscpy_s(testname,testnamecount,L"ColumnLayout");
+		break;
+	case eConstructAndIterate:
+		wcscpy_s(testname,testnamecount,L"ConstructAndIterate");
+		break;
+	case eDestroyFields:
+		wcscpy_s(testname,testnamecount,L"DestroyFields");
+		break;
+	}
+}
+
+inline void tPSoAArray_UnitTest::GetTestDescription(const unsigned short testnum,
+ const unsigned short descrcount,WCHAR* const descr) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eColumnLayout:
+		wcscpy_s(descr,descrcount,
+		 L"Each column is aligned to a cache line, after the last and inside the array's allocation");
+		break;
+	case eConstructAndIterate:
+		wcscpy_s(descr,descrcount,
+		 L"Construct elements, then read and write them through rows, the iterator and the column spans");
+		break;
+	case eDestroyFields:
+		wcscpy_s(descr,descrcount,
+		 L"Fields are destroyed by Clear, with the array, and straight away when a later field of their element throws");
+		break;
+	}
+}
+
+inline bool tPSoAArray_UnitTest::ColumnLayout()
+{
+	_tAllocator allocator(10000);
+	const int32_t numelements=100;
+	_tPSoAArray& thearray=PMakeSoAArrayT<tBlockAllocatorRefCounter,int32_t,double,char,tNoColumn>(allocator,
+	 numelements);
+	UNITTEST_ASSERT(thearray.NumReserved()==numelements && thearray.Size()==0);
+	const char* const arrayend=reinterpret_cast<const char*>(&thearray)+_tPSoAArray::AllocationSize(numelements);
+	const char* const columns[3]=
+	{
+		reinterpret_cast<const char*>(thearray.Column<0>().Data()),
+		reinterpret_cast<const char*>(thearray.Column<1>().Data()),
+		reinterpret_cast<const char*>(thearray.Column<2>().Data()),
+	};
+	const int32_t columnsizes[3]=
+	{
+		sizeof(int32_t),
+		sizeof(double),
+		sizeof(char),
+	};
+	UNITTEST_ASSERT(columns[0]>=reinterpret_cast<const char*>(&thearray+1));
+	for(int columnidx=0;columnidx<3;++columnidx)
+	{
+		UNITTEST_ASSERT(!(reinterpret_cast<uintptr_t>(columns[columnidx])%_tPSoAArray::eColumnAlignment));
+		UNITTEST_ASSERT(columnidx==2 || columns[columnidx]+(numelements*columnsizes[columnidx])<=columns[columnidx+1]);
+	}
+	// In the array's own allocation
+	UNITTEST_ASSERT(columns[2]+numelements<=arrayend);
+	return true;
+}
+
+inline bool tPSoAArray_UnitTest::ConstructAndIterate()
+{
+	_tAllocator allocator(10000);
+	const int32_t numelements=100;
+	_tPSoAArray& thearray=PMakeSoAArrayT<tBlockAllocatorRefCounter,int32_t,double,char,tNoColumn>(allocator,
+	 numelements);
+	thearray.Construct();
+	for(int32_t i=1;i<numelements;++i)
+	{
+		const _tPSoAArray::tRow row=thearray.Construct(i,i*0.5,static_cast<char>('a'+(i%26)));
+		UNITTEST_ASSERT(row.Index()==i);
+		UNITTEST_ASSERT(thearray.Size()==i+1);
+	}
+	UNITTEST_ASSERT(thearray[0].Field<0>()==0 && thearray[0].Field<1>()==0.0 && thearray[0].Field<2>()==0);
+	// Iterate and read
+	{
+		int32_t iterationindex=0;
+		for(_tPSoAArray::iterator i=thearray.begin();i!=thearray.end();++i)
+		{
+			const _tPSoAArray::tRow row=*i;
+			UNITTEST_ASSERT(row.Field<0>()==iterationindex);
+			UNITTEST_ASSERT(row.Field<1>()==iterationindex*0.5);
+			++iterationindex;
+		}
+		UNITTEST_ASSERT(iterationindex==numelements);
+	}
+	// Write one column through it's span, and read it through the rows
+	{
+		const tSpanT<int32_t> column=thearray.Column<0>();
+		UNITTEST_ASSERT(column.Size()==numelements);
+		for(int32_t* value=column.begin();value!=column.end();++value)
+		{
+			*value*=2;
+		}
+		for(int32_t i=1;i<numelements;++i)
+		{
+			UNITTEST_ASSERT(thearray[i].Field<0>()==i*2);
+			UNITTEST_ASSERT(thearray[i].Field<2>()==static_cast<char>('a'+(i%26)));
+		}
+	}
+	// Read through a const array
+	{
+		const _tPSoAArray& constarray=thearray;
+		const tSpanT<const double> column=constarray.Column<1>();
+		double sum=0;
+		for(int32_t i=0;i<column.Size();++i)
+		{
+			sum+=column[i];
+		}
+		UNITTEST_ASSERT(sum==(numelements*(numelements-1)/2)*0.5);
+	}
+	thearray.Clear();
+	UNITTEST_ASSERT(thearray.Size()==0 && thearray.Column<1>().IsEmpty());
+	return true;
+}
+
+inline bool tPSoAArray_UnitTest::DestroyFields()
+{
+	struct _tCounted
+	{
+		int32_t* m_NumAlive;
+		_tCounted(int32_t* const numalive):m_NumAlive(numalive)
+		{
+			++*m_NumAlive;
+		}
+		_tCounted(const _tCounted& rhs):m_NumAlive(rhs.m_NumAlive)
+		{
+			++*m_NumAlive;
+		}
+		~_tCounted(void)
+		{
+			--*m_NumAlive;
+		}
+	};
+	struct _tThrowOnCopy
+	{
+		bool m_Throw;
+		_tThrowOnCopy(const bool throwoncopy):m_Throw(throwoncopy) {}
+		_tThrowOnCopy(const _tThrowOnCopy& rhs):m_Throw(rhs.m_Throw)
+		{
+			if(m_Throw)
+			{
+				throw std::bad_alloc("Copy failed.");
+			}
+		}
+	};
+	typedef tPSoAArrayT<tBlockAllocatorRefCounter,float,_tCounted> _tPCountedArray;
+	typedef tPSoAArrayT<tBlockAllocatorRefCounter,_tCounted,_tThrowOnCopy> _tPThrowingArray;
+
+	int32_t numalive=0;
+	{
+		_tAllocator allocator(10000);
+		_tPCountedArray& thearray=
+		 PMakeSoAArrayT<tBlockAllocatorRefCounter,float,_tCounted,tNoColumn,tNoColumn>(allocator,20);
+		const _tCounted counted(&numalive);
+		for(int32_t i=0;i<10;++i)
+		{
+			thearray.Construct(1.0f,counted);
+		}
+		UNITTEST_ASSERT(numalive==11);
+		thearray.Clear();
+		UNITTEST_ASSERT(numalive==1);
+		for(int32_t i=0;i<20;++i)
+		{
+			thearray.Construct(1.0f,counted);
+		}
+		UNITTEST_ASSERT(numalive==21);
+	}
+	// Confirm all fields were destroyed with the allocator
+	UNITTEST_ASSERT(numalive==0);
+	// A later column throwing destroys the columns already constructed for that element
+	{
+		_tAllocator allocator(10000);
+		_tPThrowingArray& thearray=
+		 PMakeSoAArrayT<tBlockAllocatorRefCounter,_tCounted,_tThrowOnCopy,tNoColumn,tNoColumn>(allocator,20);
+		const _tCounted counted(&numalive);
+		thearray.Construct(counted,_tThrowOnCopy(false));
+		bool threw=false;
+		try
+		{
+			thearray.Construct(counted,_tThrowOnCopy(true));
+		}
+		catch(const std::bad_alloc&)
+		{
+			threw=true;
+		}
+		UNITTEST_ASSERT(threw && thearray.Size()==1 && numalive==2);
+	}
+	UNITTEST_ASSERT(numalive==0);
+	return true;
+}
+
+inline bool tPSoAArray_UnitTest::DoTest(const unsigned short testnum)
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eColumnLayout:
+		return ColumnLayout();
+	case eConstructAndIterate:
+		return ConstructAndIterate();
+	case eDestroyFields:
+		return DestroyFields();
+	}
+}
\ No newline at end of file
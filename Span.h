@@ -0,0 +1,87 @@
+#pragma once
+
+// A view of contiguous elements owned by something else, in place of std::span which this compiler doesn't have. The
+//  elements are reached through a raw pointer so kernels over them can be vectorised as over a plain array.
+template<typename TYPE>
+class tSpanT
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	TYPE* m_Data;
+	int32_t m_Size;
+	//~V
+//=====================================================================================================================
+// PROPERTIES
+//=====================================================================================================================
+public:
+	typedef TYPE value_type;
+	typedef TYPE* iterator;
+	TYPE* Data(void) const;																	// The first element
+	int32_t Size(void) const;																// The number of elements
+	bool IsEmpty(void) const;
+	iterator begin(void) const;
+	iterator end(void) const;
+	TYPE& operator[](const int32_t index) const;
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tSpanT(void);
+	tSpanT(
+	 TYPE* const data,
+	 const int32_t size);
+	//~PF
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename TYPE>
+tSpanT<TYPE>::tSpanT(void):m_Data(NULL),m_Size(0)
+{
+}
+
+template<typename TYPE>
+tSpanT<TYPE>::tSpanT(TYPE* const data,const int32_t size):m_Data(data),m_Size(size)
+{
+	_ASSERTE(size>=0);
+	_ASSERTE(data || !size);
+}
+
+template<typename TYPE>
+TYPE* tSpanT<TYPE>::Data(void) const
+{
+	return m_Data;
+}
+
+template<typename TYPE>
+int32_t tSpanT<TYPE>::Size(void) const
+{
+	return m_Size;
+}
+
+template<typename TYPE>
+bool tSpanT<TYPE>::IsEmpty(void) const
+{
+	return !m_Size;
+}
+
+template<typename TYPE>
+typename tSpanT<TYPE>::iterator tSpanT<TYPE>::begin(void) const
+{
+	return m_Data;
+}
+
+template<typename TYPE>
+typename tSpanT<TYPE>::iterator tSpanT<TYPE>::end(void) const
+{
+	return m_Data+m_Size;
+}
+
+template<typename TYPE>
+TYPE& tSpanT<TYPE>::operator[](const int32_t index) const
+{
+	_ASSERTE(index>=0 && index<m_Size);
+	return m_Data[index];
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+// An STL allocator over a RESOURCE with AllocateUnmanaged and DeallocateUnmanaged, so that containers can use the
+//  memory of a tBlockAllocatorT. With the allocator type as the RESOURCE each allocation is a direct call; with
+//  IMemoryResource it's a virtual call but the container type doesn't depend on the allocator's. For example:
+//  typedef tStlAllocatorT<int,tBlockAllocatorT<IPoly> > tIntAllocator;
+//  std::vector<int,tIntAllocator> ints((tIntAllocator(allocator)));
+// Memory is given back to the RESOURCE when the container is done with it, but a block allocator only reuses it where
+//  it was the last thing allocated, so containers which grow a lot are best reserved up front. The RESOURCE must
+//  outlive every container using it.
+template<typename TYPE,typename RESOURCE>
+class tStlAllocatorT
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	template<typename OTHER,typename OTHERRESOURCE>
+	friend class tStlAllocatorT;
+	RESOURCE* m_Resource;
+	//~V
+//=====================================================================================================================
+// PROPERTIES
+//=====================================================================================================================
+public:
+	typedef TYPE value_type;
+	typedef TYPE* pointer;
+	typedef const TYPE* const_pointer;
+	typedef TYPE& reference;
+	typedef const TYPE& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	template<typename OTHER>
+	struct rebind
+	{
+		typedef tStlAllocatorT<OTHER,RESOURCE> other;
+	};
+	RESOURCE& Resource(void) const;
+	pointer address(reference value) const;
+	const_pointer address(const_reference value) const;
+	size_type max_size(void) const;
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	explicit tStlAllocatorT(RESOURCE& resource);
+	template<typename OTHER>
+	tStlAllocatorT(const tStlAllocatorT<OTHER,RESOURCE>& rhs);
+	pointer allocate(
+	 const size_type count,
+	 const void* const hint=NULL);
+	void deallocate(
+	 const pointer memory,
+	 const size_type count);
+	void construct(
+	 const pointer memory,
+	 const TYPE& value);
+	void destroy(const pointer memory);
+	//~PF
+};
+
+template<typename TYPE,typename OTHER,typename RESOURCE>
+bool operator==(
+ const tStlAllocatorT<TYPE,RESOURCE>& lhs,
+ const tStlAllocatorT<OTHER,RESOURCE>& rhs);											// Memory from one can be given back to the
+																									//  other
+template<typename TYPE,typename OTHER,typename RESOURCE>
+bool operator!=(
+ const tStlAllocatorT<TYPE,RESOURCE>& lhs,
+ const tStlAllocatorT<OTHER,RESOURCE>& rhs);
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename TYPE,typename RESOURCE>
+tStlAllocatorT<TYPE,RESOURCE>::tStlAllocatorT(RESOURCE& resource):m_Resource(&resource)
+{
+}
+
+template<typename TYPE,typename RESOURCE>
+template<typename OTHER>
+tStlAllocatorT<TYPE,RESOURCE>::tStlAllocatorT(const tStlAllocatorT<OTHER,RESOURCE>& rhs):m_Resource(rhs.m_Resource)
+{
+}
+
+template<typename TYPE,typename RESOURCE>
+RESOURCE& tStlAllocatorT<TYPE,RESOURCE>::Resource(void) const
+{
+	return *m_Resource;
+}
+
+template<typename TYPE,typename RESOURCE>
+typename tStlAllocatorT<TYPE,RESOURCE>::pointer tStlAllocatorT<TYPE,RESOURCE>::address(reference value) const
+{
+	return &value;
+}
+
+template<typename TYPE,typename RESOURCE>
+typename tStlAllocatorT<TYPE,RESOURCE>::const_pointer tStlAllocatorT<TYPE,RESOURCE>::address(
+ const_reference value) const
+{
+	return &value;
+}
+
+template<typename TYPE,typename RESOURCE>
+typename tStlAllocatorT<TYPE,RESOURCE>::size_type tStlAllocatorT<TYPE,RESOURCE>::max_size(void) const
+{
+	// Sizes are passed on as int32_t
+	return static_cast<size_type>(numeric_limits<int32_t>::max())/sizeof(TYPE);
+}
+
+template<typename TYPE,typename RESOURCE>
+typename tStlAllocatorT<TYPE,RESOURCE>::pointer tStlAllocatorT<TYPE,RESOURCE>::allocate(const size_type count,
+ const void* const /*hint*/)
+{
+	if(count>max_size())
+	{
+		throw std::bad_alloc("Too many elements for tStlAllocatorT.");
+	}
+	if(!count)
+	{
+		return NULL;
+	}
+	const int32_t nbytes=static_cast<int32_t>(count*sizeof(TYPE));
+	const unsigned short alignment=static_cast<unsigned short>(alignment_of<TYPE>::value);
+	return static_cast<pointer>(m_Resource->AllocateUnmanaged(nbytes,alignment));
+}
+
+template<typename TYPE,typename RESOURCE>
+void tStlAllocatorT<TYPE,RESOURCE>::deallocate(const pointer memory,const size_type count)
+{
+	if(memory)
+	{
+		m_Resource->DeallocateUnmanaged(memory,static_cast<int32_t>(count*sizeof(TYPE)));
+	}
+}
+
+template<typename TYPE,typename RESOURCE>
+void tStlAllocatorT<TYPE,RESOURCE>::construct(const pointer memory,const TYPE& value)
+{
+	::new(static_cast<void*>(memory)) TYPE(value);
+}
+
+template<typename TYPE,typename RESOURCE>
+void tStlAllocatorT<TYPE,RESOURCE>::destroy(const pointer memory)
+{
+	memory->~TYPE();
+}
+
+template<typename TYPE,typename OTHER,typename RESOURCE>
+bool operator==(const tStlAllocatorT<TYPE,RESOURCE>& lhs,const tStlAllocatorT<OTHER,RESOURCE>& rhs)
+{
+	return (&(lhs.Resource())==&(rhs.Resource()));
+}
+
+template<typename TYPE,typename OTHER,typename RESOURCE>
+bool operator!=(const tStlAllocatorT<TYPE,RESOURCE>& lhs,const tStlAllocatorT<OTHER,RESOURCE>& rhs)
+{
+	return !(lhs==rhs);
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "BlockAllocator.h"
+
+// A block allocator which can be shared between threads. Each thread allocates from it's own private ALLOCATOR, a
+//  tBlockAllocatorT, so the allocation itself takes no lock and makes no interlocked call. A thread gives up it's
+//  spare blocks by calling ShareSpareBlocks, which pushes them on to an interlocked list in it's cache. When a
+//  thread's allocator would need to create another block, a shared block is first popped from one of these lists, and
+//  only if there isn't one that fits is more memory requested from the system.
+// Objects allocated by one thread can be used by any thread, and live until this allocator is destroyed.
+template<typename ALLOCATOR>
+class tThreadCachingAllocatorT
+{
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+	typedef ALLOCATOR _tAllocator;
+	typedef typename ALLOCATOR::tPolyType _tPolyType;
+	typedef tManagedMemoryBlockT<_tPolyType> _tMemoryBlock;
+	struct _tSharedBlock
+	{
+		SLIST_ENTRY Entry;																	// Must be first. Needs the alignment new
+																									//  gives
+		_tMemoryBlock* Block;																// The block given up, and it's chain
+	};
+	struct _tThreadCache
+	{
+		SLIST_HEADER SharedBlocks;															// Blocks the owning thread has given up
+																									//  for any thread to take, as _tSharedBlock
+		_tAllocator Allocator;																// The allocator private to one thread
+		_tThreadCache* Next;																	// The next cache in the list
+		_tThreadCache(
+		 const int32_t initialsize,
+		 const int32_t subsequentblocksize);
+	};
+	friend class tThreadCachingAllocator_UnitTest;
+	const DWORD m_TlsIndex;																	// Thread local storage for each thread's
+																									//  cache
+	_tThreadCache* volatile m_Caches;													// Every thread's cache. Caches are only
+																									//  ever added
+	const int32_t m_InitialSize;															// The size for the first block of each
+																									//  thread
+	const int32_t m_SubsequentBlockSize;												// The size of subsequent blocks
+	//~V
+	tThreadCachingAllocatorT(const tThreadCachingAllocatorT&);
+	tThreadCachingAllocatorT& operator=(const tThreadCachingAllocatorT&);
+	_tThreadCache& ThreadCache(void);													// The cache for the calling thread. Created
+																									//  the first time a thread allocates
+	_tAllocator& AllocatorFor(
+	 const int32_t size,
+	 const unsigned short alignment,
+	 const int32_t recordsize);															// The calling thread's allocator, given a
+																									//  shared block first if it hasn't space for
+																									//  an allocation of this size and managed
+																									//  record size
+	bool TakeSharedBlock(
+	 _tThreadCache& cache,
+	 const int32_t minbytes);																// Move a shared block with at least
+																									//  'minbytes' left, from any cache, in to
+																									//  this cache's allocator
+	static _tMemoryBlock* PopSharedBlock(
+	 _tThreadCache& cache,
+	 const int32_t minbytes);																// The block most recently shared by this
+																									//  cache if it has at least 'minbytes' left,
+																									//  otherwise NULL
+	//~F
+public:
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tThreadCachingAllocatorT(
+	 const int32_t initialsize,
+	 const int32_t subsequentblocksize=0 /* 0 means use initial size */);
+	~tThreadCachingAllocatorT(void);														// No thread may be allocating whilst this
+																									//  is destroyed
+	void ShareSpareBlocks(void);															// Give up every block but one of the
+																									//  calling thread's allocator for other
+																									//  threads to take. Call when the thread has
+																									//  finished allocating for a while
+	template<typename TYPE>
+	TYPE& AllocateUnmanaged(void);														// See tBlockAllocatorT
+	template<typename TYPE>
+	tLazyT<TYPE,_tPolyType>& Allocate(void);
+	template<typename TYPE>
+	TYPE& AllocateAndConstructPoly(void);
+	template<typename TYPE>
+	TYPE& AllocateAndConstructPoly(
+	 typename const TYPE::tCtorArgs& args);
+	template<typename TYPE>
+	TYPE& AllocateAndConstruct(void);
+	template<typename TYPE>
+	TYPE& AllocateAndConstruct(typename const TYPE::tCtorArgs& args);
+	//~PF
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+template<typename ALLOCATOR>
+tThreadCachingAllocatorT<ALLOCATOR>::_tThreadCache::_tThreadCache(const int32_t initialsize,
+ const int32_t subsequentblocksize):Allocator(initialsize,subsequentblocksize),Next(NULL)
+{
+	InitializeSListHead(&SharedBlocks);
+}
+
+template<typename ALLOCATOR>
+tThreadCachingAllocatorT<ALLOCATOR>::tThreadCachingAllocatorT(const int32_t initialsize,
+ const int32_t subsequentblocksize /*=0*/):m_TlsIndex(TlsAlloc()),m_Caches(NULL),m_InitialSize(initialsize),
+ m_SubsequentBlockSize((subsequentblocksize)?subsequentblocksize:initialsize)
+{
+	if(m_TlsIndex==TLS_OUT_OF_INDEXES)
+	{
+		throw std::bad_alloc("Failed to allocate a thread local storage index.");
+	}
+}
+
+template<typename ALLOCATOR>
+tThreadCachingAllocatorT<ALLOCATOR>::~tThreadCachingAllocatorT(void)
+{
+	// Give the blocks nobody took back to the allocator which shared them, so they are freed with it
+	for(_tThreadCache* cache=m_Caches;cache;cache=cache->Next)
+	{
+		PSLIST_ENTRY entry=InterlockedFlushSList(&(cache->SharedBlocks));
+		while(entry)
+		{
+			PSLIST_ENTRY const next=entry->Next;
+			_tSharedBlock* const sharedblock=reinterpret_cast<_tSharedBlock*>(entry);
+			cache->Allocator.AdoptBlock(*(sharedblock->Block));
+			delete sharedblock;
+			entry=next;
+		}
+	}
+	// Blocks move between the caches, so an object may live in a different cache to the allocator which references
+	//  it. Destroy every object before any of the allocators are destroyed.
+	for(_tThreadCache* cache=m_Caches;cache;cache=cache->Next)
+	{
+		cache->Allocator.DestroyManagedObjects();
+	}
+	for(_tThreadCache* cache=m_Caches;cache;)
+	{
+		_tThreadCache* const next=cache->Next;
+		delete cache;
+		cache=next;
+	}
+	m_Caches=NULL;
+	TlsFree(m_TlsIndex);
+}
+
+template<typename ALLOCATOR>
+typename tThreadCachingAllocatorT<ALLOCATOR>::_tThreadCache& tThreadCachingAllocatorT<ALLOCATOR>::ThreadCache(void)
+{
+	_tThreadCache* cache=static_cast<_tThreadCache*>(TlsGetValue(m_TlsIndex));
+	if(!cache)
+	{
+		// First allocation from this thread
+		cache=new _tThreadCache(m_InitialSize,m_SubsequentBlockSize);
+		// Add it to the list of caches. Other threads may be doing the same
+		_tThreadCache* head;
+		do
+		{
+			head=m_Caches;
+			cache->Next=head;
+		}while(InterlockedCompareExchangePointer(reinterpret_cast<void* volatile*>(&m_Caches),cache,head)!=head);
+		TlsSetValue(m_TlsIndex,cache);
+	}
+	return *cache;
+}
+
+template<typename ALLOCATOR>
+ALLOCATOR& tThreadCachingAllocatorT<ALLOCATOR>::AllocatorFor(const int32_t size,const unsigned short alignment,
+ const int32_t recordsize)
+{
+	// Only the calling thread uses it's allocator, so nothing is locked
+	_tThreadCache& cache=ThreadCache();
+	if(!cache.Allocator.HasSpaceFor(size,recordsize))
+	{
+		// The allocator would need another block. Try to use one which a thread has given up before resorting to
+		//  the system allocator. Allow for alignment padding so the block is sure to fit the object.
+		const int32_t minbytes=size+alignment+recordsize;
+		TakeSharedBlock(cache,minbytes);
+	}
+	return cache.Allocator;
+}
+
+template<typename ALLOCATOR>
+bool tThreadCachingAllocatorT<ALLOCATOR>::TakeSharedBlock(_tThreadCache& cache,const int32_t minbytes)
+{
+	// The calling thread's own blocks first, it gave them up most recently
+	_tMemoryBlock* block=PopSharedBlock(cache,minbytes);
+	for(_tThreadCache* other=m_Caches;other && !block;other=other->Next)
+	{
+		if(other!=&cache)
+		{
+			block=PopSharedBlock(*other,minbytes);
+		}
+	}
+	if(!block)
+	{
+		return false;
+	}
+	cache.Allocator.AdoptBlock(*block);
+	return true;
+}
+
+template<typename ALLOCATOR>
+typename tThreadCachingAllocatorT<ALLOCATOR>::_tMemoryBlock*
+tThreadCachingAllocatorT<ALLOCATOR>::PopSharedBlock(_tThreadCache& cache,const int32_t minbytes)
+{
+	_tSharedBlock* const sharedblock=reinterpret_cast<_tSharedBlock*>(InterlockedPopEntrySList(&(cache.SharedBlocks)));
+	if(!sharedblock)
+	{
+		return NULL;
+	}
+	_tMemoryBlock* const block=sharedblock->Block;
+	if(block->NumBytesLeft()<minbytes)
+	{
+		// Too small. Put it back for a smaller allocation rather than search the list, which can only be popped
+		InterlockedPushEntrySList(&(cache.SharedBlocks),&(sharedblock->Entry));
+		return NULL;
+	}
+	delete sharedblock;
+	return block;
+}
+
+template<typename ALLOCATOR>
+void tThreadCachingAllocatorT<ALLOCATOR>::ShareSpareBlocks(void)
+{
+	_tThreadCache& cache=ThreadCache();
+	// The allocator keeps it's last block. Any block with space left is worth sharing
+	const int32_t minbytes=1;
+	_tMemoryBlock* block;
+	while((block=cache.Allocator.ReleaseSpareBlock(minbytes))!=NULL)
+	{
+		_tSharedBlock* const sharedblock=new _tSharedBlock;
+		sharedblock->Block=block;
+		InterlockedPushEntrySList(&(cache.SharedBlocks),&(sharedblock->Entry));
+	}
+}
+
+template<typename ALLOCATOR>
+template<typename TYPE>
+TYPE& tThreadCachingAllocatorT<ALLOCATOR>::AllocateUnmanaged(void)
+{
+	const int32_t recordsize=0;
+	return AllocatorFor(sizeof(TYPE),alignment_of<TYPE>::value,recordsize).AllocateUnmanaged<TYPE>();
+}
+
+template<typename ALLOCATOR>
+template<typename TYPE>
+tLazyT<TYPE,typename ALLOCATOR::tPolyType>& tThreadCachingAllocatorT<ALLOCATOR>::Allocate(void)
+{
+	typedef tLazyT<TYPE,_tPolyType> _tLazy;
+	const int32_t recordsize=_tMemoryBlock::RecordSize<_tLazy>(1);
+	return AllocatorFor(sizeof(_tLazy),alignment_of<_tLazy>::value,recordsize).Allocate<TYPE>();
+}
+
+template<typename ALLOCATOR>
+template<typename TYPE>
+TYPE& tThreadCachingAllocatorT<ALLOCATOR>::AllocateAndConstructPoly(void)
+{
+	const int32_t recordsize=_tMemoryBlock::RecordSize<TYPE>(1);
+	return AllocatorFor(sizeof(TYPE),alignment_of<TYPE>::value,recordsize).AllocateAndConstructPoly<TYPE>();
+}
+
+template<typename ALLOCATOR>
+template<typename TYPE>
+TYPE& tThreadCachingAllocatorT<ALLOCATOR>::AllocateAndConstructPoly(typename const TYPE::tCtorArgs& args)
+{
+	const int32_t recordsize=_tMemoryBlock::RecordSize<TYPE>(1);
+	return AllocatorFor(sizeof(TYPE),alignment_of<TYPE>::value,recordsize).AllocateAndConstructPoly<TYPE>(args);
+}
+
+template<typename ALLOCATOR>
+template<typename TYPE>
+TYPE& tThreadCachingAllocatorT<ALLOCATOR>::AllocateAndConstruct(void)
+{
+	const int32_t recordsize=_tMemoryBlock::RecordSize<TYPE>(1);
+	return AllocatorFor(sizeof(TYPE),alignment_of<TYPE>::value,recordsize).AllocateAndConstruct<TYPE>();
+}
+
+template<typename ALLOCATOR>
+template<typename TYPE>
+TYPE& tThreadCachingAllocatorT<ALLOCATOR>::AllocateAndConstruct(typename const TYPE::tCtorArgs& args)
+{
+	const int32_t recordsize=_tMemoryBlock::RecordSize<TYPE>(1);
+	return AllocatorFor(sizeof(TYPE),alignment_of<TYPE>::value,recordsize).AllocateAndConstruct<TYPE>(args);
+}
\ No newline at end of file
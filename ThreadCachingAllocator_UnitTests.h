@@ -0,0 +1,202 @@
+#pragma once
+
+#include "ThreadCachingAllocator.h"
+#include "IUnitTest.h"
+#include "RefCount.h"
+
+class tThreadCachingAllocator_UnitTest : public IUnitTest
+{
+	enum eTestNumber
+	{
+		eTestFirst=0,
+		//
+		eStealSpareBlock=0,
+		eConcurrentAllocate,
+		//
+		TestCount,
+	};
+	typedef tThreadCachingAllocatorT<tBlockAllocatorT<tBlockAllocatorRefCounter> > _tAllocator;
+	struct _tStealArgs
+	{
+		_tAllocator* Allocator;
+		char* SpareBlockObject;
+	};
+	struct _tObject : public tBlockAllocatorRefCounter
+	{
+		struct tCtorArgs
+		{
+			tRefCount& RefCounter;
+		};
+		tRefCount& m_RefCounter;
+		_tObject(const tCtorArgs& args):m_RefCounter(args.RefCounter)
+		{
+			m_RefCounter.AddRef();
+		}
+		~_tObject(void)
+		{
+			m_RefCounter.Release();
+		}
+	};
+	struct _tConcurrentArgs
+	{
+		_tAllocator* Allocator;
+		tRefCount* RefCounter;
+	};
+	enum
+	{
+		eNumThreads=4,
+		eNumObjectsPerThread=10000,
+	};
+	static DWORD WINAPI FillCache(LPVOID param);
+	static DWORD WINAPI AllocateObjects(LPVOID param);
+	bool StealSpareBlock(void);
+	bool ConcurrentAllocate(void);
+public:
+	unsigned short GetFirstTest(void) const override
+	{
+		return eTestFirst;
+	}
+	unsigned short GetTestCount(void) const override
+	{
+		return TestCount;
+	}
+	void GetTestName(
+	 const unsigned short testnum,
+	 const unsigned short testnamecount,
+	 WCHAR* const testname) const override;
+	void GetTestDescription(
+	 const unsigned short testnum,
+	 const unsigned short descrcount,
+	 WCHAR* const descr) const override;
+	bool DoTest(const unsigned short testnum) override;
+};
+
+inline void tThreadCachingAllocator_UnitTest::GetTestName(const unsigned short testnum,
+ const unsigned short testnamecount,WCHAR* const testname) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eStealSpareBlock:
+		wcscpy_s(testname,testnamecount,L"StealSpareBlock");
+		break;
+	case eConcurrentAllocate:
+		wcscpy_s(testname,testnamecount,L"ConcurrentAllocate");
+		break;
+	}
+}
+
+inline void tThreadCachingAllocator_UnitTest::GetTestDescription(const unsigned short testnum,
+ const unsigned short descrcount,WCHAR* const descr) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eStealSpareBlock:
+		wcscpy_s(descr,descrcount,
+		 L"A thread without space uses a spare block shared by another thread before creating a block");
+		break;
+	case eConcurrentAllocate:
+		wcscpy_s(descr,descrcount,
+		 L"Allocate managed objects from several threads at once and confirm they are all destroyed");
+		break;
+	}
+}
+
+// Leave the calling thread's cache with two blocks and share the spare one
+inline DWORD WINAPI tThreadCachingAllocator_UnitTest::FillCache(LPVOID param)
+{
+	_tStealArgs& args=*static_cast<_tStealArgs*>(param);
+	// Leaves 300 bytes less the block overhead in the first block
+	args.Allocator->AllocateUnmanaged<char[700]>();
+	// Doesn't fit in to the first block so creates a second, which is left with more space than the first
+	args.SpareBlockObject=args.Allocator->AllocateUnmanaged<char[600]>();
+	// The block with the most space is given up, the first block is kept
+	args.Allocator->ShareSpareBlocks();
+	return 0;
+}
+
+inline bool tThreadCachingAllocator_UnitTest::StealSpareBlock(void)
+{
+	_tAllocator allocator(1000);
+	_tStealArgs args=
+	{
+		&allocator,
+		NULL,
+	};
+	HANDLE thread=CreateThread(NULL,0,&FillCache,&args,0,NULL);
+	UNITTEST_ASSERT(thread);
+	WaitForSingleObject(thread,INFINITE);
+	CloseHandle(thread);
+	UNITTEST_ASSERT(args.SpareBlockObject);
+	// The other thread shared it's spare block, so this thread should continue on from where it left off in that
+	//  block rather than create a new block
+	char* const object=allocator.AllocateUnmanaged<char[100]>();
+	UNITTEST_ASSERT(object==args.SpareBlockObject+600);
+	// There should be two caches, with the block having moved
+	UNITTEST_ASSERT(allocator.m_Caches && allocator.m_Caches->Next && !allocator.m_Caches->Next->Next);
+	// Taken from the shared list, not copied
+	UNITTEST_ASSERT(QueryDepthSList(&(allocator.m_Caches->SharedBlocks))==0);
+	UNITTEST_ASSERT(QueryDepthSList(&(allocator.m_Caches->Next->SharedBlocks))==0);
+	return true;
+}
+
+inline DWORD WINAPI tThreadCachingAllocator_UnitTest::AllocateObjects(LPVOID param)
+{
+	_tConcurrentArgs& args=*static_cast<_tConcurrentArgs*>(param);
+	const _tObject::tCtorArgs objectargs=
+	{
+		*args.RefCounter,
+	};
+	for(int i=0;i<eNumObjectsPerThread;++i)
+	{
+		args.Allocator->AllocateAndConstructPoly<_tObject>(objectargs);
+	}
+	return 0;
+}
+
+inline bool tThreadCachingAllocator_UnitTest::ConcurrentAllocate(void)
+{
+	tRefCount refcounter;
+	{
+		_tAllocator allocator(4096);
+		_tConcurrentArgs args=
+		{
+			&allocator,
+			&refcounter,
+		};
+		HANDLE threads[eNumThreads];
+		for(int i=0;i<eNumThreads;++i)
+		{
+			threads[i]=CreateThread(NULL,0,&AllocateObjects,&args,0,NULL);
+			UNITTEST_ASSERT(threads[i]);
+		}
+		for(int i=0;i<eNumThreads;++i)
+		{
+			WaitForSingleObject(threads[i],INFINITE);
+			CloseHandle(threads[i]);
+		}
+		UNITTEST_ASSERT(refcounter.Count()==eNumThreads*eNumObjectsPerThread);
+	}
+	// Confirm all objects were destroyed
+	UNITTEST_ASSERT(refcounter.Count()==0);
+	return true;
+}
+
+inline bool tThreadCachingAllocator_UnitTest::DoTest(const unsigned short testnum)
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eStealSpareBlock:
+		return StealSpareBlock();
+	case eConcurrentAllocate:
+		return ConcurrentAllocate();
+	}
+}
\ No newline at end of file
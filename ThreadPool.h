@@ -0,0 +1,301 @@
+#pragma once
+
+// A fixed set of worker threads which, together with the thread running the job, run the numbered chunks of one job at
+//  a time. Each thread is dealt an even, contiguous share of the chunks and takes them in order from the front of it's
+//  share. A thread which runs out steals the back half of what is left of another thread's share, so the threads
+//  stay busy however unevenly the chunks take to run.
+// Only one job runs at a time; a thread which runs a job whilst another is running waits for it to finish. A job must
+//  not run another job from one of it's chunks.
+class tThreadPool
+{
+public:
+	enum
+	{
+		eCacheLineSize=64,
+	};
+	typedef void (*tRunChunk)(
+	 void* const context,
+	 const int32_t chunk);																	// Run one chunk of a job
+//=====================================================================================================================
+// PRIVATE
+//=====================================================================================================================
+private:
+	enum
+	{
+		eMaxWorkers=63,
+	};
+	// The chunks of a share not yet taken. The first chunk is in the low 32 bits and the end in the high 32 bits so the
+	//  owner and thieves can both take chunks with one compare and exchange. Each share has a cache line to itself
+	struct _tShare
+	{
+		volatile LONGLONG Chunks;
+		char Pad[eCacheLineSize-sizeof(LONGLONG)];
+	};
+	struct _tWorker
+	{
+		tThreadPool* Pool;
+		int32_t ShareIdx;
+	};
+	HANDLE m_Threads[eMaxWorkers];
+	_tWorker m_Workers[eMaxWorkers];
+	int32_t m_NumWorkers;
+	HANDLE m_WorkSemaphore;																	// Released once for each worker when a job
+																									//  starts
+	HANDLE m_DoneEvent;																		// Set when the last worker has finished a
+																									//  job
+	CRITICAL_SECTION m_JobLock;															// Held whilst a job runs
+	volatile long m_NumWorkersRunning;													// Workers yet to finish the job
+	volatile bool m_Quit;																	// Set for the workers to exit
+	tRunChunk m_RunChunk;																	// The job
+	void* m_Context;
+	char m_ShareBuffer[(eMaxWorkers+2)*eCacheLineSize];							// The shares, one for each worker and the
+																									//  thread running the job, aligned to a
+																									//  cache line
+	//~V
+	tThreadPool(const tThreadPool&);
+	tThreadPool& operator=(const tThreadPool&);
+	_tShare& Share(const int32_t shareidx);
+	static LONGLONG PackChunks(
+	 const int32_t begin,
+	 const int32_t end);
+	bool TakeChunk(
+	 const int32_t shareidx,
+	 int32_t& chunk);																			// Take the next chunk from this share
+	bool Steal(const int32_t shareidx);													// Move the back half of another share in to
+																									//  this (empty) share
+	void RunChunks(const int32_t shareidx);											// Run chunks until there are none left
+	void Destroy(void);
+	static DWORD WINAPI WorkerMain(LPVOID param);
+	//~F
+//=====================================================================================================================
+// PROPERTIES
+//=====================================================================================================================
+public:
+	int32_t NumThreads(void) const;														// The threads which run a job, including
+																									//  the one running it
+//=====================================================================================================================
+// FUNCTIONS/MODIFIERS
+//=====================================================================================================================
+	tThreadPool(const int32_t numworkers=-1 /* -1 means one for each processor but the first */);
+	~tThreadPool(void);
+	void Run(
+	 const int32_t numchunks,
+	 const tRunChunk runchunk,
+	 void* const context);																	// Run every chunk of a job and wait for
+																									//  them to finish. 'runchunk' must not
+																									//  throw
+	//~PF
+};
+
+//=====================================================================================================================
+// IMPLEMENTATION
+//=====================================================================================================================
+
+inline tThreadPool::tThreadPool(const int32_t numworkers):m_NumWorkers(0),m_WorkSemaphore(NULL),m_DoneEvent(NULL),
+ m_NumWorkersRunning(0),m_Quit(false),m_RunChunk(NULL),m_Context(NULL)
+{
+	_ASSERTE(numworkers>=-1 && numworkers<=eMaxWorkers);
+	int32_t numtocreate=numworkers;
+	if(numtocreate==-1)
+	{
+		SYSTEM_INFO systeminfo;
+		GetSystemInfo(&systeminfo);
+		numtocreate=static_cast<int32_t>(systeminfo.dwNumberOfProcessors)-1;
+		if(numtocreate>eMaxWorkers)
+		{
+			numtocreate=eMaxWorkers;
+		}
+	}
+	InitializeCriticalSection(&m_JobLock);
+	m_WorkSemaphore=CreateSemaphore(NULL,0,eMaxWorkers,NULL);
+	m_DoneEvent=CreateEvent(NULL,FALSE,FALSE,NULL);
+	if(!m_WorkSemaphore || !m_DoneEvent)
+	{
+		Destroy();
+		throw std::bad_alloc("Failed to create the thread pool.");
+	}
+	for(;m_NumWorkers<numtocreate;++m_NumWorkers)
+	{
+		// The thread running a job has the first share
+		m_Workers[m_NumWorkers].Pool=this;
+		m_Workers[m_NumWorkers].ShareIdx=m_NumWorkers+1;
+		m_Threads[m_NumWorkers]=CreateThread(NULL,0,&WorkerMain,&m_Workers[m_NumWorkers],0,NULL);
+		if(!m_Threads[m_NumWorkers])
+		{
+			Destroy();
+			throw std::bad_alloc("Failed to create the thread pool.");
+		}
+	}
+}
+
+inline tThreadPool::~tThreadPool(void)
+{
+	Destroy();
+}
+
+inline void tThreadPool::Destroy(void)
+{
+	if(m_NumWorkers)
+	{
+		m_Quit=true;
+		ReleaseSemaphore(m_WorkSemaphore,m_NumWorkers,NULL);
+		for(int32_t i=0;i<m_NumWorkers;++i)
+		{
+			WaitForSingleObject(m_Threads[i],INFINITE);
+			CloseHandle(m_Threads[i]);
+		}
+		m_NumWorkers=0;
+	}
+	if(m_DoneEvent)
+	{
+		CloseHandle(m_DoneEvent);
+		m_DoneEvent=NULL;
+	}
+	if(m_WorkSemaphore)
+	{
+		CloseHandle(m_WorkSemaphore);
+		m_WorkSemaphore=NULL;
+	}
+	DeleteCriticalSection(&m_JobLock);
+}
+
+inline int32_t tThreadPool::NumThreads(void) const
+{
+	return m_NumWorkers+1;
+}
+
+inline tThreadPool::_tShare& tThreadPool::Share(const int32_t shareidx)
+{
+	_ASSERTE(shareidx>=0 && shareidx<=m_NumWorkers);
+	const uintptr_t buffer=reinterpret_cast<uintptr_t>(m_ShareBuffer);
+	const uintptr_t firstshare=(buffer+eCacheLineSize-1)&~static_cast<uintptr_t>(eCacheLineSize-1);
+	return reinterpret_cast<_tShare*>(firstshare)[shareidx];
+}
+
+inline LONGLONG tThreadPool::PackChunks(const int32_t begin,const int32_t end)
+{
+	return static_cast<LONGLONG>(begin)|(static_cast<LONGLONG>(end)<<32);
+}
+
+inline bool tThreadPool::TakeChunk(const int32_t shareidx,int32_t& chunk)
+{
+	_tShare& share=Share(shareidx);
+	for(;;)
+	{
+		// A 64 bit read is not atomic on 32 bit platforms
+		const LONGLONG chunks=InterlockedCompareExchange64(&share.Chunks,0,0);
+		const int32_t begin=static_cast<int32_t>(chunks&0xFFFFFFFF);
+		const int32_t end=static_cast<int32_t>(chunks>>32);
+		if(begin>=end)
+		{
+			return false;
+		}
+		if(InterlockedCompareExchange64(&share.Chunks,PackChunks(begin+1,end),chunks)==chunks)
+		{
+			chunk=begin;
+			return true;
+		}
+		// A thief got there first, try again with what is left
+	}
+}
+
+inline bool tThreadPool::Steal(const int32_t shareidx)
+{
+	const int32_t numshares=m_NumWorkers+1;
+	for(int32_t i=1;i<numshares;++i)
+	{
+		_tShare& victim=Share((shareidx+i)%numshares);
+		for(;;)
+		{
+			const LONGLONG chunks=InterlockedCompareExchange64(&victim.Chunks,0,0);
+			const int32_t begin=static_cast<int32_t>(chunks&0xFFFFFFFF);
+			const int32_t end=static_cast<int32_t>(chunks>>32);
+			if(begin>=end)
+			{
+				// Nothing left to steal, try the next share
+				break;
+			}
+			// Leave the victim the front half, which is next in line for it
+			const int32_t middle=begin+((end-begin)/2);
+			if(InterlockedCompareExchange64(&victim.Chunks,PackChunks(begin,middle),chunks)==chunks)
+			{
+				// Only the owner adds to a share, and only when it's empty so nobody else is changing it
+				_tShare& share=Share(shareidx);
+				const LONGLONG emptychunks=InterlockedCompareExchange64(&share.Chunks,0,0);
+				InterlockedCompareExchange64(&share.Chunks,PackChunks(middle,end),emptychunks);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+inline void tThreadPool::RunChunks(const int32_t shareidx)
+{
+	do
+	{
+		int32_t chunk;
+		while(TakeChunk(shareidx,chunk))
+		{
+			m_RunChunk(m_Context,chunk);
+		}
+	}
+	while(Steal(shareidx));
+}
+
+inline void tThreadPool::Run(const int32_t numchunks,const tRunChunk runchunk,void* const context)
+{
+	_ASSERTE(numchunks>=0);
+	_ASSERTE(runchunk);
+	if(!numchunks)
+	{
+		return;
+	}
+	EnterCriticalSection(&m_JobLock);
+	m_RunChunk=runchunk;
+	m_Context=context;
+	// Deal the chunks out evenly
+	const int32_t numshares=m_NumWorkers+1;
+	for(int32_t i=0;i<numshares;++i)
+	{
+		const int32_t begin=static_cast<int32_t>((static_cast<LONGLONG>(numchunks)*i)/numshares);
+		const int32_t end=static_cast<int32_t>((static_cast<LONGLONG>(numchunks)*(i+1))/numshares);
+		Share(i).Chunks=PackChunks(begin,end);
+	}
+	if(m_NumWorkers)
+	{
+		m_NumWorkersRunning=m_NumWorkers;
+		// Releasing the semaphore makes the job visible to the workers
+		ReleaseSemaphore(m_WorkSemaphore,m_NumWorkers,NULL);
+	}
+	RunChunks(0);
+	if(m_NumWorkers)
+	{
+		// A worker may still be running a chunk it took
+		WaitForSingleObject(m_DoneEvent,INFINITE);
+	}
+	m_RunChunk=NULL;
+	m_Context=NULL;
+	LeaveCriticalSection(&m_JobLock);
+}
+
+inline DWORD WINAPI tThreadPool::WorkerMain(LPVOID param)
+{
+	const _tWorker& worker=*static_cast<_tWorker*>(param);
+	tThreadPool& pool=*worker.Pool;
+	for(;;)
+	{
+		WaitForSingleObject(pool.m_WorkSemaphore,INFINITE);
+		if(pool.m_Quit)
+		{
+			return 0;
+		}
+		// One worker may be released more than once for a job whilst another isn't released at all. The share of the
+		//  worker left waiting is then taken by stealing
+		pool.RunChunks(worker.ShareIdx);
+		if(!InterlockedDecrement(&pool.m_NumWorkersRunning))
+		{
+			SetEvent(pool.m_DoneEvent);
+		}
+	}
+}
\ No newline at end of file
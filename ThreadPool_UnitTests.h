@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "IUnitTest.h"
+
+class tThreadPool_UnitTest : public IUnitTest
+{
+	enum eTestNumber
+	{
+		eTestFirst=0,
+		//
+		eRunEveryChunkOnce=0,
+		eNoWorkers,
+		//
+		TestCount,
+	};
+	enum
+	{
+		eNumChunks=1000,
+	};
+	struct _tJob
+	{
+		volatile long NumRuns[eNumChunks];
+	};
+	static void RunChunk(
+	 void* const context,
+	 const int32_t chunk);
+	bool RunEveryChunkOnce(void);
+	bool NoWorkers(void);
+public:
+	unsigned short GetFirstTest(void) const override
+	{
+		return eTestFirst;
+	}
+	unsigned short GetTestCount(void) const override
+	{
+		return TestCount;
+	}
+	void GetTestName(
+	 const unsigned short testnum,
+	 const unsigned short testnamecount,
+	 WCHAR* const testname) const override;
+	void GetTestDescription(
+	 const unsigned short testnum,
+	 const unsigned short descrcount,
+	 WCHAR* const descr) const override;
+	bool DoTest(const unsigned short testnum) override;
+};
+
+inline void tThreadPool_UnitTest::GetTestName(const unsigned short testnum,
+ const unsigned short testnamecount,WCHAR* const testname) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eRunEveryChunkOnce:
+		wcscpy_s(testname,testnamecount,L"RunEveryChunkOnce");
+		break;
+	case eNoWorkers:
+		wcscpy_s(testname,testnamecount,L"NoWorkers");
+		break;
+	}
+}
+
+inline void tThreadPool_UnitTest::GetTestDescription(const unsigned short testnum,
+ const unsigned short descrcount,WCHAR* const descr) const
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eRunEveryChunkOnce:
+		wcscpy_s(descr,descrcount,
+		 L"Run jobs whose chunks take uneven times and confirm every chunk ran exactly once");
+		break;
+	case eNoWorkers:
+		wcscpy_s(descr,descrcount,
+		 L"Run a job on a pool without any workers, so the calling thread runs every chunk");
+		break;
+	}
+}
+
+inline void tThreadPool_UnitTest::RunChunk(void* const context,const int32_t chunk)
+{
+	_tJob& job=*static_cast<_tJob*>(context);
+	// The chunks at the start take far longer, so the threads given them fall behind and the others steal from them
+	if(chunk<eNumChunks/10)
+	{
+		for(int i=0;i<1000;++i)
+		{
+			SwitchToThread();
+		}
+	}
+	InterlockedIncrement(&job.NumRuns[chunk]);
+}
+
+inline bool tThreadPool_UnitTest::RunEveryChunkOnce(void)
+{
+	tThreadPool pool(3);
+	UNITTEST_ASSERT(pool.NumThreads()==4);
+	_tJob job;
+	// Several jobs, so the workers wait for and start more than one
+	for(int jobnum=0;jobnum<5;++jobnum)
+	{
+		for(int i=0;i<eNumChunks;++i)
+		{
+			job.NumRuns[i]=0;
+		}
+		pool.Run(eNumChunks,&RunChunk,&job);
+		for(int i=0;i<eNumChunks;++i)
+		{
+			UNITTEST_ASSERT(job.NumRuns[i]==1);
+		}
+	}
+	return true;
+}
+
+inline bool tThreadPool_UnitTest::NoWorkers(void)
+{
+	tThreadPool pool(0);
+	UNITTEST_ASSERT(pool.NumThreads()==1);
+	_tJob job;
+	for(int i=0;i<eNumChunks;++i)
+	{
+		job.NumRuns[i]=0;
+	}
+	pool.Run(eNumChunks,&RunChunk,&job);
+	for(int i=0;i<eNumChunks;++i)
+	{
+		UNITTEST_ASSERT(job.NumRuns[i]==1);
+	}
+	return true;
+}
+
+inline bool tThreadPool_UnitTest::DoTest(const unsigned short testnum)
+{
+	switch(testnum)
+	{
+	default:
+		PANIC;
+		// No return
+	case eRunEveryChunkOnce:
+		return RunEveryChunkOnce();
+	case eNoWorkers:
+		return NoWorkers();
+	}
+}
\ No newline at end of file
@@ -5,6 +5,13 @@
 #include "UnitTests.h"
 #include "BlockAllocator_UnitTests.h"
 #include "PsyncArray_UnitTests.h"
+#include "PsyncSegmentedArray_UnitTests.h"
+#include "PsyncSoAArray_UnitTests.h"
+#include "ThreadCachingAllocator_UnitTests.h"
+#include "ConcurrentArena_UnitTests.h"
+#include "ThreadPool_UnitTests.h"
+#include "BlockCache_UnitTests.h"
+#include "BlockSource_UnitTests.h"
 
 
 int _tmain(int argc, _TCHAR* argv[])
@@ -19,6 +26,15 @@ int _tmain(int argc, _TCHAR* argv[])
 			std::cout<<failmsg<<"\n";
 		}
 	}
+	{
+		// Every block allocator test again with a larger block table
+		IUnitTest& unittest=*(new tBlockAllocatorT<tBlockAllocatorRefCounter,tMallocBlockSource,64>::UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
 
 	{
 		IUnitTest& unittest=*(new tPArray_UnitTest());
@@ -28,6 +44,62 @@ int _tmain(int argc, _TCHAR* argv[])
 			std::cout<<failmsg<<"\n";
 		}
 	}
+	{
+		IUnitTest& unittest=*(new tPSegmentedArray_UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
+	{
+		IUnitTest& unittest=*(new tPSoAArray_UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
+	{
+		IUnitTest& unittest=*(new tThreadCachingAllocator_UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
+	{
+		IUnitTest& unittest=*(new tConcurrentArena_UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
+	{
+		IUnitTest& unittest=*(new tThreadPool_UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
+	{
+		IUnitTest& unittest=*(new tBlockCache_UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
+	{
+		IUnitTest& unittest=*(new tBlockSource_UnitTest());
+		const int testnumfailed=test.DoUnitTest(unittest,_countof(failmsg),failmsg);
+		if(testnumfailed!=-1)
+		{
+			std::cout<<failmsg<<"\n";
+		}
+	}
 	return 0;
 }
 
@@ -22,6 +22,11 @@
 
 using std::tr1::aligned_storage;
 using std::tr1::alignment_of;
+using std::tr1::has_trivial_destructor;
+using std::tr1::has_trivial_copy;
+using std::tr1::is_base_of;
+using std::tr1::true_type;
+using std::tr1::false_type;
 using std::numeric_limits;
 
 #define PANIC
@@ -33,6 +38,8 @@ using std::numeric_limits;
 #define tProxyRefCounter(TYPE) tProxyRefCounterT<IPoly,TYPE>
 
 #include "BlockAllocator.h"
+#include "MemoryResource.h"
+#include "StlAllocator.h"
 
 #include "PsyncArray.h"
 